@@ -40,7 +40,9 @@
 #include "clang/Tooling/ReplacementsYaml.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
+#include <mutex>
 #include <utility>
 
 #if CLANG_TIDY_ENABLE_STATIC_ANALYZER
@@ -498,13 +500,99 @@ getCheckOptions(const ClangTidyOptions &Options,
   return Factory.getCheckOptions();
 }
 
-std::vector<ClangTidyError>
-runClangTidy(clang::tidy::ClangTidyContext &Context,
-             const CompilationDatabase &Compilations,
-             ArrayRef<std::string> InputFiles,
-             llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
-             bool ApplyAnyFix, bool EnableCheckProfile,
-             llvm::StringRef StoreCheckProfile) {
+namespace {
+/// Forwards the option lookups of the per-file contexts of a parallel run to
+/// the context of the whole run, one lookup at a time.
+class SynchronizedOptionsProvider : public ClangTidyOptionsProvider {
+public:
+  SynchronizedOptionsProvider(ClangTidyContext &Context, std::mutex &Mutex)
+      : Context(Context), Mutex(Mutex) {}
+
+  const ClangTidyGlobalOptions &getGlobalOptions() override {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return Context.getGlobalOptions();
+  }
+
+  std::vector<OptionsSource> getRawOptions(StringRef FileName) override {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return {OptionsSource(Context.getOptionsForFile(FileName),
+                          "clang-tidy run")};
+  }
+
+private:
+  ClangTidyContext &Context;
+  std::mutex &Mutex;
+};
+
+/// Gives a file of a parallel run its own working directory on top of a file
+/// system shared with the other files, by making paths absolute before
+/// forwarding them. ClangTool changes the working directory for each compile
+/// command, which would otherwise affect every thread.
+class WorkingDirectoryFileSystem : public llvm::vfs::ProxyFileSystem {
+public:
+  explicit WorkingDirectoryFileSystem(
+      IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS)
+      : ProxyFileSystem(FS) {
+    if (auto CWD = FS->getCurrentWorkingDirectory())
+      WorkingDirectory = std::move(*CWD);
+  }
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const Twine &Path) override {
+    return ProxyFileSystem::status(resolve(Path));
+  }
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    return ProxyFileSystem::openFileForRead(resolve(Path));
+  }
+  llvm::vfs::directory_iterator dir_begin(const Twine &Dir,
+                                          std::error_code &EC) override {
+    return ProxyFileSystem::dir_begin(resolve(Dir), EC);
+  }
+  std::error_code getRealPath(const Twine &Path,
+                              SmallVectorImpl<char> &Output) const override {
+    return ProxyFileSystem::getRealPath(resolve(Path), Output);
+  }
+  std::error_code isLocal(const Twine &Path, bool &Result) override {
+    return ProxyFileSystem::isLocal(resolve(Path), Result);
+  }
+
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return WorkingDirectory;
+  }
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+    SmallString<256> Dir = resolve(Path);
+    llvm::ErrorOr<llvm::vfs::Status> Status = ProxyFileSystem::status(Dir);
+    if (!Status)
+      return Status.getError();
+    if (!Status->isDirectory())
+      return std::make_error_code(std::errc::not_a_directory);
+    llvm::sys::path::remove_dots(Dir, /*remove_dot_dot=*/true);
+    WorkingDirectory = std::string(Dir.str());
+    return {};
+  }
+
+private:
+  SmallString<256> resolve(const Twine &Path) const {
+    SmallString<256> Result;
+    Path.toVector(Result);
+    makeAbsolute(Result);
+    return Result;
+  }
+
+  std::string WorkingDirectory;
+};
+} // namespace
+
+/// Runs the checks configured by \p Context on \p InputFiles, collecting the
+/// diagnostics in \p DiagConsumer. Unless \p PrintDiagnosticCounts is set,
+/// the compiler does not print the number of diagnostics after each file.
+static void
+runClangTidyOnFiles(ClangTidyContext &Context,
+                    ClangTidyDiagnosticConsumer &DiagConsumer,
+                    const CompilationDatabase &Compilations,
+                    ArrayRef<std::string> InputFiles,
+                    IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
+                    bool PrintDiagnosticCounts) {
   ClangTool Tool(Compilations, InputFiles,
                  std::make_shared<PCHContainerOperations>(), BaseFS);
 
@@ -528,10 +616,7 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
 
   Tool.appendArgumentsAdjuster(PerFileExtraArgumentsInserter);
   Tool.appendArgumentsAdjuster(getStripPluginsAdjuster());
-  Context.setEnableProfiling(EnableCheckProfile);
-  Context.setProfileStoragePrefix(StoreCheckProfile);
 
-  ClangTidyDiagnosticConsumer DiagConsumer(Context, nullptr, true, ApplyAnyFix);
   DiagnosticsEngine DE(new DiagnosticIDs(), new DiagnosticOptions(),
                        &DiagConsumer, /*ShouldOwnClient=*/false);
   Context.setDiagnosticsEngine(&DE);
@@ -540,8 +625,10 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
   class ActionFactory : public FrontendActionFactory {
   public:
     ActionFactory(ClangTidyContext &Context,
-                  IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS)
-        : ConsumerFactory(Context, std::move(BaseFS)) {}
+                  IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
+                  bool PrintDiagnosticCounts)
+        : ConsumerFactory(Context, std::move(BaseFS)),
+          PrintDiagnosticCounts(PrintDiagnosticCounts) {}
     std::unique_ptr<FrontendAction> create() override {
       return std::make_unique<Action>(&ConsumerFactory);
     }
@@ -552,6 +639,10 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
                        DiagnosticConsumer *DiagConsumer) override {
       // Explicitly ask to define __clang_analyzer__ macro.
       Invocation->getPreprocessorOpts().SetUpStaticAnalyzer = true;
+      // Files processed in parallel would interleave their counts, so the
+      // caller prints running totals in input order instead.
+      Invocation->getDiagnosticOpts().ShowDiagnosticCounts =
+          PrintDiagnosticCounts;
       return FrontendActionFactory::runInvocation(
           Invocation, Files, PCHContainerOps, DiagConsumer);
     }
@@ -570,10 +661,86 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
     };
 
     ClangTidyASTConsumerFactory ConsumerFactory;
+    bool PrintDiagnosticCounts;
   };
 
-  ActionFactory Factory(Context, std::move(BaseFS));
+  ActionFactory Factory(Context, std::move(BaseFS), PrintDiagnosticCounts);
   Tool.run(&Factory);
+}
+
+/// Prints the running totals of diagnostics the way the compiler prints them
+/// after each file.
+static void printDiagnosticCounts(unsigned NumWarnings, unsigned NumErrors) {
+  if (NumWarnings)
+    llvm::errs() << NumWarnings << " warning" << (NumWarnings == 1 ? "" : "s");
+  if (NumWarnings && NumErrors)
+    llvm::errs() << " and ";
+  if (NumErrors)
+    llvm::errs() << NumErrors << " error" << (NumErrors == 1 ? "" : "s");
+  if (NumWarnings || NumErrors)
+    llvm::errs() << " generated.\n";
+}
+
+std::vector<ClangTidyError>
+runClangTidy(clang::tidy::ClangTidyContext &Context,
+             const CompilationDatabase &Compilations,
+             ArrayRef<std::string> InputFiles,
+             llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
+             bool ApplyAnyFix, bool EnableCheckProfile,
+             llvm::StringRef StoreCheckProfile, unsigned Jobs) {
+  Context.setEnableProfiling(EnableCheckProfile);
+  Context.setProfileStoragePrefix(StoreCheckProfile);
+
+  ClangTidyDiagnosticConsumer DiagConsumer(Context, nullptr, true, ApplyAnyFix);
+
+  // Profiles printed to stderr can't be told apart when the files run
+  // concurrently.
+  unsigned NumThreads = llvm::hardware_concurrency(Jobs).compute_thread_count();
+  if (NumThreads <= 1 || InputFiles.size() <= 1 ||
+      (EnableCheckProfile && StoreCheckProfile.empty())) {
+    runClangTidyOnFiles(Context, DiagConsumer, Compilations, InputFiles,
+                        std::move(BaseFS), /*PrintDiagnosticCounts=*/true);
+    return DiagConsumer.take();
+  }
+
+  // Each file gets a context and a diagnostic consumer of its own. The
+  // diagnostics are merged in the order of InputFiles afterwards, so that
+  // the result is the same as for a sequential run.
+  struct FileRun {
+    std::unique_ptr<ClangTidyContext> Context;
+    std::unique_ptr<ClangTidyDiagnosticConsumer> DiagConsumer;
+  };
+  std::vector<FileRun> Runs(InputFiles.size());
+  std::mutex OptionsMutex;
+  {
+    llvm::ThreadPool Pool(llvm::hardware_concurrency(NumThreads));
+    for (unsigned I = 0, E = InputFiles.size(); I != E; ++I) {
+      Pool.async([&, I] {
+        FileRun &Run = Runs[I];
+        Run.Context = std::make_unique<ClangTidyContext>(
+            std::make_unique<SynchronizedOptionsProvider>(Context,
+                                                          OptionsMutex),
+            Context.canEnableAnalyzerAlphaCheckers());
+        Run.Context->setEnableProfiling(EnableCheckProfile);
+        Run.Context->setProfileStoragePrefix(StoreCheckProfile);
+        Run.DiagConsumer = std::make_unique<ClangTidyDiagnosticConsumer>(
+            *Run.Context, nullptr, true, ApplyAnyFix);
+        auto FS = makeIntrusiveRefCnt<llvm::vfs::OverlayFileSystem>(
+            makeIntrusiveRefCnt<WorkingDirectoryFileSystem>(BaseFS));
+        runClangTidyOnFiles(*Run.Context, *Run.DiagConsumer, Compilations,
+                            InputFiles[I], std::move(FS),
+                            /*PrintDiagnosticCounts=*/false);
+      });
+    }
+  }
+
+  unsigned NumWarnings = 0, NumErrors = 0;
+  for (FileRun &Run : Runs) {
+    NumWarnings += Run.DiagConsumer->getNumWarnings();
+    NumErrors += Run.DiagConsumer->getNumErrors();
+    printDiagnosticCounts(NumWarnings, NumErrors);
+    DiagConsumer.merge(*Run.DiagConsumer);
+  }
   return DiagConsumer.take();
 }
 
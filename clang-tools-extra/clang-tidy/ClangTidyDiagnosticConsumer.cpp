@@ -762,6 +762,8 @@ struct EqualClangTidyError {
 
 std::vector<ClangTidyError> ClangTidyDiagnosticConsumer::take() {
   finalizeLastError();
+  llvm::move(MergedErrors, std::back_inserter(Errors));
+  MergedErrors.clear();
 
   llvm::stable_sort(Errors, LessClangTidyError());
   Errors.erase(std::unique(Errors.begin(), Errors.end(), EqualClangTidyError()),
@@ -771,6 +773,20 @@ std::vector<ClangTidyError> ClangTidyDiagnosticConsumer::take() {
   return std::move(Errors);
 }
 
+void ClangTidyDiagnosticConsumer::merge(ClangTidyDiagnosticConsumer &Other) {
+  Other.finalizeLastError();
+  llvm::move(Other.Errors, std::back_inserter(MergedErrors));
+  Other.Errors.clear();
+
+  ClangTidyStats &Stats = Context.Stats;
+  const ClangTidyStats &OtherStats = Other.Context.Stats;
+  Stats.ErrorsDisplayed += OtherStats.ErrorsDisplayed;
+  Stats.ErrorsIgnoredCheckFilter += OtherStats.ErrorsIgnoredCheckFilter;
+  Stats.ErrorsIgnoredNOLINT += OtherStats.ErrorsIgnoredNOLINT;
+  Stats.ErrorsIgnoredNonUserCode += OtherStats.ErrorsIgnoredNonUserCode;
+  Stats.ErrorsIgnoredLineFilter += OtherStats.ErrorsIgnoredLineFilter;
+}
+
 namespace {
 struct LessClangTidyErrorWithoutDiagnosticName {
   bool operator()(const ClangTidyError *LHS, const ClangTidyError *RHS) const {
@@ -254,6 +254,11 @@ public:
   // Retrieve the diagnostics that were captured.
   std::vector<ClangTidyError> take();
 
+  /// Adds the diagnostics captured by \p Other, which processed other files
+  /// with a context of its own, to the ones returned by take(), and its
+  /// counters to the statistics of this consumer's context.
+  void merge(ClangTidyDiagnosticConsumer &Other);
+
 private:
   void finalizeLastError();
   void removeIncompatibleErrors();
@@ -275,6 +280,7 @@ private:
   bool RemoveIncompatibleErrors;
   bool GetFixesFromNotes;
   std::vector<ClangTidyError> Errors;
+  std::vector<ClangTidyError> MergedErrors;
   std::unique_ptr<llvm::Regex> HeaderFilter;
   bool LastErrorRelatesToUserCode;
   bool LastErrorPassesLineFilter;
@@ -247,6 +247,13 @@ over the real file system.
                                        cl::value_desc("filename"),
                                        cl::cat(ClangTidyCategory));
 
+static cl::opt<unsigned> Jobs("j", cl::desc(R"(
+Number of files to process in parallel. 0 uses
+one per hardware thread. The output is the same
+as when processing the files one at a time.
+)"),
+                            cl::init(1), cl::cat(ClangTidyCategory));
+
 static cl::opt<bool> UseColor("use-color", cl::desc(R"(
 Use colors in diagnostics. If not set, colors
 will be used if the terminal connected to
@@ -492,7 +499,7 @@ int clangTidyMain(int argc, const char **argv) {
                            AllowEnablingAnalyzerAlphaCheckers);
   std::vector<ClangTidyError> Errors =
       runClangTidy(Context, OptionsParser->getCompilations(), PathList, BaseFS,
-                   FixNotes, EnableCheckProfile, ProfilePrefix);
+                   FixNotes, EnableCheckProfile, ProfilePrefix, Jobs);
   bool FoundErrors = llvm::find_if(Errors, [](const ClangTidyError &E) {
                        return E.DiagLevel == ClangTidyError::Error;
                      }) != Errors.end();
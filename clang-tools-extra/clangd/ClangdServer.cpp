@@ -141,6 +141,7 @@ ClangdServer::Options::operator TUScheduler::Options() const {
   Opts.AsyncThreadsCount = AsyncThreadsCount;
   Opts.RetentionPolicy = RetentionPolicy;
   Opts.StorePreamblesInMemory = StorePreamblesInMemory;
+  Opts.SharePreambles = SharePreambles;
   Opts.UpdateDebounce = UpdateDebounce;
   Opts.ContextProvider = ContextProvider;
   return Opts;
@@ -107,6 +107,11 @@ public:
     /// Cached preambles are potentially large. If false, store them on disk.
     bool StorePreamblesInMemory = true;
 
+    /// Reuse one preamble for open files in the same directory that start with
+    /// the same includes, and nothing else, and are compiled with the same
+    /// flags.
+    bool SharePreambles = false;
+
     /// If true, ClangdServer builds a dynamic in-memory index for symbols in
     /// opened files and uses the index to augment code completion results.
     bool BuildDynamicSymbolIndex = false;
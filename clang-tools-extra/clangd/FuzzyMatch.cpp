@@ -66,6 +66,9 @@ constexpr int FuzzyMatcher::MaxPat;
 constexpr int FuzzyMatcher::MaxWord;
 
 static char lower(char C) { return C >= 'A' && C <= 'Z' ? C + ('a' - 'A') : C; }
+// Characters are hashed into a 64-bit "bag", lowercase letters get a bit each.
+// A word can only match if its bag has all the bits of the pattern's bag.
+static uint64_t bagBit(char LowC) { return uint64_t{1} << (LowC & 63); }
 // A "negative infinity" score that won't overflow.
 // We use this to mark unreachable states and forbidden solutions.
 // Score field is 15 bits wide, min value is -2^14, we use half of that.
@@ -77,8 +80,11 @@ FuzzyMatcher::FuzzyMatcher(llvm::StringRef Pattern)
     : PatN(std::min<int>(MaxPat, Pattern.size())),
       ScoreScale(PatN ? float{1} / (PerfectBonus * PatN) : 0), WordN(0) {
   std::copy(Pattern.begin(), Pattern.begin() + PatN, Pat);
-  for (int I = 0; I < PatN; ++I)
+  PatBag = 0;
+  for (int I = 0; I < PatN; ++I) {
     LowPat[I] = lower(Pat[I]);
+    PatBag |= bagBit(LowPat[I]);
+  }
   Scores[0][0][Miss] = {0, Miss};
   Scores[0][0][Match] = {AwfulScore, Miss};
   for (int P = 0; P <= PatN; ++P)
@@ -87,6 +93,7 @@ FuzzyMatcher::FuzzyMatcher(llvm::StringRef Pattern)
         Scores[P][W][A] = {AwfulScore, Miss};
   PatTypeSet = calculateRoles(llvm::StringRef(Pat, PatN),
                               llvm::makeMutableArrayRef(PatRole, PatN));
+  PatSingleCase = (PatTypeSet == 1 << Lower) || (PatTypeSet == 1 << Upper);
 }
 
 llvm::Optional<float> FuzzyMatcher::match(llvm::StringRef Word) {
@@ -185,8 +192,15 @@ bool FuzzyMatcher::init(llvm::StringRef NewWord) {
   std::copy(NewWord.begin(), NewWord.begin() + WordN, Word);
   if (PatN == 0)
     return true;
-  for (int I = 0; I < WordN; ++I)
+  // Branch-free, so that the compiler can vectorize it.
+  uint64_t WordBag = 0;
+  for (int I = 0; I < WordN; ++I) {
     LowWord[I] = lower(Word[I]);
+    WordBag |= bagBit(LowWord[I]);
+  }
+  // Most words in a large index lack some pattern character.
+  if (PatBag & ~WordBag)
+    return false;
 
   // Cheap subsequence check.
   for (int W = 0, P = 0; P != PatN; ++W) {
@@ -280,13 +294,11 @@ int FuzzyMatcher::skipPenalty(int W, Action Last) const {
 int FuzzyMatcher::matchBonus(int P, int W, Action Last) const {
   assert(LowPat[P] == LowWord[W]);
   int S = 1;
-  bool IsPatSingleCase =
-      (PatTypeSet == 1 << Lower) || (PatTypeSet == 1 << Upper);
   // Bonus: case matches, or a Head in the pattern aligns with one in the word.
   // Single-case patterns lack segmentation signals and we assume any character
   // can be a head of a segment.
   if (Pat[P] == Word[W] ||
-      (WordRole[W] == Head && (IsPatSingleCase || PatRole[P] == Head)))
+      (WordRole[W] == Head && (PatSingleCase || PatRole[P] == Head)))
     ++S;
   // Bonus: a consecutive match. First character match also gets a bonus to
   // ensure prefix final match score normalizes to 1.0.
@@ -20,6 +20,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/raw_ostream.h"
+#include <cstdint>
 
 namespace clang {
 namespace clangd {
@@ -110,6 +111,8 @@ private:
   char LowPat[MaxPat];      // Pattern in lowercase
   CharRole PatRole[MaxPat]; // Pattern segmentation info
   CharTypeSet PatTypeSet;   // Bitmask of 1<<CharType for all Pattern characters
+  bool PatSingleCase;       // Pattern has no mixed-case segmentation signals.
+  uint64_t PatBag;          // Bitmask of bagBit() for all LowPat characters
   float ScoreScale;         // Normalizes scores for the pattern length.
 
   // Word data is initialized on each call to match(), mostly by init().
@@ -164,6 +164,12 @@ void IncludeStructure::recordInclude(llvm::StringRef IncludingName,
   IncludeChildren[Parent].push_back(Child);
 }
 
+void IncludeStructure::aliasFile(llvm::StringRef Name,
+                                 llvm::StringRef Existing) {
+  unsigned Index = fileIndex(Existing);
+  NameToIndex[Name] = Index;
+}
+
 unsigned IncludeStructure::fileIndex(llvm::StringRef Name) {
   auto R = NameToIndex.try_emplace(Name, RealPathNames.size());
   if (R.second)
@@ -129,6 +129,10 @@ public:
                      llvm::StringRef IncludedName,
                      llvm::StringRef IncludedRealName);
 
+  // Makes \p Name another name of the file \p Existing, e.g. when a preamble
+  // built for one main file is reused for another.
+  void aliasFile(llvm::StringRef Name, llvm::StringRef Existing);
+
 private:
   // Identifying files in a way that persists from preamble build to subsequent
   // builds is surprisingly hard. FileID is unavailable in InclusionDirective(),
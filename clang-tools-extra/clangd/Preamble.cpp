@@ -37,8 +37,10 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
@@ -293,6 +295,42 @@ const char *spellingForIncDirective(tok::PPKeywordKind IncludeDirective) {
   llvm_unreachable("not an include directive");
 }
 
+// Checks whether \p Arg, an argument of \p Cmd, names the file it compiles.
+bool isCompiledFile(llvm::StringRef Arg, const tooling::CompileCommand &Cmd) {
+  auto Absolute = [&](llvm::StringRef Path) {
+    llvm::SmallString<256> Result(Path);
+    llvm::sys::fs::make_absolute(Cmd.Directory, Result);
+    llvm::sys::path::remove_dots(Result, /*remove_dot_dot=*/true);
+    return Result;
+  };
+  return Absolute(Arg) == Absolute(Cmd.Filename);
+}
+
+// Checks whether the preamble region \p Text holds nothing but #include
+// directives. A preamble records where the entities it declares come from,
+// and those from the main file would point into the file that built it.
+bool onlyIncludes(llvm::StringRef Text, const LangOptions &LangOpts) {
+  Lexer Lex(SourceLocation(), LangOpts, Text.begin(), Text.begin(),
+            Text.end());
+  Token Tok;
+  while (true) {
+    Lex.LexFromRawLexer(Tok);
+    if (Tok.is(tok::eof))
+      return true;
+    if (!Tok.isAtStartOfLine())
+      continue;
+    if (Tok.isNot(tok::hash))
+      return false;
+    Lex.LexFromRawLexer(Tok);
+    if (Tok.isNot(tok::raw_identifier) || Tok.isAtStartOfLine())
+      return false;
+    if (!llvm::StringSwitch<bool>(Tok.getRawIdentifier())
+             .Cases("include", "include_next", "import", true)
+             .Default(false))
+      return false;
+  }
+}
+
 // Checks whether \p FileName is a valid spelling of main file.
 bool isMainFile(llvm::StringRef FileName, const SourceManager &SM) {
   auto FE = SM.getFileManager().getFile(FileName);
@@ -301,12 +339,12 @@ bool isMainFile(llvm::StringRef FileName, const SourceManager &SM) {
 
 } // namespace
 
-PreambleData::PreambleData(const ParseInputs &Inputs,
-                           PrecompiledPreamble Preamble,
-                           std::vector<Diag> Diags, IncludeStructure Includes,
-                           MainFileMacros Macros,
-                           std::unique_ptr<PreambleFileStatusCache> StatCache,
-                           CanonicalIncludes CanonIncludes)
+PreambleData::PreambleData(
+    const ParseInputs &Inputs,
+    std::shared_ptr<const PrecompiledPreamble> Preamble,
+    std::vector<Diag> Diags, IncludeStructure Includes, MainFileMacros Macros,
+    std::shared_ptr<const PreambleFileStatusCache> StatCache,
+    CanonicalIncludes CanonIncludes)
     : Version(Inputs.Version), CompileCommand(Inputs.CompileCommand),
       Preamble(std::move(Preamble)), Diags(std::move(Diags)),
       Includes(std::move(Includes)), Macros(std::move(Macros)),
@@ -357,11 +395,14 @@ buildPreamble(PathRef FileName, CompilerInvocation CI,
     vlog("Built preamble of size {0} for file {1} version {2}",
          BuiltPreamble->getSize(), FileName, Inputs.Version);
     std::vector<Diag> Diags = PreambleDiagnostics.take();
-    return std::make_shared<PreambleData>(
-        Inputs, std::move(*BuiltPreamble), std::move(Diags),
-        SerializedDeclsCollector.takeIncludes(),
+    auto Result = std::make_shared<PreambleData>(
+        Inputs,
+        std::make_shared<const PrecompiledPreamble>(std::move(*BuiltPreamble)),
+        std::move(Diags), SerializedDeclsCollector.takeIncludes(),
         SerializedDeclsCollector.takeMacros(), std::move(StatCache),
         SerializedDeclsCollector.takeCanonicalIncludes());
+    Result->MainFileName = CI.getFrontendOpts().Inputs[0].getFile().str();
+    return Result;
   } else {
     elog("Could not build a preamble for file {0} version {1}", FileName,
          Inputs.Version);
@@ -378,7 +419,82 @@ bool isPreambleCompatible(const PreambleData &Preamble,
   auto VFS = Inputs.TFS->view(Inputs.CompileCommand.Directory);
   return compileCommandsAreEqual(Inputs.CompileCommand,
                                  Preamble.CompileCommand) &&
-         Preamble.Preamble.CanReuse(CI, *ContentsBuffer, Bounds, *VFS);
+         Preamble.Preamble->CanReuse(CI, *ContentsBuffer, Bounds, *VFS);
+}
+
+std::string sharedPreambleKey(PathRef FileName, const ParseInputs &Inputs,
+                              const CompilerInvocation &CI) {
+  auto ContentsBuffer =
+      llvm::MemoryBuffer::getMemBuffer(Inputs.Contents, FileName);
+  auto Bounds = ComputePreambleBounds(*CI.getLangOpts(), *ContentsBuffer, 0);
+  if (!onlyIncludes(Inputs.Contents.substr(0, Bounds.Size), *CI.getLangOpts()))
+    return "";
+  const tooling::CompileCommand &Cmd = Inputs.CompileCommand;
+
+  // Quoted includes are looked up next to the main file, and the driver picks
+  // the language from its extension.
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  OS << llvm::sys::path::parent_path(FileName) << '\0'
+     << llvm::sys::path::extension(FileName) << '\0' << Cmd.Directory << '\0';
+  // Leave out the arguments naming this file and its outputs, which differ
+  // between files compiled the same way.
+  for (unsigned I = 0, E = Cmd.CommandLine.size(); I < E; ++I) {
+    llvm::StringRef Arg = Cmd.CommandLine[I];
+    if (llvm::StringSwitch<bool>(Arg)
+            .Cases("-o", "-MF", "-MT", "-MQ", "-MJ", true)
+            .Default(false)) {
+      ++I;
+      continue;
+    }
+    if (!Arg.startswith("-") && isCompiledFile(Arg, Cmd))
+      continue;
+    OS << Arg << '\0';
+  }
+  OS << Bounds.PreambleEndsAtStartOfLine << '\0'
+     << Inputs.Contents.substr(0, Bounds.Size);
+  return OS.str();
+}
+
+std::shared_ptr<const PreambleData>
+sharePreamble(const PreambleData &Shared, PathRef FileName,
+              const ParseInputs &Inputs, const CompilerInvocation &CI) {
+  trace::Span Tracer("SharePreamble");
+  SPAN_ATTACH(Tracer, "File", FileName);
+  auto ContentsBuffer =
+      llvm::MemoryBuffer::getMemBuffer(Inputs.Contents, FileName);
+  auto Bounds = ComputePreambleBounds(*CI.getLangOpts(), *ContentsBuffer, 0);
+  auto VFS = Inputs.TFS->view(Inputs.CompileCommand.Directory);
+  if (!Shared.Preamble->CanReuse(CI, *ContentsBuffer, Bounds, *VFS))
+    return nullptr;
+
+  // The preamble region only holds #include directives, so everything
+  // collected from it carries over once the other main file is renamed to this
+  // one.
+  std::string MainFileName = CI.getFrontendOpts().Inputs[0].getFile().str();
+  IncludeStructure Includes = Shared.Includes;
+  Includes.aliasFile(MainFileName, Shared.MainFileName);
+  std::vector<Diag> Diags = Shared.Diags;
+  auto Rename = [&](DiagBase &D) {
+    if (!D.InsideMainFile)
+      return;
+    D.File = MainFileName;
+    if (D.AbsFile)
+      D.AbsFile = FileName.str();
+  };
+  for (Diag &D : Diags) {
+    Rename(D);
+    for (Note &N : D.Notes)
+      Rename(N);
+  }
+
+  vlog("Sharing preamble of {0} with file {1} version {2}",
+       Shared.CompileCommand.Filename, FileName, Inputs.Version);
+  auto Result = std::make_shared<PreambleData>(
+      Inputs, Shared.Preamble, std::move(Diags), std::move(Includes),
+      Shared.Macros, Shared.StatCache, Shared.CanonIncludes);
+  Result->MainFileName = std::move(MainFileName);
+  return Result;
 }
 
 void escapeBackslashAndQuotes(llvm::StringRef Text, llvm::raw_ostream &OS) {
@@ -411,7 +527,7 @@ PreamblePatch PreamblePatch::create(llvm::StringRef FileName,
   //   there's nothing to do but generate an empty patch.
   auto BaselineScan = scanPreamble(
       // Contents needs to be null-terminated.
-      Baseline.Preamble.getContents().str(), Modified.CompileCommand);
+      Baseline.Preamble->getContents().str(), Modified.CompileCommand);
   if (!BaselineScan) {
     elog("Failed to scan baseline of {0}: {1}", FileName,
          BaselineScan.takeError());
@@ -522,7 +638,7 @@ std::vector<Inclusion> PreamblePatch::preambleIncludes() const {
 PreamblePatch PreamblePatch::unmodified(const PreambleData &Preamble) {
   PreamblePatch PP;
   PP.PreambleIncludes = Preamble.Includes.MainFileIncludes;
-  PP.ModifiedBounds = Preamble.Preamble.getBounds();
+  PP.ModifiedBounds = Preamble.Preamble->getBounds();
   return PP;
 }
 
@@ -47,16 +47,21 @@ namespace clangd {
 /// As we must avoid re-parsing the preamble, any information that can only
 /// be obtained during parsing must be eagerly captured and stored here.
 struct PreambleData {
-  PreambleData(const ParseInputs &Inputs, PrecompiledPreamble Preamble,
+  PreambleData(const ParseInputs &Inputs,
+               std::shared_ptr<const PrecompiledPreamble> Preamble,
                std::vector<Diag> Diags, IncludeStructure Includes,
                MainFileMacros Macros,
-               std::unique_ptr<PreambleFileStatusCache> StatCache,
+               std::shared_ptr<const PreambleFileStatusCache> StatCache,
                CanonicalIncludes CanonIncludes);
 
   // Version of the ParseInputs this preamble was built from.
   std::string Version;
   tooling::CompileCommand CompileCommand;
-  PrecompiledPreamble Preamble;
+  // The main file's name as seen by clang, the root of Includes.
+  std::string MainFileName;
+  // Shared with the preambles of other files that reuse it, see
+  // sharePreamble().
+  std::shared_ptr<const PrecompiledPreamble> Preamble;
   std::vector<Diag> Diags;
   // Processes like code completions and go-to-definitions will need #include
   // information, and their compile action skips preamble range.
@@ -67,7 +72,7 @@ struct PreambleData {
   MainFileMacros Macros;
   // Cache of FS operations performed when building the preamble.
   // When reusing a preamble, this cache can be consumed to save IO.
-  std::unique_ptr<PreambleFileStatusCache> StatCache;
+  std::shared_ptr<const PreambleFileStatusCache> StatCache;
   CanonicalIncludes CanonIncludes;
 };
 
@@ -91,6 +96,22 @@ bool isPreambleCompatible(const PreambleData &Preamble,
                           const ParseInputs &Inputs, PathRef FileName,
                           const CompilerInvocation &CI);
 
+/// Returns the key under which preambles that other files may share are
+/// cached. Files get the same key when they live in the same directory, start
+/// with the same preamble region and are compiled with the same flags.
+/// Returns an empty key if the preamble region holds anything but #include
+/// directives, e.g. macro definitions: the preamble would locate them in the
+/// file that built it.
+std::string sharedPreambleKey(PathRef FileName, const ParseInputs &Inputs,
+                              const CompilerInvocation &CI);
+
+/// Reuses \p Shared, which was built for a file with the same
+/// sharedPreambleKey(), as the preamble of \p FileName. Returns null if a file
+/// \p Shared depends on has changed since it was built.
+std::shared_ptr<const PreambleData>
+sharePreamble(const PreambleData &Shared, PathRef FileName,
+              const ParseInputs &Inputs, const CompilerInvocation &CI);
+
 /// Stores information required to parse a TU using a (possibly stale) Baseline
 /// preamble. Later on this information can be injected into the main file by
 /// updating compiler invocation with \c apply. This injected section
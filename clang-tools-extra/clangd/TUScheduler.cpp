@@ -301,6 +301,38 @@ public:
   }
 };
 
+/// Preambles of open files, indexed by sharedPreambleKey() so that other files
+/// with the same preamble region and compile flags can reuse them.
+///
+/// Only weak references are kept: a preamble stays available for sharing as
+/// long as some file uses it. All methods are threadsafe, they're called from
+/// the preamble threads.
+class TUScheduler::SharedPreambleCache {
+  llvm::StringMap<std::weak_ptr<const PreambleData>> Preambles;
+  std::mutex Mu;
+
+public:
+  /// Returns a live preamble stored under \p Key, or null.
+  std::shared_ptr<const PreambleData> get(llvm::StringRef Key) {
+    std::lock_guard<std::mutex> Lock(Mu);
+    auto It = Preambles.find(Key);
+    return It == Preambles.end() ? nullptr : It->second.lock();
+  }
+
+  /// Stores \p Preamble under \p Key, replacing any previous entry.
+  void put(llvm::StringRef Key, std::shared_ptr<const PreambleData> Preamble) {
+    std::lock_guard<std::mutex> Lock(Mu);
+    // Drop the entries of preambles no file uses anymore.
+    for (auto It = Preambles.begin(); It != Preambles.end();) {
+      auto Next = std::next(It);
+      if (It->second.expired())
+        Preambles.erase(It);
+      It = Next;
+    }
+    Preambles[Key] = std::move(Preamble);
+  }
+};
+
 namespace {
 
 bool isReliable(const tooling::CompileCommand &Cmd) {
@@ -350,10 +382,12 @@ public:
                  bool StorePreambleInMemory, bool RunSync,
                  SynchronizedTUStatus &Status,
                  TUScheduler::HeaderIncluderCache &HeaderIncluders,
+                 TUScheduler::SharedPreambleCache *SharedPreambles,
                  ASTWorker &AW)
       : FileName(FileName), Callbacks(Callbacks),
         StoreInMemory(StorePreambleInMemory), RunSync(RunSync), Status(Status),
-        ASTPeer(AW), HeaderIncluders(HeaderIncluders) {}
+        ASTPeer(AW), HeaderIncluders(HeaderIncluders),
+        SharedPreambles(SharedPreambles) {}
 
   /// It isn't guaranteed that each requested version will be built. If there
   /// are multiple update requests while building a preamble, only the last one
@@ -463,6 +497,11 @@ private:
   /// Notifies ASTWorker after build finishes.
   void build(Request Req);
 
+  /// Passes the AST of LatestBuild, a preamble shared from another file, to
+  /// onPreambleAST() as if it had been built for this file.
+  void indexSharedPreamble(const CompilerInvocation &CI,
+                           const ParseInputs &Inputs);
+
   mutable std::mutex Mutex;
   bool Done = false;                  /* GUARDED_BY(Mutex) */
   llvm::Optional<Request> NextReq;    /* GUARDED_BY(Mutex) */
@@ -481,6 +520,8 @@ private:
   SynchronizedTUStatus &Status;
   ASTWorker &ASTPeer;
   TUScheduler::HeaderIncluderCache &HeaderIncluders;
+  // Null unless preambles are shared between files.
+  TUScheduler::SharedPreambleCache *SharedPreambles;
 };
 
 class ASTWorkerHandle;
@@ -500,6 +541,7 @@ class ASTWorker {
   ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
             TUScheduler::ASTCache &LRUCache,
             TUScheduler::HeaderIncluderCache &HeaderIncluders,
+            TUScheduler::SharedPreambleCache *SharedPreambles,
             Semaphore &Barrier, bool RunSync, const TUScheduler::Options &Opts,
             ParsingCallbacks &Callbacks);
 
@@ -513,6 +555,7 @@ public:
   create(PathRef FileName, const GlobalCompilationDatabase &CDB,
          TUScheduler::ASTCache &IdleASTs,
          TUScheduler::HeaderIncluderCache &HeaderIncluders,
+         TUScheduler::SharedPreambleCache *SharedPreambles,
          AsyncTaskRunner *Tasks, Semaphore &Barrier,
          const TUScheduler::Options &Opts, ParsingCallbacks &Callbacks);
   ~ASTWorker();
@@ -708,12 +751,13 @@ ASTWorkerHandle
 ASTWorker::create(PathRef FileName, const GlobalCompilationDatabase &CDB,
                   TUScheduler::ASTCache &IdleASTs,
                   TUScheduler::HeaderIncluderCache &HeaderIncluders,
+                  TUScheduler::SharedPreambleCache *SharedPreambles,
                   AsyncTaskRunner *Tasks, Semaphore &Barrier,
                   const TUScheduler::Options &Opts,
                   ParsingCallbacks &Callbacks) {
-  std::shared_ptr<ASTWorker> Worker(
-      new ASTWorker(FileName, CDB, IdleASTs, HeaderIncluders, Barrier,
-                    /*RunSync=*/!Tasks, Opts, Callbacks));
+  std::shared_ptr<ASTWorker> Worker(new ASTWorker(
+      FileName, CDB, IdleASTs, HeaderIncluders, SharedPreambles, Barrier,
+      /*RunSync=*/!Tasks, Opts, Callbacks));
   if (Tasks) {
     Tasks->runAsync("ASTWorker:" + llvm::sys::path::filename(FileName),
                     [Worker]() { Worker->run(); });
@@ -727,6 +771,7 @@ ASTWorker::create(PathRef FileName, const GlobalCompilationDatabase &CDB,
 ASTWorker::ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
                      TUScheduler::ASTCache &LRUCache,
                      TUScheduler::HeaderIncluderCache &HeaderIncluders,
+                     TUScheduler::SharedPreambleCache *SharedPreambles,
                      Semaphore &Barrier, bool RunSync,
                      const TUScheduler::Options &Opts,
                      ParsingCallbacks &Callbacks)
@@ -735,7 +780,7 @@ ASTWorker::ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
       ContextProvider(Opts.ContextProvider), CDB(CDB), Callbacks(Callbacks),
       Barrier(Barrier), Done(false), Status(FileName, Callbacks),
       PreamblePeer(FileName, Callbacks, Opts.StorePreamblesInMemory, RunSync,
-                   Status, HeaderIncluders, *this) {
+                   Status, HeaderIncluders, SharedPreambles, *this) {
   // Set a fallback command because compile command can be accessed before
   // `Inputs` is initialized. Other fields are only used after initialization
   // from client inputs.
@@ -924,6 +969,26 @@ void PreambleThread::build(Request Req) {
          FileName, Inputs.Version, LatestBuild->Version);
   }
 
+  std::string SharedKey;
+  if (SharedPreambles)
+    SharedKey = sharedPreambleKey(FileName, Inputs, *Req.CI);
+  if (!SharedKey.empty()) {
+    std::shared_ptr<const PreambleData> Shared;
+    // A forced rebuild must not pick up a preamble built before it.
+    if (!Inputs.ForceRebuild)
+      Shared = SharedPreambles->get(SharedKey);
+    if (Shared && Shared != LatestBuild) {
+      if (auto Reused = sharePreamble(*Shared, FileName, Inputs, *Req.CI)) {
+        LatestBuild = std::move(Reused);
+        SharedPreambles->put(SharedKey, LatestBuild);
+        if (isReliable(LatestBuild->CompileCommand))
+          HeaderIncluders.update(FileName, LatestBuild->Includes.allHeaders());
+        indexSharedPreamble(*Req.CI, Inputs);
+        return;
+      }
+    }
+  }
+
   LatestBuild = clang::clangd::buildPreamble(
       FileName, *Req.CI, Inputs, StoreInMemory,
       [this, Version(Inputs.Version)](ASTContext &Ctx,
@@ -934,6 +999,31 @@ void PreambleThread::build(Request Req) {
       });
   if (LatestBuild && isReliable(LatestBuild->CompileCommand))
     HeaderIncluders.update(FileName, LatestBuild->Includes.allHeaders());
+  if (LatestBuild && !SharedKey.empty())
+    SharedPreambles->put(SharedKey, LatestBuild);
+}
+
+void PreambleThread::indexSharedPreamble(const CompilerInvocation &CI,
+                                         const ParseInputs &Inputs) {
+  trace::Span Tracer("IndexSharedPreamble");
+  // The AST of the preamble is gone once it's built. Parse just the preamble
+  // region on top of the PCH instead, which yields the same declarations.
+  ParseInputs PreambleInputs = Inputs;
+  PreambleInputs.Contents =
+      Inputs.Contents.substr(0, LatestBuild->Preamble->getBounds().Size);
+  PreambleInputs.Index = nullptr;
+  PreambleInputs.ClangTidyProvider = {};
+  auto AST = ParsedAST::build(FileName, PreambleInputs,
+                              std::make_unique<CompilerInvocation>(CI),
+                              /*CompilerInvocationDiags=*/{}, LatestBuild);
+  if (!AST) {
+    elog("Failed to index the shared preamble of {0} version {1}", FileName,
+         Inputs.Version);
+    return;
+  }
+  Callbacks.onPreambleAST(FileName, Inputs.Version, AST->getASTContext(),
+                          AST->getPreprocessorPtr(),
+                          LatestBuild->CanonIncludes);
 }
 
 void ASTWorker::updatePreamble(std::unique_ptr<CompilerInvocation> CI,
@@ -1123,7 +1213,7 @@ TUScheduler::FileStats ASTWorker::stats() const {
   // only, so this should be fine.
   Result.UsedBytesAST = IdleASTs.getUsedBytes(this);
   if (auto Preamble = getPossiblyStalePreamble())
-    Result.UsedBytesPreamble = Preamble->Preamble.getSize();
+    Result.UsedBytesPreamble = Preamble->Preamble->getSize();
   return Result;
 }
 
@@ -1453,6 +1543,8 @@ TUScheduler::TUScheduler(const GlobalCompilationDatabase &CDB,
       IdleASTs(
           std::make_unique<ASTCache>(Opts.RetentionPolicy.MaxRetainedASTs)),
       HeaderIncluders(std::make_unique<HeaderIncluderCache>()) {
+  if (Opts.SharePreambles)
+    SharedPreambles = std::make_unique<SharedPreambleCache>();
   // Avoid null checks everywhere.
   if (!Opts.ContextProvider) {
     this->Opts.ContextProvider = [](llvm::StringRef) {
@@ -1495,6 +1587,7 @@ bool TUScheduler::update(PathRef File, ParseInputs Inputs,
     // Create a new worker to process the AST-related tasks.
     ASTWorkerHandle Worker =
         ASTWorker::create(File, CDB, *IdleASTs, *HeaderIncluders,
+                          SharedPreambles.get(),
                           WorkerThreads ? WorkerThreads.getPointer() : nullptr,
                           Barrier, Opts, *Callbacks);
     FD = std::unique_ptr<FileData>(
@@ -189,6 +189,11 @@ public:
     /// Cache (large) preamble data in RAM rather than temporary files on disk.
     bool StorePreamblesInMemory = false;
 
+    /// Reuse the preamble of another open file in the same directory when the
+    /// preamble regions match and hold only #include directives, and the
+    /// compile flags match, instead of building one.
+    bool SharePreambles = false;
+
     /// Time to wait after an update to see if another one comes along.
     /// This tries to ensure we rebuild once the user stops typing.
     DebouncePolicy UpdateDebounce;
@@ -309,6 +314,8 @@ public:
   class ASTCache;
   /// Tracks headers included by open files, to get known-good compile commands.
   class HeaderIncluderCache;
+  /// Tracks preambles of open files that other files can reuse.
+  class SharedPreambleCache;
 
   // The file being built/processed in the current thread. This is a hack in
   // order to get the file name into the index implementations. Do not depend on
@@ -332,6 +339,8 @@ private:
   llvm::StringMap<std::unique_ptr<FileData>> Files;
   std::unique_ptr<ASTCache> IdleASTs;
   std::unique_ptr<HeaderIncluderCache> HeaderIncluders;
+  // Null unless Opts.SharePreambles is set.
+  std::unique_ptr<SharedPreambleCache> SharedPreambles;
   // None when running tasks synchronously and non-None when running tasks
   // asynchronously.
   llvm::Optional<AsyncTaskRunner> PreambleTasks;
@@ -0,0 +1,87 @@
+//===--- FuzzyMatchBenchmark.cpp - Clangd fuzzy matching benchmarks -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures how many identifiers per second FuzzyMatcher can score, as
+// workspace/symbol and code completion do for every candidate.
+//
+//===----------------------------------------------------------------------===//
+
+#include "FuzzyMatch.h"
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace clangd {
+namespace {
+
+// Builds identifiers in the styles found in C++ code bases, e.g.
+// "getBufferSize", "parse_header_line", "MAX_TOKEN_COUNT".
+std::vector<std::string> generateIdentifiers(int NumIdentifiers) {
+  static const char *Segments[] = {
+      "get",    "set",   "buffer", "size",  "parse",   "header", "line",
+      "token",  "count", "max",    "index", "symbol",  "file",   "path",
+      "unique", "ptr",   "emplace", "back", "request", "handle", "scope",
+      "query",  "result", "state", "node",  "visit",   "decl",   "type"};
+  std::mt19937 Rand(0);
+  auto Pick = [&] {
+    return llvm::StringRef(Segments[Rand() % llvm::array_lengthof(Segments)]);
+  };
+
+  std::vector<std::string> Identifiers;
+  Identifiers.reserve(NumIdentifiers);
+  for (int I = 0; I < NumIdentifiers; ++I) {
+    std::string Identifier;
+    unsigned Style = Rand() % 3;
+    for (unsigned Part = 0, Parts = 1 + Rand() % 4; Part < Parts; ++Part) {
+      llvm::StringRef Segment = Pick();
+      if (Style == 0) { // camelCase
+        if (Part)
+          Identifier += llvm::toUpper(Segment.front());
+        else
+          Identifier += Segment.front();
+        Identifier += Segment.drop_front();
+      } else if (Style == 1) { // snake_case
+        if (Part)
+          Identifier += '_';
+        Identifier += Segment;
+      } else { // UPPER_CASE
+        if (Part)
+          Identifier += '_';
+        Identifier += Segment.upper();
+      }
+    }
+    Identifiers.push_back(std::move(Identifier));
+  }
+  return Identifiers;
+}
+
+static void fuzzyMatch(benchmark::State &State, llvm::StringRef Pattern) {
+  const std::vector<std::string> Identifiers = generateIdentifiers(100000);
+  FuzzyMatcher Matcher(Pattern);
+  for (auto _ : State)
+    for (const std::string &Identifier : Identifiers)
+      benchmark::DoNotOptimize(Matcher.match(Identifier));
+  State.SetItemsProcessed(State.iterations() * Identifiers.size());
+}
+// Matches most identifiers.
+BENCHMARK_CAPTURE(fuzzyMatch, ShortPattern, "gs");
+// Matches some identifiers, with several alignments to score.
+BENCHMARK_CAPTURE(fuzzyMatch, LongPattern, "getBufSize");
+// Matches almost nothing, measures rejection.
+BENCHMARK_CAPTURE(fuzzyMatch, RareCharacters, "xyz");
+
+} // namespace
+} // namespace clangd
+} // namespace clang
+
+BENCHMARK_MAIN();
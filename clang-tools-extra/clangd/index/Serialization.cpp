@@ -160,6 +160,7 @@ void writeVar(uint32_t I, llvm::raw_ostream &OS) {
 // CompressedData is a zlib-compressed byte[UncompressedSize].
 // It contains a sequence of null-terminated strings, e.g. "foo\0bar\0".
 // These are sorted to improve compression.
+// An uncompressed table can be used in place, without copying the strings.
 
 // Maps each string to a canonical representation.
 // Strings remain owned externally (e.g. by SymbolSlab).
@@ -178,7 +179,7 @@ public:
   // Add a string to the table. Overwrites S if an identical string exists.
   void intern(llvm::StringRef &S) { S = *Unique.insert(S).first; };
   // Finalize the table and write it to OS. No more strings may be added.
-  void finalize(llvm::raw_ostream &OS) {
+  void finalize(llvm::raw_ostream &OS, bool Compress) {
     Sorted = {Unique.begin(), Unique.end()};
     llvm::sort(Sorted);
     for (unsigned I = 0; I < Sorted.size(); ++I)
@@ -189,7 +190,7 @@ public:
       RawTable.append(std::string(S));
       RawTable.push_back(0);
     }
-    if (llvm::zlib::isAvailable()) {
+    if (Compress && llvm::zlib::isAvailable()) {
       llvm::SmallString<1> Compressed;
       llvm::cantFail(llvm::zlib::compress(RawTable, Compressed));
       write32(RawTable.size(), OS);
@@ -210,6 +211,8 @@ public:
 struct StringTableIn {
   llvm::BumpPtrAllocator Arena;
   std::vector<llvm::StringRef> Strings;
+  // Whether Strings point into the table's data rather than into Arena.
+  bool InPlace = false;
 };
 
 llvm::Expected<StringTableIn> readStringTable(llvm::StringRef Data) {
@@ -241,12 +244,16 @@ llvm::Expected<StringTableIn> readStringTable(llvm::StringRef Data) {
 
   StringTableIn Table;
   llvm::StringSaver Saver(Table.Arena);
+  // The strings of an uncompressed table are null-terminated in place already,
+  // only decompressed ones need a copy which outlives this function.
+  Table.InPlace = UncompressedSize == 0;
   R = Reader(Uncompressed);
   for (Reader R(Uncompressed); !R.eof();) {
     auto Len = R.rest().find(0);
     if (Len == llvm::StringRef::npos)
       return error("Bad string table: not null terminated");
-    Table.Strings.push_back(Saver.save(R.consume(Len)));
+    llvm::StringRef S = R.consume(Len);
+    Table.Strings.push_back(Table.InPlace ? S : Saver.save(S));
     R.consume8();
   }
   if (R.err())
@@ -454,7 +461,9 @@ readCompileCommand(Reader CmdReader, llvm::ArrayRef<llvm::StringRef> Strings) {
 // data. Later we may want to support some backward compatibility.
 constexpr static uint32_t Version = 16;
 
-llvm::Expected<IndexFileIn> readRIFF(llvm::StringRef Data) {
+// Returns the chunks of a RIFF index file, keyed by their IDs.
+llvm::Expected<llvm::StringMap<llvm::StringRef>>
+readRIFFChunks(llvm::StringRef Data) {
   auto RIFF = riff::readFile(Data);
   if (!RIFF)
     return RIFF.takeError();
@@ -476,6 +485,14 @@ llvm::Expected<IndexFileIn> readRIFF(llvm::StringRef Data) {
   for (llvm::StringRef RequiredChunk : {"stri"})
     if (!Chunks.count(RequiredChunk))
       return error("missing required chunk {0}", RequiredChunk);
+  return std::move(Chunks);
+}
+
+llvm::Expected<IndexFileIn> readRIFF(llvm::StringRef Data) {
+  auto ChunksOrErr = readRIFFChunks(Data);
+  if (!ChunksOrErr)
+    return ChunksOrErr.takeError();
+  const llvm::StringMap<llvm::StringRef> &Chunks = *ChunksOrErr;
 
   auto Strings = readStringTable(Chunks.lookup("stri"));
   if (!Strings)
@@ -544,6 +561,55 @@ llvm::Expected<IndexFileIn> readRIFF(llvm::StringRef Data) {
   return std::move(Result);
 }
 
+// The symbols, refs and relations of a RIFF index file, whose strings point
+// into the file's data instead of being copied into slabs.
+struct InPlaceIndexContents {
+  std::vector<Symbol> Symbols;
+  std::vector<std::pair<SymbolID, std::vector<Ref>>> Refs;
+  std::vector<Relation> Relations;
+};
+
+// Reads the parts of a RIFF index file needed to serve queries, without
+// copying its strings. Returns None if the string table is compressed, and
+// thus can't be used in place.
+llvm::Expected<llvm::Optional<InPlaceIndexContents>>
+readRIFFInPlace(llvm::StringRef Data) {
+  auto ChunksOrErr = readRIFFChunks(Data);
+  if (!ChunksOrErr)
+    return ChunksOrErr.takeError();
+  const llvm::StringMap<llvm::StringRef> &Chunks = *ChunksOrErr;
+
+  auto Strings = readStringTable(Chunks.lookup("stri"));
+  if (!Strings)
+    return Strings.takeError();
+  if (!Strings->InPlace)
+    return llvm::None;
+
+  InPlaceIndexContents Result;
+  if (Chunks.count("symb")) {
+    Reader SymbolReader(Chunks.lookup("symb"));
+    while (!SymbolReader.eof())
+      Result.Symbols.push_back(readSymbol(SymbolReader, Strings->Strings));
+    if (SymbolReader.err())
+      return error("malformed or truncated symbol");
+  }
+  if (Chunks.count("refs")) {
+    Reader RefsReader(Chunks.lookup("refs"));
+    while (!RefsReader.eof())
+      Result.Refs.push_back(readRefs(RefsReader, Strings->Strings));
+    if (RefsReader.err())
+      return error("malformed or truncated refs");
+  }
+  if (Chunks.count("rela")) {
+    Reader RelationsReader(Chunks.lookup("rela"));
+    while (!RelationsReader.eof())
+      Result.Relations.push_back(readRelation(RelationsReader));
+    if (RelationsReader.err())
+      return error("malformed or truncated relations");
+  }
+  return llvm::Optional<InPlaceIndexContents>(std::move(Result));
+}
+
 template <class Callback>
 void visitStrings(IncludeGraphNode &IGN, const Callback &CB) {
   CB(IGN.URI);
@@ -612,7 +678,7 @@ void writeRIFF(const IndexFileOut &Data, llvm::raw_ostream &OS) {
   std::string StringSection;
   {
     llvm::raw_string_ostream StringOS(StringSection);
-    Strings.finalize(StringOS);
+    Strings.finalize(StringOS, Data.CompressStrings);
   }
   RIFF.Chunks.push_back({riff::fourCC("stri"), StringSection});
 
@@ -695,15 +761,70 @@ llvm::Expected<IndexFileIn> readIndexFile(llvm::StringRef Data) {
   }
 }
 
+// Builds an index whose symbols and refs point into the buffer holding the
+// index file, which the index keeps alive.
+static std::unique_ptr<SymbolIndex>
+buildInPlaceIndex(llvm::StringRef SymbolFilename,
+                  InPlaceIndexContents Contents,
+                  std::unique_ptr<llvm::MemoryBuffer> Buffer, bool UseDex) {
+  size_t NumSym = Contents.Symbols.size();
+  size_t NumRefs = 0;
+  for (const auto &SymbolRefs : Contents.Refs)
+    NumRefs += SymbolRefs.second.size();
+  size_t NumRelations = Contents.Relations.size();
+  size_t BackingDataSize = Buffer->getBufferSize() + NumSym * sizeof(Symbol) +
+                           NumRefs * sizeof(Ref);
+
+  trace::Span Tracer("BuildIndex");
+  auto Data = std::make_pair(std::move(Contents), std::move(Buffer));
+  std::unique_ptr<SymbolIndex> Index;
+  if (UseDex)
+    Index = std::make_unique<dex::Dex>(Data.first.Symbols, Data.first.Refs,
+                                       Data.first.Relations, std::move(Data),
+                                       BackingDataSize);
+  else
+    Index = std::make_unique<MemIndex>(Data.first.Symbols, Data.first.Refs,
+                                       Data.first.Relations, std::move(Data),
+                                       BackingDataSize);
+  vlog("Loaded {0} in place from {1} with estimated memory usage {2} bytes\n"
+       "  - number of symbols: {3}\n"
+       "  - number of refs: {4}\n"
+       "  - number of relations: {5}",
+       UseDex ? "Dex" : "MemIndex", SymbolFilename,
+       Index->estimateMemoryUsage(), NumSym, NumRefs, NumRelations);
+  return Index;
+}
+
 std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
                                        bool UseDex) {
   trace::Span OverallTracer("LoadIndex");
-  auto Buffer = llvm::MemoryBuffer::getFile(SymbolFilename);
+  // The index may point into the buffer for as long as clangd runs, while the
+  // file may be regenerated in place at any time. So read the file rather
+  // than mapping it, which would turn every later access into a SIGBUS once
+  // the file is truncated.
+  auto Buffer = llvm::MemoryBuffer::getFile(SymbolFilename, /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false,
+                                            /*IsVolatile=*/true);
   if (!Buffer) {
     elog("Can't open {0}: {1}", SymbolFilename, Buffer.getError().message());
     return nullptr;
   }
 
+  // Binary indexes with an uncompressed string table are used in place.
+  if (Buffer->get()->getBuffer().startswith("RIFF")) {
+    auto Contents = [&] {
+      trace::Span Tracer("ParseIndex");
+      return readRIFFInPlace(Buffer->get()->getBuffer());
+    }();
+    if (!Contents) {
+      elog("Bad index file: {0}", Contents.takeError());
+      return nullptr;
+    }
+    if (*Contents)
+      return buildInPlaceIndex(SymbolFilename, std::move(**Contents),
+                               std::move(*Buffer), UseDex);
+  }
+
   SymbolSlab Symbols;
   RefSlab Refs;
   RelationSlab Relations;
@@ -60,6 +60,10 @@ struct IndexFileOut {
   const IncludeGraph *Sources = nullptr;
   // TODO: Support serializing Dex posting lists.
   IndexFileFormat Format = IndexFileFormat::RIFF;
+  // Whether to compress the string table of a RIFF file, if zlib is available.
+  // loadIndex() uses the strings of an uncompressed table where they are in
+  // the file's contents instead of copying them one by one.
+  bool CompressStrings = true;
   const tooling::CompileCommand *Cmd = nullptr;
 
   IndexFileOut() = default;
@@ -87,6 +91,8 @@ llvm::Expected<clangd::Ref> refFromYAML(StringRef YAML,
 
 // Build an in-memory static index from an index file.
 // The size should be relatively small, so data can be managed in memory.
+// The strings of a RIFF file with an uncompressed string table are used in
+// place, from a copy of the whole file kept by the index.
 std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef Filename,
                                        bool UseDex = true);
 
@@ -36,6 +36,13 @@ static llvm::cl::opt<IndexFileFormat>
                                        "binary RIFF format")),
            llvm::cl::init(IndexFileFormat::RIFF));
 
+static llvm::cl::opt<bool> CompressStrings(
+    "compress-strings",
+    llvm::cl::desc("Compress the string table of a binary index. An "
+                   "uncompressed index is larger, but clangd loads it faster "
+                   "because it uses the strings where they are in the file"),
+    llvm::cl::init(true));
+
 class IndexActionFactory : public tooling::FrontendActionFactory {
 public:
   IndexActionFactory(IndexFileIn &Result) : Result(Result) {}
@@ -143,6 +150,7 @@ int main(int argc, const char **argv) {
   // Emit collected data.
   clang::clangd::IndexFileOut Out(Data);
   Out.Format = clang::clangd::Format;
+  Out.CompressStrings = clang::clangd::CompressStrings;
   llvm::outs() << Out;
   return 0;
 }
@@ -359,6 +359,14 @@ opt<PCHStorageFlag> PCHStorage{
     init(PCHStorageFlag::Disk),
 };
 
+opt<bool> SharePreambles{
+    "share-preambles",
+    cat(Misc),
+    desc("Reuse the preamble of an open file for other files in its directory "
+         "that start with the same includes and use the same flags"),
+    init(false),
+};
+
 opt<bool> Sync{
     "sync",
     cat(Misc),
@@ -783,6 +791,7 @@ clangd accepts flags on the commandline, and in the CLANGD_FLAGS environment var
     Opts.StorePreamblesInMemory = false;
     break;
   }
+  Opts.SharePreambles = SharePreambles;
   if (!ResourceDir.empty())
     Opts.ResourceDir = ResourceDir;
   Opts.BuildDynamicSymbolIndex = true;
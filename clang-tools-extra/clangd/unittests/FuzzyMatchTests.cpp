@@ -83,6 +83,10 @@ TEST(FuzzyMatch, Matches) {
   EXPECT_THAT("uq", Not(matches("unique_ptr")));
   EXPECT_THAT("qp", Not(matches("unique_ptr")));
   EXPECT_THAT("log", Not(matches("SVGFEMorphologyElement")));
+  EXPECT_THAT("xyz", Not(matches("unique_ptr")));
+  // '0' and 'p' share a bit in the character bag.
+  EXPECT_THAT("p0", Not(matches("x0")));
+  EXPECT_THAT("p0", matches("[p0]"));
 
   EXPECT_THAT("tit", matches("win.[tit]"));
   EXPECT_THAT("title", matches("win.[title]"));
@@ -16,6 +16,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ScopedPrinter.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -235,6 +236,66 @@ TEST(SerializationTest, BinaryConversions) {
               UnorderedElementsAreArray(YAMLFromRelations(*In->Relations)));
 }
 
+TEST(SerializationTest, LoadUncompressedInPlace) {
+  auto In = readIndexFile(YAML);
+  ASSERT_TRUE(bool(In)) << In.takeError();
+
+  // Write a RIFF file whose string table can be used in place.
+  IndexFileOut Out(*In);
+  Out.Format = IndexFileFormat::RIFF;
+  Out.CompressStrings = false;
+  llvm::SmallString<128> Path;
+  int FD;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("clangd-index", "idx", FD, Path));
+  auto RemoveFile =
+      llvm::make_scope_exit([&] { llvm::sys::fs::remove(Path); });
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Out;
+  }
+
+  for (bool UseDex : {true, false}) {
+    auto Index = loadIndex(Path, UseDex);
+    ASSERT_TRUE(Index);
+
+    // The index must not depend on the file once it is loaded, since the file
+    // may be regenerated in place.
+    llvm::SmallString<128> Contents;
+    {
+      auto Buffer = llvm::MemoryBuffer::getFile(Path);
+      ASSERT_TRUE(bool(Buffer));
+      Contents = (*Buffer)->getBuffer();
+      std::error_code EC;
+      llvm::raw_fd_ostream OS(Path, EC);
+      ASSERT_FALSE(EC);
+    }
+    auto RestoreFile = llvm::make_scope_exit([&] {
+      std::error_code EC;
+      llvm::raw_fd_ostream OS(Path, EC);
+      OS << Contents;
+    });
+
+    LookupRequest Lookup;
+    Lookup.IDs.insert(cantFail(SymbolID::fromStr("057557CEBF6E6B2D")));
+    std::vector<Symbol> Found;
+    Index->lookup(Lookup, [&](const Symbol &S) { Found.push_back(S); });
+    ASSERT_EQ(Found.size(), 1u);
+    EXPECT_THAT(Found.front(), QName("clang::Foo1"));
+    EXPECT_EQ(Found.front().Documentation, "Foo doc");
+    EXPECT_STREQ(Found.front().CanonicalDeclaration.FileURI,
+                 "file:///path/foo.h");
+
+    RefsRequest Refs;
+    Refs.IDs = Lookup.IDs;
+    std::vector<std::string> RefURIs;
+    Index->refs(Refs, [&](const Ref &R) {
+      RefURIs.push_back(R.Location.FileURI);
+    });
+    EXPECT_THAT(RefURIs, ElementsAre("file:///path/foo.cc"));
+  }
+}
+
 TEST(SerializationTest, SrcsTest) {
   auto In = readIndexFile(YAML);
   EXPECT_TRUE(bool(In)) << In.takeError();
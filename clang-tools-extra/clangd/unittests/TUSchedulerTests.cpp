@@ -682,7 +682,7 @@ TEST_F(TUSchedulerTests, EmptyPreamble) {
       [&](Expected<InputsAndPreamble> Preamble) {
         // We expect to get a non-empty preamble.
         EXPECT_GT(
-            cantFail(std::move(Preamble)).Preamble->Preamble.getBounds().Size,
+            cantFail(std::move(Preamble)).Preamble->Preamble->getBounds().Size,
             0u);
       });
   // Wait while the preamble is being built.
@@ -697,11 +697,85 @@ TEST_F(TUSchedulerTests, EmptyPreamble) {
       [&](Expected<InputsAndPreamble> Preamble) {
         // We expect to get an empty preamble.
         EXPECT_EQ(
-            cantFail(std::move(Preamble)).Preamble->Preamble.getBounds().Size,
+            cantFail(std::move(Preamble)).Preamble->Preamble->getBounds().Size,
             0u);
       });
 }
 
+TEST_F(TUSchedulerTests, SharedPreamble) {
+  // Records the files whose preamble AST declares foo().
+  class IndexedFiles : public ParsingCallbacks {
+  public:
+    IndexedFiles(std::vector<std::string> &Files, std::mutex &Mu)
+        : Files(Files), Mu(Mu) {}
+    void onPreambleAST(PathRef Path, llvm::StringRef Version, ASTContext &Ctx,
+                       std::shared_ptr<clang::Preprocessor> PP,
+                       const CanonicalIncludes &) override {
+      if (Ctx.getTranslationUnitDecl()->lookup(&Ctx.Idents.get("foo")).empty())
+        return;
+      std::lock_guard<std::mutex> Lock(Mu);
+      Files.push_back(Path.str());
+    }
+
+  private:
+    std::vector<std::string> &Files;
+    std::mutex &Mu;
+  };
+
+  auto Opts = optsForTest();
+  Opts.SharePreambles = true;
+  std::vector<std::string> Indexed;
+  std::mutex IndexedMu;
+  TUScheduler S(CDB, Opts, std::make_unique<IndexedFiles>(Indexed, IndexedMu));
+
+  auto Foo = testPath("foo.cpp");
+  auto Bar = testPath("bar.cpp");
+  auto Baz = testPath("baz.cpp");
+  auto Qux = testPath("qux.cpp");
+  auto Header = testPath("foo.h");
+  FS.Files[Header] = "int foo();";
+  FS.Timestamps[Header] = time_t(0);
+
+  auto GetPCH = [&](PathRef File) {
+    const PrecompiledPreamble *PCH = nullptr;
+    S.runWithPreamble("GetPCH", File, TUScheduler::Stale,
+                      [&](Expected<InputsAndPreamble> Preamble) {
+                        PCH = cantFail(std::move(Preamble))
+                                  .Preamble->Preamble.get();
+                      });
+    EXPECT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+    return PCH;
+  };
+
+  S.update(Foo, getInputs(Foo, "#include \"foo.h\"\nint a = foo();"),
+           WantDiagnostics::Yes);
+  S.update(Baz, getInputs(Baz, "#include \"foo.h\"\n#define X\nint c;"),
+           WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  // Same preamble region: the preamble of foo.cpp is reused.
+  S.update(Bar, getInputs(Bar, "#include \"foo.h\"\nint b = foo();"),
+           WantDiagnostics::Yes);
+  // Same preamble region, but it defines a macro: a preamble is built.
+  S.update(Qux, getInputs(Qux, "#include \"foo.h\"\n#define X\nint d;"),
+           WantDiagnostics::Yes);
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+
+  EXPECT_EQ(GetPCH(Foo), GetPCH(Bar));
+  EXPECT_NE(GetPCH(Foo), GetPCH(Baz));
+  EXPECT_NE(GetPCH(Baz), GetPCH(Qux));
+  // The preamble is indexed for each file, shared or not.
+  EXPECT_THAT(Indexed, UnorderedElementsAre(Foo, Bar, Baz, Qux));
+
+  S.runWithAST("CheckAST", Bar, [&](Expected<InputsAndAST> AST) {
+    ASSERT_TRUE(bool(AST));
+    EXPECT_THAT(*AST->AST.getDiagnostics(), IsEmpty());
+    ASSERT_THAT(AST->AST.getIncludeStructure().MainFileIncludes, SizeIs(1));
+    EXPECT_EQ(AST->AST.getIncludeStructure().MainFileIncludes[0].Written,
+              "\"foo.h\"");
+  });
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+}
+
 TEST_F(TUSchedulerTests, ASTSignalsSmokeTests) {
   TUScheduler S(CDB, optsForTest());
   auto Foo = testPath("foo.cpp");
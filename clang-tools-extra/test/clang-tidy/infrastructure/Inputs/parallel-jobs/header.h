@@ -0,0 +1 @@
+struct H { H(int); };
@@ -0,0 +1,3 @@
+#include "header.h"
+
+struct B { B(int); };
@@ -0,0 +1,17 @@
+// RUN: clang-tidy -checks='-*,google-explicit-constructor' -header-filter='.*' %s %S/Inputs/parallel-jobs/second.cpp -- -I %S/Inputs/parallel-jobs > %t.1.txt 2>&1
+// RUN: clang-tidy -j 2 -checks='-*,google-explicit-constructor' -header-filter='.*' %s %S/Inputs/parallel-jobs/second.cpp -- -I %S/Inputs/parallel-jobs > %t.2.txt 2>&1
+// RUN: diff %t.1.txt %t.2.txt
+// RUN: FileCheck %s < %t.2.txt
+
+#include "header.h"
+
+struct A { A(int); };
+
+// The warning in the shared header is reported once, and the counts printed
+// after each file are running totals, as when the files run one at a time.
+// CHECK: 2 warnings generated.
+// CHECK-NEXT: 4 warnings generated.
+// CHECK: header.h:1:12: warning: single-argument constructors must be marked explicit
+// CHECK-NOT: header.h:1:12: warning
+// CHECK: second.cpp:3:12: warning: single-argument constructors must be marked explicit
+// CHECK: parallel-jobs.cpp:8:12: warning: single-argument constructors must be marked explicit
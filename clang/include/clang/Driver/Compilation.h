@@ -129,6 +129,24 @@ class Compilation {
   /// Whether to keep temporary files regardless of -save-temps.
   bool ForceKeepTempFiles = false;
 
+  /// The maximum number of jobs of an offloading compilation to run at the
+  /// same time.
+  unsigned ParallelJobs = 1;
+
+  /// Print the command line of \p C for -v or CC_PRINT_OPTIONS.
+  ///
+  /// \return False if the CC_PRINT_OPTIONS file could not be opened.
+  bool LogCommand(const Command &C) const;
+
+  /// Execute the jobs of an offloading compilation, running up to
+  /// ParallelJobs of them at the same time. Jobs start once the jobs they
+  /// depend on have finished, and their command lines are logged as they
+  /// start. Their output and diagnostics are replayed in job order so that
+  /// they do not depend on scheduling.
+  void ExecuteJobsInParallel(
+      const JobList &Jobs,
+      SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
+
 public:
   Compilation(const Driver &D, const ToolChain &DefaultToolChain,
               llvm::opt::InputArgList *Args,
@@ -225,6 +243,10 @@ public:
     PostCallback = CB;
   }
 
+  /// Set the maximum number of jobs of an offloading compilation to run at
+  /// the same time.
+  void setParallelJobs(unsigned N) { ParallelJobs = N; }
+
   /// Returns the sysroot path.
   StringRef getSysRoot() const;
 
@@ -164,6 +164,13 @@ public:
   /// regenerated often.
   unsigned ModuleCachePruneAfter = 31 * 24 * 60 * 60;
 
+  /// The maximum number of implicit modules that are built concurrently.
+  ///
+  /// Before a module is built, the modules that its module map says it uses
+  /// or exports and that are missing from the module cache are built on up to
+  /// this many threads.
+  unsigned ModuleBuildJobs = 1;
+
   /// The time in seconds when the build session started.
   ///
   /// This time is used by other optimizations in header search and module
@@ -135,6 +135,14 @@ class Lexer : public PreprocessorLexer {
   // CurrentConflictMarkerState - The kind of conflict marker we are handling.
   ConflictMarkerKind CurrentConflictMarkerState;
 
+  // UnskippableStart/UnskippableEnd - The text before the character that the
+  // last call to skipExcludedLines stopped at, in which it found nothing to
+  // skip.  A later call starting in this range returns right away instead of
+  // scanning it again.  The buffer never changes, so this needs no save and
+  // restore code.
+  const char *UnskippableStart;
+  const char *UnskippableEnd;
+
   void InitLexer(const char *BufStart, const char *BufPtr, const char *BufEnd);
 
 public:
@@ -284,6 +292,15 @@ public:
   /// end of the buffer), false otherwise.
   bool skipOver(unsigned NumBytes);
 
+  /// Skip over the text of an excluded conditional block without lexing it,
+  /// up to the next '#' that may start a directive.
+  ///
+  /// Only whitespace and comments are skipped this way, a line at a time
+  /// where possible. This stops early, between two tokens, at anything the
+  /// full lexer is needed for, like string and character literals. The lexer
+  /// must be in raw mode and not parsing a directive.
+  void skipExcludedLines();
+
   /// Stringify - Convert the specified string into a C string by i) escaping
   /// '\\' and " characters and ii) replacing newline character(s) with "\\n".
   /// If Charify is true, this escapes the ' character instead of ".
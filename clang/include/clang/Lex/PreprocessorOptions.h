@@ -17,6 +17,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -176,13 +177,16 @@ public:
   /// Records the set of modules
   class FailedModulesSet {
     llvm::StringSet<> Failed;
+    std::mutex Lock;
 
   public:
     bool hasAlreadyFailed(StringRef module) {
+      std::lock_guard<std::mutex> Guard(Lock);
       return Failed.count(module) > 0;
     }
 
     void addFailed(StringRef module) {
+      std::lock_guard<std::mutex> Guard(Lock);
       Failed.insert(module);
     }
   };
@@ -14,6 +14,8 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace clang {
 
@@ -27,7 +29,12 @@ namespace clang {
 /// Critically, it ensures that a single process has a consistent view of each
 /// PCM.  This is used by \a CompilerInstance when building PCMs to ensure that
 /// each \a ModuleManager sees the same files.
-class InMemoryModuleCache : public llvm::RefCountedBase<InMemoryModuleCache> {
+///
+/// The cache is thread-safe. Between \a beginConcurrentBuilds() and
+/// \a endConcurrentBuilds(), modules can be built concurrently by compiler
+/// instances sharing it.
+class InMemoryModuleCache
+    : public llvm::ThreadSafeRefCountedBase<InMemoryModuleCache> {
   struct PCM {
     std::unique_ptr<llvm::MemoryBuffer> Buffer;
 
@@ -44,9 +51,23 @@ class InMemoryModuleCache : public llvm::RefCountedBase<InMemoryModuleCache> {
   /// Cache of buffers.
   llvm::StringMap<PCM> PCMs;
 
+  /// The number of concurrent builds in progress.
+  unsigned ConcurrentBuilds = 0;
+
+  /// Buffers that were dropped from the cache during concurrent builds.
+  /// They're kept alive until the builds are done, as another thread may
+  /// still be reading them.
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> DroppedBuffers;
+
+  mutable std::mutex Lock;
+
 public:
   /// There are four states for a PCM.  It must monotonically increase.
   ///
+  /// During concurrent builds, another thread may change the state between
+  /// this thread's calls. The preconditions below are relaxed accordingly,
+  /// but the state still only increases.
+  ///
   ///  1. Unknown: the PCM has neither been read from disk nor built.
   ///  2. Tentative: the PCM has been read from disk but not yet imported or
   ///     built.  It might work.
@@ -61,33 +82,43 @@ public:
 
   /// Store the PCM under the Filename.
   ///
-  /// \pre state is Unknown
-  /// \post state is Tentative
-  /// \return a reference to the buffer as a convenience.
+  /// \pre state is Unknown, or anything during concurrent builds.
+  /// \post state is Tentative, or unchanged if it was not Unknown.
+  /// \return a reference to the buffer as a convenience. If another thread
+  /// stored a buffer first, that one.
   llvm::MemoryBuffer &addPCM(llvm::StringRef Filename,
                              std::unique_ptr<llvm::MemoryBuffer> Buffer);
 
   /// Store a just-built PCM under the Filename.
   ///
-  /// \pre state is Unknown or ToBuild.
-  /// \pre state is not Tentative.
-  /// \return a reference to the buffer as a convenience.
+  /// \pre state is Unknown or ToBuild, or anything during concurrent builds.
+  /// \post state is Final.
+  /// \return a reference to the buffer as a convenience. If another thread
+  /// built the PCM first, its buffer.
   llvm::MemoryBuffer &addBuiltPCM(llvm::StringRef Filename,
                                   std::unique_ptr<llvm::MemoryBuffer> Buffer);
 
   /// Try to remove a buffer from the cache.  No effect if state is Final.
   ///
-  /// \pre state is Tentative/Final.
+  /// \pre state is Tentative/Final, or ToBuild during concurrent builds.
   /// \post Tentative => ToBuild or Final => Final.
   /// \return false on success, i.e. if Tentative => ToBuild.
   bool tryToDropPCM(llvm::StringRef Filename);
 
   /// Mark a PCM as final.
   ///
-  /// \pre state is Tentative or Final.
-  /// \post state is Final.
+  /// \pre state is Tentative or Final, or ToBuild during concurrent builds.
+  /// \post state is Final, or ToBuild if it was.
   void finalizePCM(llvm::StringRef Filename);
 
+  /// Start building modules concurrently with compiler instances on other
+  /// threads that share this cache. Calls may be nested.
+  void beginConcurrentBuilds();
+
+  /// Finish building modules concurrently. Once the outermost concurrent
+  /// builds are done, the buffers dropped in the meantime are freed.
+  void endConcurrentBuilds();
+
   /// Get a pointer to the pCM if it exists; else nullptr.
   llvm::MemoryBuffer *lookupPCM(llvm::StringRef Filename) const;
 
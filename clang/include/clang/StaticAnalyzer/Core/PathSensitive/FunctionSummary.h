@@ -31,6 +31,7 @@ using SetOfDecls = std::deque<Decl *>;
 using SetOfConstDecls = llvm::DenseSet<const Decl *>;
 
 class FunctionSummariesTy {
+public:
   class FunctionSummary {
   public:
     /// Marks the IDs of the basic blocks visited during the analyzes.
@@ -54,11 +55,50 @@ class FunctionSummariesTy {
           TimesInlined(0) {}
   };
 
+  /// How a summary was used while accesses were being recorded.
+  struct SummaryAccess {
+    /// The summary as it was when it was first used.
+    FunctionSummary Before;
+
+    /// True if the number of times the function was inlined was consulted.
+    bool ReadTimesInlined = false;
+  };
+
+  using AccessMapTy = llvm::DenseMap<const Decl *, SummaryAccess>;
+
+private:
   using MapTy = llvm::DenseMap<const Decl *, FunctionSummary>;
   MapTy Map;
 
+  /// If set, each summary that is used is recorded here.
+  AccessMapTy *Accesses = nullptr;
+
+  SummaryAccess *recordAccess(const Decl *D) {
+    if (!Accesses)
+      return nullptr;
+    auto Inserted = Accesses->try_emplace(D);
+    if (Inserted.second) {
+      MapTy::const_iterator I = Map.find(D);
+      if (I != Map.end())
+        Inserted.first->second.Before = I->second;
+    }
+    return &Inserted.first->second;
+  }
+
 public:
+  /// Record in \p A which summaries are used from now on, and what they were
+  /// before, or stop recording if \p A is null.
+  void recordAccesses(AccessMapTy *A) { Accesses = A; }
+
+  /// Returns the summary of \p D, or null if there is none. This is not
+  /// recorded as a use.
+  const FunctionSummary *lookup(const Decl *D) const {
+    MapTy::const_iterator I = Map.find(D);
+    return I != Map.end() ? &I->second : nullptr;
+  }
+
   MapTy::iterator findOrInsertSummary(const Decl *D) {
+    recordAccess(D);
     MapTy::iterator I = Map.find(D);
     if (I != Map.end())
       return I;
@@ -87,6 +127,7 @@ public:
   }
 
   Optional<bool> mayInline(const Decl *D) {
+    recordAccess(D);
     MapTy::const_iterator I = Map.find(D);
     if (I != Map.end() && I->second.InlineChecked)
       return I->second.MayInline;
@@ -112,6 +153,8 @@ public:
   }
 
   unsigned getNumTimesInlined(const Decl* D) {
+    if (SummaryAccess *A = recordAccess(D))
+      A->ReadTimesInlined = true;
     MapTy::const_iterator I = Map.find(D);
     if (I != Map.end())
       return I->second.TimesInlined;
@@ -16,12 +16,15 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include <array>
 #include <mutex>
 
 namespace clang {
 namespace tooling {
 namespace dependencies {
 
+class DependencyScanningPersistentCache;
+
 /// An in-memory representation of a file system entity that is of interest to
 /// the dependency scanning filesystem.
 ///
@@ -46,9 +49,13 @@ public:
   /// mismatching size of the file. If file is not minimized, the full file is
   /// read and copied into memory to ensure that it's not memory mapped to avoid
   /// running out of file descriptors.
-  static CachedFileSystemEntry createFileEntry(StringRef Filename,
-                                               llvm::vfs::FileSystem &FS,
-                                               bool Minimize = true);
+  ///
+  /// If \p PersistentCache is given, minimized contents are looked up in it
+  /// before minimizing the file, and stored in it after.
+  static CachedFileSystemEntry
+  createFileEntry(StringRef Filename, llvm::vfs::FileSystem &FS,
+                  bool Minimize = true,
+                  DependencyScanningPersistentCache *PersistentCache = nullptr);
 
   /// Create an entry that represents a directory on the filesystem.
   static CachedFileSystemEntry createDirectoryEntry(llvm::vfs::Status &&Stat);
@@ -93,6 +100,12 @@ public:
   CachedFileSystemEntry &operator=(const CachedFileSystemEntry &) = delete;
 
 private:
+  /// Create an entry for a file with status \p Stat that was minimized to
+  /// \p Contents, with the excluded conditional blocks in \p Mapping.
+  static CachedFileSystemEntry
+  createMinimizedEntry(const llvm::vfs::Status &Stat, StringRef Contents,
+                       PreprocessorSkippedRangeMapping Mapping);
+
   llvm::ErrorOr<llvm::vfs::Status> MaybeStat;
   // Store the contents in a small string to allow a
   // move from the small string for the minimized contents.
@@ -102,6 +115,73 @@ private:
   PreprocessorSkippedRangeMapping PPSkippedRangeMapping;
 };
 
+/// A cache of minimized file contents on disk, which persists between scans
+/// and can be shared by several scanner processes at once.
+///
+/// Minimized contents are stored under a hash of the original contents, so a
+/// file is only minimized again when its contents change. Separate entries map
+/// the unique ID, size and modification time of a file to the hash of its
+/// contents, so that a file that has not changed since it was cached is not
+/// read at all. This relies on the unique IDs given by the underlying file
+/// system identifying files across processes, as the real one does.
+///
+/// Entries are written to a temporary file that is then renamed into place, so
+/// no process sees a partially written entry, and entries that can't be read
+/// are treated as misses. The directory can be pruned with llvm::pruneCache.
+class DependencyScanningPersistentCache {
+public:
+  using ContentHash = std::array<uint8_t, 20>;
+
+  /// The minimized contents of a file and the ranges of its excluded
+  /// conditional blocks.
+  struct MinimizedFile {
+    llvm::SmallString<1> Contents;
+    PreprocessorSkippedRangeMapping Mapping;
+  };
+
+  /// Create a cache in the directory \p Path, which is created if needed.
+  explicit DependencyScanningPersistentCache(StringRef Path);
+
+  StringRef getPath() const { return Path; }
+
+  /// \returns The hash of \p Contents, used as the key of minimized files.
+  static ContentHash hashContents(StringRef Contents);
+
+  /// \returns The hash of the contents of the file with status \p Stat, if
+  /// one was recorded and the file has not changed since.
+  Optional<ContentHash> getContentHash(const llvm::vfs::Status &Stat) const;
+
+  /// Record \p Hash as the hash of the contents of the file with status
+  /// \p Stat. Files modified too recently to tell apart from a later change
+  /// are not recorded.
+  void setContentHash(const llvm::vfs::Status &Stat,
+                      const ContentHash &Hash) const;
+
+  /// \returns The minimized version of the contents with hash \p Hash, if
+  /// cached.
+  Optional<MinimizedFile> getMinimizedFile(const ContentHash &Hash) const;
+
+  /// Cache \p File as the minimized version of the contents with hash \p Hash.
+  void setMinimizedFile(const ContentHash &Hash,
+                        const MinimizedFile &File) const;
+
+private:
+  /// \returns The key of the entry of kind \p Kind for \p Data. Keys depend
+  /// on the version of the minimizer, so that entries it didn't write are not
+  /// found.
+  ContentHash getKey(StringRef Kind, ArrayRef<uint8_t> Data) const;
+  /// \returns The path of the entry for the key \p Hash.
+  SmallString<256> getEntryPath(const ContentHash &Hash) const;
+  /// \returns The key of the entry that records the contents of the file with
+  /// status \p Stat.
+  ContentHash getStatKey(const llvm::vfs::Status &Stat) const;
+
+  std::string Path;
+  /// Mixed into every key, so that entries made by other versions of the
+  /// minimizer are not used.
+  std::string Version;
+};
+
 /// This class is a shared cache, that caches the 'stat' and 'open' calls to the
 /// underlying real file system.
 ///
@@ -145,9 +225,10 @@ public:
   DependencyScanningWorkerFilesystem(
       DependencyScanningFilesystemSharedCache &SharedCache,
       IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS,
-      ExcludedPreprocessorDirectiveSkipMapping *PPSkipMappings)
+      ExcludedPreprocessorDirectiveSkipMapping *PPSkipMappings,
+      DependencyScanningPersistentCache *PersistentCache = nullptr)
       : ProxyFileSystem(std::move(FS)), SharedCache(SharedCache),
-        PPSkipMappings(PPSkipMappings) {}
+        PPSkipMappings(PPSkipMappings), PersistentCache(PersistentCache) {}
 
   llvm::ErrorOr<llvm::vfs::Status> status(const Twine &Path) override;
   llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
@@ -179,6 +260,8 @@ private:
   /// excluded conditional directive skip mappings that are used by the
   /// currently active preprocessor.
   ExcludedPreprocessorDirectiveSkipMapping *PPSkipMappings;
+  /// The optional on-disk cache of minimized files.
+  DependencyScanningPersistentCache *PersistentCache;
 };
 
 } // end namespace dependencies
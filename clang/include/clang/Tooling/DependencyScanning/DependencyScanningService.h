@@ -48,7 +48,8 @@ class DependencyScanningService {
 public:
   DependencyScanningService(ScanningMode Mode, ScanningOutputFormat Format,
                             bool ReuseFileManager = true,
-                            bool SkipExcludedPPRanges = true);
+                            bool SkipExcludedPPRanges = true,
+                            StringRef PersistentCachePath = {});
 
   ScanningMode getMode() const { return Mode; }
 
@@ -62,6 +63,11 @@ public:
     return SharedCache;
   }
 
+  /// \returns The on-disk cache of minimized files, or null if there is none.
+  DependencyScanningPersistentCache *getPersistentCache() {
+    return PersistentCache.get();
+  }
+
 private:
   const ScanningMode Mode;
   const ScanningOutputFormat Format;
@@ -72,6 +78,8 @@ private:
   const bool SkipExcludedPPRanges;
   /// The global file system cache.
   DependencyScanningFilesystemSharedCache SharedCache;
+  /// The on-disk cache of minimized files that persists between scans.
+  std::unique_ptr<DependencyScanningPersistentCache> PersistentCache;
 };
 
 } // end namespace dependencies
@@ -15,18 +15,28 @@
 #include "clang/Driver/Options.h"
 #include "clang/Driver/ToolChain.h"
 #include "clang/Driver/Util.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptSpecifier.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SimpleTable.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
+#include <set>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -196,34 +206,42 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
   return Success;
 }
 
-int Compilation::ExecuteCommand(const Command &C,
-                                const Command *&FailingCommand) const {
-  if ((getDriver().CCPrintOptions ||
-       getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
-    raw_ostream *OS = &llvm::errs();
-    std::unique_ptr<llvm::raw_fd_ostream> OwnedStream;
-
-    // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
-    // output stream.
-    if (getDriver().CCPrintOptions &&
-        !getDriver().CCPrintOptionsFilename.empty()) {
-      std::error_code EC;
-      OwnedStream.reset(new llvm::raw_fd_ostream(
-          getDriver().CCPrintOptionsFilename.c_str(), EC,
-          llvm::sys::fs::OF_Append | llvm::sys::fs::OF_TextWithCRLF));
-      if (EC) {
-        getDriver().Diag(diag::err_drv_cc_print_options_failure)
-            << EC.message();
-        FailingCommand = &C;
-        return 1;
-      }
-      OS = OwnedStream.get();
+bool Compilation::LogCommand(const Command &C) const {
+  if ((!getDriver().CCPrintOptions && !getArgs().hasArg(options::OPT_v)) ||
+      getDriver().CCGenDiagnostics)
+    return true;
+
+  raw_ostream *OS = &llvm::errs();
+  std::unique_ptr<llvm::raw_fd_ostream> OwnedStream;
+
+  // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
+  // output stream.
+  if (getDriver().CCPrintOptions &&
+      !getDriver().CCPrintOptionsFilename.empty()) {
+    std::error_code EC;
+    OwnedStream.reset(new llvm::raw_fd_ostream(
+        getDriver().CCPrintOptionsFilename.c_str(), EC,
+        llvm::sys::fs::OF_Append | llvm::sys::fs::OF_TextWithCRLF));
+    if (EC) {
+      getDriver().Diag(diag::err_drv_cc_print_options_failure)
+          << EC.message();
+      return false;
     }
+    OS = OwnedStream.get();
+  }
 
-    if (getDriver().CCPrintOptions)
-      *OS << "[Logging clang options]\n";
+  if (getDriver().CCPrintOptions)
+    *OS << "[Logging clang options]\n";
 
-    C.Print(*OS, "\n", /*Quote=*/getDriver().CCPrintOptions);
+  C.Print(*OS, "\n", /*Quote=*/getDriver().CCPrintOptions);
+  return true;
+}
+
+int Compilation::ExecuteCommand(const Command &C,
+                                const Command *&FailingCommand) const {
+  if (!LogCommand(C)) {
+    FailingCommand = &C;
+    return 1;
   }
 
   std::string Error;
@@ -272,8 +290,234 @@ static bool InputsOk(const Command &C,
   return !ActionFailed(&C.getSource(), FailingCommands);
 }
 
+/// Find the jobs that have to wait for each job: those whose action uses the
+/// job's action, directly or through actions that were folded into other
+/// jobs, and those that refer to a file the job writes or write a file the
+/// job refers to. A job refers to a file if one of its arguments is the file
+/// name, or ends in "=" followed by the file name or by a comma separated list
+/// that contains it (e.g. -inputs=a.o,b.o). Jobs only ever wait for jobs that
+/// come before them.
+static std::vector<SmallVector<size_t, 4>>
+getJobUsers(ArrayRef<const Command *> Cmds) {
+  llvm::DenseMap<const Action *, SmallVector<size_t, 1>> JobsForAction;
+  for (size_t I = 0, E = Cmds.size(); I != E; ++I)
+    JobsForAction[&Cmds[I]->getSource()].push_back(I);
+
+  auto NamesFile = [](StringRef Arg, StringRef File) {
+    if (Arg == File)
+      return true;
+    size_t Eq = Arg.find('=');
+    if (Eq == StringRef::npos)
+      return false;
+    SmallVector<StringRef, 4> Values;
+    Arg.drop_front(Eq + 1).split(Values, ',');
+    return llvm::is_contained(Values, File);
+  };
+  auto RefersTo = [&](const Command &C, ArrayRef<std::string> Files) {
+    for (const std::string &File : Files)
+      if (!File.empty() && llvm::any_of(C.getArguments(), [&](const char *A) {
+            return NamesFile(A, File);
+          }))
+        return true;
+    return false;
+  };
+
+  std::vector<SmallVector<size_t, 4>> Users(Cmds.size());
+  for (size_t I = 0, E = Cmds.size(); I != E; ++I) {
+    llvm::BitVector Deps(I);
+    llvm::SmallPtrSet<const Action *, 16> Visited;
+    SmallVector<const Action *, 16> Worklist(1, &Cmds[I]->getSource());
+    while (!Worklist.empty()) {
+      const Action *A = Worklist.pop_back_val();
+      if (!Visited.insert(A).second)
+        continue;
+      auto It = JobsForAction.find(A);
+      if (It != JobsForAction.end())
+        for (size_t J : It->second)
+          if (J < I)
+            Deps.set(J);
+      Worklist.append(A->input_begin(), A->input_end());
+    }
+    for (size_t J = 0; J != I; ++J)
+      if (!Deps.test(J) &&
+          (RefersTo(*Cmds[I], Cmds[J]->getOutputFilenames()) ||
+           RefersTo(*Cmds[J], Cmds[I]->getOutputFilenames())))
+        Deps.set(J);
+    for (unsigned J : Deps.set_bits())
+      Users[J].push_back(I);
+  }
+  return Users;
+}
+
+namespace {
+/// The result of a job run by ExecuteJobsInParallel.
+struct JobOutcome {
+  bool Started = false;
+  /// Whether the command line could not be logged, so the job did not run.
+  bool LogFailed = false;
+  bool ExecutionFailed = false;
+  int Res = 0;
+  std::string Error;
+  /// Where the job's standard output and error were captured, if anywhere.
+  SmallString<128> Outputs[2];
+  /// Why the output could not be captured, if it couldn't.
+  std::error_code CaptureError;
+};
+} // namespace
+
+/// Run \p C with its standard output and error captured in temporary files.
+/// If a file can't be created, that output goes where the driver's goes.
+static void ExecuteCapturedCommand(const Command &C, JobOutcome &Outcome) {
+  Optional<StringRef> Redirects[3];
+  for (unsigned I = 0; I != 2; ++I) {
+    if (std::error_code EC = llvm::sys::fs::createTemporaryFile(
+            "clang-job", "txt", Outcome.Outputs[I])) {
+      Outcome.Outputs[I].clear();
+      Outcome.CaptureError = EC;
+      continue;
+    }
+    Redirects[I + 1] = StringRef(Outcome.Outputs[I]);
+  }
+  Outcome.Res = C.Execute(Redirects, &Outcome.Error, &Outcome.ExecutionFailed);
+}
+
+/// Copy the captured output of a job to \p OS and remove the file holding it.
+static void ReplayCapturedOutput(StringRef Path, raw_ostream &OS) {
+  if (Path.empty())
+    return;
+  if (auto Buffer = llvm::MemoryBuffer::getFile(Path))
+    OS << (*Buffer)->getBuffer();
+  OS.flush();
+  llvm::sys::fs::remove(Path);
+}
+
+void Compilation::ExecuteJobsInParallel(
+    const JobList &Jobs, FailingCommandList &FailingCommands) const {
+  SmallVector<const Command *, 16> Cmds;
+  for (const Command &Job : Jobs)
+    Cmds.push_back(&Job);
+  size_t NumJobs = Cmds.size();
+
+  std::vector<SmallVector<size_t, 4>> Users = getJobUsers(Cmds);
+  std::vector<unsigned> PendingDeps(NumJobs);
+  for (const auto &JobUsers : Users)
+    for (size_t U : JobUsers)
+      ++PendingDeps[U];
+
+  std::vector<JobOutcome> Outcomes(NumJobs);
+  std::mutex Mutex;
+  std::condition_variable Changed;
+  // Prefer starting the earliest ready job, so that the order in which jobs
+  // start follows the job list as closely as possible.
+  std::set<size_t> Ready;
+  for (size_t I = 0; I != NumJobs; ++I)
+    if (!PendingDeps[I])
+      Ready.insert(I);
+  SmallVector<size_t, 4> Failed;
+  size_t NumFinished = 0;
+  unsigned NumRunning = 0;
+  bool Stop = false;
+
+  // Must be called with Mutex held.
+  auto Finish = [&](size_t I) {
+    ++NumFinished;
+    for (size_t U : Users[I])
+      if (!--PendingDeps[U])
+        Ready.insert(U);
+  };
+
+  llvm::ThreadPool Pool(llvm::hardware_concurrency(ParallelJobs));
+  std::unique_lock<std::mutex> Lock(Mutex);
+  while (NumFinished != NumJobs) {
+    while (!Ready.empty() && NumRunning < ParallelJobs) {
+      size_t I = *Ready.begin();
+      Ready.erase(Ready.begin());
+
+      // Skip the job if an earlier job it needs has failed, as the sequential
+      // execution would.
+      SmallVector<std::pair<int, const Command *>, 4> EarlierFailures;
+      for (size_t J : Failed)
+        if (J < I)
+          EarlierFailures.push_back(std::make_pair(Outcomes[J].Res, Cmds[J]));
+      if (Stop || !InputsOk(*Cmds[I], EarlierFailures)) {
+        Finish(I);
+        continue;
+      }
+
+      // Print the command line for -v before the job starts, as the
+      // sequential execution does.
+      Outcomes[I].Started = true;
+      if (!LogCommand(*Cmds[I])) {
+        Outcomes[I].LogFailed = true;
+        Failed.push_back(I);
+        Stop |= TheDriver.IsCLMode();
+        Finish(I);
+        continue;
+      }
+      ++NumRunning;
+      Pool.async([&, I] {
+        ExecuteCapturedCommand(*Cmds[I], Outcomes[I]);
+        std::lock_guard<std::mutex> Guard(Mutex);
+        --NumRunning;
+        if (Outcomes[I].Res || Outcomes[I].ExecutionFailed) {
+          Failed.push_back(I);
+          // Don't start any more jobs in cl driver mode.
+          Stop |= TheDriver.IsCLMode();
+        }
+        Finish(I);
+        Changed.notify_one();
+      });
+    }
+    Changed.wait(Lock, [&] {
+      return NumFinished == NumJobs ||
+             (!Ready.empty() && NumRunning < ParallelJobs);
+    });
+  }
+  Lock.unlock();
+  Pool.wait();
+
+  // Report the jobs in order, dropping the results of jobs that the sequential
+  // execution would not have run.
+  for (size_t I = 0; I != NumJobs; ++I) {
+    const Command &C = *Cmds[I];
+    JobOutcome &Outcome = Outcomes[I];
+    bool Report = Outcome.Started && InputsOk(C, FailingCommands) &&
+                  !(TheDriver.IsCLMode() && !FailingCommands.empty());
+    if (Report && Outcome.LogFailed) {
+      FailingCommands.push_back(std::make_pair(1, &C));
+      continue;
+    }
+    if (Outcome.CaptureError)
+      getDriver().Diag(diag::warn_drv_job_output_not_captured)
+          << C.getExecutable() << Outcome.CaptureError.message();
+    ReplayCapturedOutput(Outcome.Outputs[0],
+                         Report ? llvm::outs() : llvm::nulls());
+    ReplayCapturedOutput(Outcome.Outputs[1],
+                         Report ? llvm::errs() : llvm::nulls());
+    if (!Report)
+      continue;
+
+    if (PostCallback)
+      PostCallback(C, Outcome.Res);
+    if (!Outcome.Error.empty())
+      getDriver().Diag(diag::err_drv_command_failure) << Outcome.Error;
+    if (int Res = Outcome.ExecutionFailed ? 1 : Outcome.Res)
+      FailingCommands.push_back(std::make_pair(Res, &C));
+  }
+}
+
 void Compilation::ExecuteJobs(const JobList &Jobs,
                               FailingCommandList &FailingCommands) const {
+  // Offloading compilations may run their independent jobs at the same time.
+  // Jobs that run in this process can't, and neither can jobs whose output
+  // is already redirected.
+  if (ParallelJobs > 1 && Jobs.size() > 1 && ActiveOffloadMask &&
+      !ForDiagnostics && Redirects.empty() && llvm::llvm_is_multithreaded() &&
+      llvm::none_of(Jobs, [](const Command &Job) {
+        return Job.InProcess || Job.PrintInputFilenames;
+      }))
+    return ExecuteJobsInParallel(Jobs, FailingCommands);
+
   // According to UNIX standard, driver need to continue compiling all the
   // inputs on the command line even one of them failed.
   // In all but CLMode, execute all the jobs unless the necessary inputs for the
@@ -5652,6 +5652,15 @@ void Driver::BuildJobs(Compilation &C) const {
     for (auto &J : C.getJobs())
       J.InProcess = false;
 
+  if (Arg *A = C.getArgs().getLastArg(options::OPT_fparallel_offload_jobs_EQ)) {
+    unsigned NumJobs;
+    if (StringRef(A->getValue()).getAsInteger(10, NumJobs) || !NumJobs)
+      Diag(diag::err_drv_invalid_int_value)
+          << A->getAsString(C.getArgs()) << A->getValue();
+    else
+      C.setParallelJobs(NumJobs);
+  }
+
   if (CCPrintProcessStats) {
     C.setPostCallback([=](const Command &Cmd, int Res) {
       Optional<llvm::sys::ProcessStatistics> ProcStat =
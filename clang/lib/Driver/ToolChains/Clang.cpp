@@ -3553,6 +3553,7 @@ static void RenderModulesOptions(Compilation &C, const Driver &D,
   Args.AddAllArgs(CmdArgs, options::OPT_fmodules_ignore_macro);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_prune_interval);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_prune_after);
+  Args.AddLastArg(CmdArgs, options::OPT_fmodules_build_jobs_EQ);
 
   Args.AddLastArg(CmdArgs, options::OPT_fbuild_session_timestamp);
 
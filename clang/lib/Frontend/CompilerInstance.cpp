@@ -36,6 +36,7 @@
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
 #include "clang/Serialization/InMemoryModuleCache.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/BuryPointer.h"
 #include "llvm/Support/CrashRecoveryContext.h"
@@ -47,9 +48,11 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <mutex>
 #include <time.h>
 #include <utility>
 
@@ -970,7 +973,8 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
   // Notify the diagnostic client that all files were processed.
   getDiagnostics().getClient()->finish();
 
-  if (getDiagnosticOpts().ShowCarets) {
+  if (getDiagnosticOpts().ShowCarets &&
+      getDiagnosticOpts().ShowDiagnosticCounts) {
     // We can have multiple diagnostics sharing one diagnostic client.
     // Get the total number of warnings/errors from the client.
     unsigned NumWarnings = getDiagnostics().getClient()->getNumWarnings();
@@ -1030,9 +1034,39 @@ static Language getLanguageFromOptions(const LangOptions &LangOpts) {
   return LangOpts.CPlusPlus ? Language::CXX : Language::C;
 }
 
+namespace {
+/// Forwards diagnostics to a consumer that is shared by modules being built
+/// concurrently.
+class LockingForwardingDiagnosticConsumer
+    : public ForwardingDiagnosticConsumer {
+  std::mutex &Lock;
+
+public:
+  LockingForwardingDiagnosticConsumer(DiagnosticConsumer &Target,
+                                      std::mutex &Lock)
+      : ForwardingDiagnosticConsumer(Target), Lock(Lock) {}
+
+  void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
+                        const Diagnostic &Info) override {
+    std::lock_guard<std::mutex> Guard(Lock);
+    ForwardingDiagnosticConsumer::HandleDiagnostic(DiagLevel, Info);
+  }
+
+  void clear() override {
+    std::lock_guard<std::mutex> Guard(Lock);
+    ForwardingDiagnosticConsumer::clear();
+  }
+};
+} // end anonymous namespace
+
 /// Compile a module file for the given module, using the options
 /// provided by the importing compiler instance. Returns true if the module
 /// was built without errors.
+///
+/// If \p ConcurrentDiagsLock is given, the module is built on a separate
+/// thread while the importing instance waits for it, concurrently with other
+/// modules: it gets its own file manager, its diagnostics are forwarded under
+/// the lock, and the importing instance's diagnostics aren't touched.
 static bool
 compileModuleImpl(CompilerInstance &ImportingInstance, SourceLocation ImportLoc,
                   StringRef ModuleName, FrontendInputFile Input,
@@ -1040,7 +1074,8 @@ compileModuleImpl(CompilerInstance &ImportingInstance, SourceLocation ImportLoc,
                   llvm::function_ref<void(CompilerInstance &)> PreBuildStep =
                       [](CompilerInstance &) {},
                   llvm::function_ref<void(CompilerInstance &)> PostBuildStep =
-                      [](CompilerInstance &) {}) {
+                      [](CompilerInstance &) {},
+                  std::mutex *ConcurrentDiagsLock = nullptr) {
   llvm::TimeTraceScope TimeScope("Module Compile", ModuleName);
 
   // Construct a compiler invocation for creating this module.
@@ -1094,6 +1129,10 @@ compileModuleImpl(CompilerInstance &ImportingInstance, SourceLocation ImportLoc,
   FrontendOpts.OriginalModuleMap = std::string(OriginalModuleMapFile);
   // Force implicitly-built modules to hash the content of the module file.
   HSOpts.ModulesHashContent = true;
+  // Modules built concurrently build their own dependencies one at a time, so
+  // that the number of threads stays bounded.
+  if (ConcurrentDiagsLock)
+    HSOpts.ModuleBuildJobs = 1;
   FrontendOpts.Inputs = {Input};
 
   // Don't free the remapped file buffers; they are owned by our caller.
@@ -1112,13 +1151,23 @@ compileModuleImpl(CompilerInstance &ImportingInstance, SourceLocation ImportLoc,
   auto &Inv = *Invocation;
   Instance.setInvocation(std::move(Invocation));
 
-  Instance.createDiagnostics(new ForwardingDiagnosticConsumer(
+  if (ConcurrentDiagsLock)
+    Instance.createDiagnostics(
+        new LockingForwardingDiagnosticConsumer(
+            ImportingInstance.getDiagnosticClient(), *ConcurrentDiagsLock),
+        /*ShouldOwnClient=*/true);
+  else
+    Instance.createDiagnostics(new ForwardingDiagnosticConsumer(
                                    ImportingInstance.getDiagnosticClient()),
-                             /*ShouldOwnClient=*/true);
+                               /*ShouldOwnClient=*/true);
 
   // Note that this module is part of the module build stack, so that we
   // can detect cycles in the module graph.
-  Instance.setFileManager(&ImportingInstance.getFileManager());
+  if (ConcurrentDiagsLock)
+    Instance.createFileManager(
+        &ImportingInstance.getFileManager().getVirtualFileSystem());
+  else
+    Instance.setFileManager(&ImportingInstance.getFileManager());
   Instance.createSourceManager(Instance.getFileManager());
   SourceManager &SourceMgr = Instance.getSourceManager();
   SourceMgr.setModuleBuildStack(
@@ -1132,9 +1181,10 @@ compileModuleImpl(CompilerInstance &ImportingInstance, SourceLocation ImportLoc,
   Instance.setModuleDepCollector(ImportingInstance.getModuleDepCollector());
   Inv.getDependencyOutputOpts() = DependencyOutputOptions();
 
-  ImportingInstance.getDiagnostics().Report(ImportLoc,
-                                            diag::remark_module_build)
-    << ModuleName << ModuleFileName;
+  if (!ConcurrentDiagsLock)
+    ImportingInstance.getDiagnostics().Report(ImportLoc,
+                                              diag::remark_module_build)
+        << ModuleName << ModuleFileName;
 
   PreBuildStep(Instance);
 
@@ -1150,9 +1200,10 @@ compileModuleImpl(CompilerInstance &ImportingInstance, SourceLocation ImportLoc,
 
   PostBuildStep(Instance);
 
-  ImportingInstance.getDiagnostics().Report(ImportLoc,
-                                            diag::remark_module_build_done)
-    << ModuleName;
+  if (!ConcurrentDiagsLock)
+    ImportingInstance.getDiagnostics().Report(ImportLoc,
+                                              diag::remark_module_build_done)
+        << ModuleName;
 
   // Delete any remaining temporary files related to Instance, in case the
   // module generation thread crashed.
@@ -1179,19 +1230,35 @@ static const FileEntry *getPublicModuleMap(const FileEntry *File,
   return nullptr;
 }
 
-/// Compile a module file for the given module in a separate compiler instance,
-/// using the options provided by the importing compiler instance. Returns true
-/// if the module was built without errors.
-static bool compileModule(CompilerInstance &ImportingInstance,
-                          SourceLocation ImportLoc, Module *Module,
-                          StringRef ModuleFileName) {
-  InputKind IK(getLanguageFromOptions(ImportingInstance.getLangOpts()),
-               InputKind::ModuleMap);
+namespace {
+/// What's needed to build the module file of a module in a separate compiler
+/// instance, without looking at the importing instance's module map.
+struct ModuleBuildInput {
+  std::string ModuleName;
+  /// The module map to build the module from.
+  std::string ModuleMapFile;
+  bool IsSystem;
+  std::string OriginalModuleMapFile;
+  std::string ModuleFileName;
+  /// The contents of \c ModuleMapFile, if the module doesn't have a module
+  /// map and one is inferred for it.
+  std::string InferredModuleMap;
+};
+} // end anonymous namespace
 
+/// Determine how to build \p Module into \p ModuleFileName.
+static ModuleBuildInput getModuleBuildInput(CompilerInstance &ImportingInstance,
+                                            Module *Module,
+                                            StringRef ModuleFileName) {
   // Get or create the module map that we'll use to build this module.
   ModuleMap &ModMap
     = ImportingInstance.getPreprocessor().getHeaderSearchInfo().getModuleMap();
-  bool Result;
+  ModuleBuildInput BuildInput;
+  BuildInput.ModuleName = Module->getTopLevelModuleName().str();
+  BuildInput.IsSystem = Module->IsSystem;
+  BuildInput.OriginalModuleMapFile =
+      ModMap.getModuleMapFileForUniquing(Module)->getName().str();
+  BuildInput.ModuleFileName = ModuleFileName.str();
   if (const FileEntry *ModuleMapFile =
           ModMap.getContainingModuleMapFile(Module)) {
     // Canonicalize compilation to start with the public module map. This is
@@ -1202,11 +1269,7 @@ static bool compileModule(CompilerInstance &ImportingInstance,
       ModuleMapFile = PublicMMFile;
 
     // Use the module map where this module resides.
-    Result = compileModuleImpl(
-        ImportingInstance, ImportLoc, Module->getTopLevelModuleName(),
-        FrontendInputFile(ModuleMapFile->getName(), IK, +Module->IsSystem),
-        ModMap.getModuleMapFileForUniquing(Module)->getName(),
-        ModuleFileName);
+    BuildInput.ModuleMapFile = ModuleMapFile->getName().str();
   } else {
     // FIXME: We only need to fake up an input file here as a way of
     // transporting the module's directory to the module map parser. We should
@@ -1214,26 +1277,58 @@ static bool compileModule(CompilerInstance &ImportingInstance,
     // inventing this file.
     SmallString<128> FakeModuleMapFile(Module->Directory->getName());
     llvm::sys::path::append(FakeModuleMapFile, "__inferred_module.map");
+    BuildInput.ModuleMapFile = FakeModuleMapFile.str().str();
 
-    std::string InferredModuleMapContent;
-    llvm::raw_string_ostream OS(InferredModuleMapContent);
+    llvm::raw_string_ostream OS(BuildInput.InferredModuleMap);
     Module->print(OS);
     OS.flush();
-
-    Result = compileModuleImpl(
-        ImportingInstance, ImportLoc, Module->getTopLevelModuleName(),
-        FrontendInputFile(FakeModuleMapFile, IK, +Module->IsSystem),
-        ModMap.getModuleMapFileForUniquing(Module)->getName(),
-        ModuleFileName,
-        [&](CompilerInstance &Instance) {
-      std::unique_ptr<llvm::MemoryBuffer> ModuleMapBuffer =
-          llvm::MemoryBuffer::getMemBuffer(InferredModuleMapContent);
-      ModuleMapFile = Instance.getFileManager().getVirtualFile(
-          FakeModuleMapFile, InferredModuleMapContent.size(), 0);
-      Instance.getSourceManager().overrideFileContents(
-          ModuleMapFile, std::move(ModuleMapBuffer));
-    });
   }
+  return BuildInput;
+}
+
+/// Compile a module file as described by \p BuildInput in a separate compiler
+/// instance, using the options provided by the importing compiler instance.
+/// Returns true if the module was built without errors.
+static bool compileModule(CompilerInstance &ImportingInstance,
+                          SourceLocation ImportLoc,
+                          const ModuleBuildInput &BuildInput,
+                          std::mutex *ConcurrentDiagsLock = nullptr) {
+  InputKind IK(getLanguageFromOptions(ImportingInstance.getLangOpts()),
+               InputKind::ModuleMap);
+  FrontendInputFile Input(BuildInput.ModuleMapFile, IK, BuildInput.IsSystem);
+
+  if (BuildInput.InferredModuleMap.empty())
+    return compileModuleImpl(
+        ImportingInstance, ImportLoc, BuildInput.ModuleName, Input,
+        BuildInput.OriginalModuleMapFile, BuildInput.ModuleFileName,
+        [](CompilerInstance &) {}, [](CompilerInstance &) {},
+        ConcurrentDiagsLock);
+
+  return compileModuleImpl(
+      ImportingInstance, ImportLoc, BuildInput.ModuleName, Input,
+      BuildInput.OriginalModuleMapFile, BuildInput.ModuleFileName,
+      [&](CompilerInstance &Instance) {
+        std::unique_ptr<llvm::MemoryBuffer> ModuleMapBuffer =
+            llvm::MemoryBuffer::getMemBuffer(BuildInput.InferredModuleMap);
+        const FileEntry *ModuleMapFile =
+            Instance.getFileManager().getVirtualFile(
+                BuildInput.ModuleMapFile, BuildInput.InferredModuleMap.size(),
+                0);
+        Instance.getSourceManager().overrideFileContents(
+            ModuleMapFile, std::move(ModuleMapBuffer));
+      },
+      [](CompilerInstance &) {}, ConcurrentDiagsLock);
+}
+
+/// Compile a module file for the given module in a separate compiler instance,
+/// using the options provided by the importing compiler instance. Returns true
+/// if the module was built without errors.
+static bool compileModule(CompilerInstance &ImportingInstance,
+                          SourceLocation ImportLoc, Module *Module,
+                          StringRef ModuleFileName) {
+  bool Result = compileModule(
+      ImportingInstance, ImportLoc,
+      getModuleBuildInput(ImportingInstance, Module, ModuleFileName));
 
   // We've rebuilt a module. If we're allowed to generate or update the global
   // module index, record that fact in the importing compiler instance.
@@ -1666,6 +1761,131 @@ static ModuleSource selectModuleSource(
   return MS_ModuleNotFound;
 }
 
+/// Build the modules that \p M uses or exports according to its module map
+/// and that are missing from the module cache, up to \p Jobs at a time.
+/// Building \p M then only needs to load them, instead of building them one
+/// after the other.
+static void prebuildModuleDependencies(
+    CompilerInstance &ImportingInstance, SourceLocation ImportLoc, Module *M,
+    const std::map<std::string, std::string, std::less<>> &BuiltModules,
+    unsigned Jobs) {
+  HeaderSearch &HS = ImportingInstance.getPreprocessor().getHeaderSearchInfo();
+  ModuleMap &ModMap = HS.getModuleMap();
+  Module *TopM = M->getTopLevelModule();
+
+  // Collect the top-level modules named by the 'use' and 'export'
+  // declarations of the module and its submodules. Only the first component of
+  // a name matters, so there's no need to resolve them.
+  llvm::SetVector<Module *> Deps;
+  auto AddDep = [&](Module *Sub, StringRef Name) {
+    if (ModMap.lookupModuleQualified(Name, Sub))
+      return; // A submodule.
+    if (Module *Dep = HS.lookupModule(Name))
+      Deps.insert(Dep->getTopLevelModule());
+  };
+  SmallVector<Module *, 16> Worklist{TopM};
+  while (!Worklist.empty()) {
+    Module *Sub = Worklist.pop_back_val();
+    for (Module *Use : Sub->DirectUses)
+      Deps.insert(Use->getTopLevelModule());
+    for (const ModuleId &Use : Sub->UnresolvedDirectUses)
+      AddDep(Sub, Use.front().first);
+    for (const Module::ExportDecl &Export : Sub->Exports)
+      if (Module *Exported = Export.getPointer())
+        Deps.insert(Exported->getTopLevelModule());
+    for (const Module::UnresolvedExportDecl &Export : Sub->UnresolvedExports)
+      if (!Export.Id.empty())
+        AddDep(Sub, Export.Id.front().first);
+    Worklist.append(Sub->submodule_begin(), Sub->submodule_end());
+  }
+
+  // Only build the modules that are missing: stale ones are rebuilt as usual
+  // when they're imported, and that has to be serialized with reading them.
+  InMemoryModuleCache &ModuleCache = ImportingInstance.getModuleCache();
+  PreprocessorOptions &PPOpts = ImportingInstance.getPreprocessorOpts();
+  ModuleBuildStack BuildStack =
+      ImportingInstance.getSourceManager().getModuleBuildStack();
+  std::vector<ModuleBuildInput> BuildInputs;
+  auto IsBeingBuilt = [&](Module *Dep) {
+    return llvm::any_of(BuildStack, [&](const auto &Entry) {
+      return Entry.first == Dep->Name;
+    });
+  };
+  for (Module *Dep : Deps) {
+    if (Dep == TopM || Dep->getASTFile() || !Dep->isAvailable() ||
+        IsBeingBuilt(Dep))
+      continue;
+    if (PPOpts.FailedModules &&
+        PPOpts.FailedModules->hasAlreadyFailed(Dep->Name))
+      continue;
+    std::string ModuleFileName;
+    if (selectModuleSource(Dep, Dep->Name, ModuleFileName, BuiltModules, HS) !=
+            MS_ModuleCache ||
+        ModuleFileName.empty() ||
+        ModuleCache.getPCMState(ModuleFileName) !=
+            InMemoryModuleCache::Unknown ||
+        llvm::sys::fs::exists(ModuleFileName))
+      continue;
+    BuildInputs.push_back(
+        getModuleBuildInput(ImportingInstance, Dep, ModuleFileName));
+  }
+  // A single module gains nothing from being built early.
+  if (BuildInputs.size() < 2)
+    return;
+
+  // The builds share the failed modules and report into them.
+  if (!PPOpts.FailedModules)
+    PPOpts.FailedModules =
+        std::make_shared<PreprocessorOptions::FailedModulesSet>();
+
+  DiagnosticsEngine &Diags = ImportingInstance.getDiagnostics();
+  for (const ModuleBuildInput &BuildInput : BuildInputs) {
+    llvm::sys::fs::create_directories(
+        llvm::sys::path::parent_path(BuildInput.ModuleFileName));
+    Diags.Report(ImportLoc, diag::remark_module_build)
+        << BuildInput.ModuleName << BuildInput.ModuleFileName;
+  }
+
+  enum BuildResult : char { NotBuilt, Built, Failed };
+  std::vector<BuildResult> Results(BuildInputs.size(), NotBuilt);
+  std::mutex DiagsLock;
+  ModuleCache.beginConcurrentBuilds();
+  llvm::ThreadPool Pool(llvm::hardware_concurrency(Jobs));
+  for (size_t I = 0, E = BuildInputs.size(); I != E; ++I) {
+    Pool.async([&, I] {
+      const ModuleBuildInput &BuildInput = BuildInputs[I];
+      // Leave the module to whoever else is building it; it's waited for as
+      // usual when it's imported.
+      llvm::LockFileManager Locked(BuildInput.ModuleFileName);
+      if (Locked != llvm::LockFileManager::LFS_Owned)
+        return;
+      Results[I] = compileModule(ImportingInstance, ImportLoc, BuildInput,
+                                 &DiagsLock)
+                       ? Built
+                       : Failed;
+    });
+  }
+  Pool.wait();
+  ModuleCache.endConcurrentBuilds();
+
+  for (size_t I = 0, E = BuildInputs.size(); I != E; ++I) {
+    StringRef ModuleName = BuildInputs[I].ModuleName;
+    if (Results[I] == Failed) {
+      Diags.Report(ImportLoc, diag::err_module_not_built) << ModuleName;
+      PPOpts.FailedModules->addFailed(ModuleName);
+      continue;
+    }
+    if (Results[I] == Built)
+      Diags.Report(ImportLoc, diag::remark_module_build_done) << ModuleName;
+  }
+
+  // We've built modules. If we're allowed to generate or update the global
+  // module index, record that fact in the importing compiler instance.
+  if (llvm::is_contained(Results, Built) &&
+      ImportingInstance.getFrontendOpts().GenerateGlobalModuleIndex)
+    ImportingInstance.setBuildGlobalModuleIndex(true);
+}
+
 ModuleLoadResult CompilerInstance::findOrCompileModuleAndReadAST(
     StringRef ModuleName, SourceLocation ImportLoc,
     SourceLocation ModuleNameLoc, bool IsInclusionDirective) {
@@ -1822,6 +2042,12 @@ ModuleLoadResult CompilerInstance::findOrCompileModuleAndReadAST(
     return ModuleLoadResult::OtherUncachedFailure;
   }
 
+  // Build the modules it depends on concurrently, if allowed. Builds sharing a
+  // module dependency collector must stay serialized.
+  if (getHeaderSearchOpts().ModuleBuildJobs > 1 && !getModuleDepCollector())
+    prebuildModuleDependencies(*this, ImportLoc, M, BuiltModules,
+                               getHeaderSearchOpts().ModuleBuildJobs);
+
   // Try to compile and then read the AST.
   if (!compileModuleAndReadAST(*this, ImportLoc, ModuleNameLoc, M,
                                ModuleFilename)) {
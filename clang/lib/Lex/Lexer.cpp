@@ -126,6 +126,8 @@ void Lexer::InitLexer(const char *BufStart, const char *BufPtr,
   ExtendedTokenMode = 0;
 
   NewLinePtr = nullptr;
+
+  UnskippableStart = UnskippableEnd = BufferStart;
 }
 
 /// Lexer constructor - Create a new lexer object for the specified buffer
@@ -2675,6 +2677,176 @@ bool Lexer::SkipBlockComment(Token &Result, const char *CurPtr,
   return false;
 }
 
+/// Return a pointer to the first of the characters \p Chars in the buffer
+/// starting at \p CurPtr, or \p BufferEnd if there is none.
+template <char... Chars>
+static const char *findFirstOf(const char *CurPtr, const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Bytes = _mm_loadu_si128((const __m128i *)CurPtr);
+    __m128i Matches = _mm_setzero_si128();
+    for (char C : {Chars...})
+      Matches = _mm_or_si128(Matches, _mm_cmpeq_epi8(Bytes, _mm_set1_epi8(C)));
+    if (int Mask = _mm_movemask_epi8(Matches))
+      return CurPtr + llvm::countTrailingZeros<unsigned>(Mask);
+    CurPtr += 16;
+  }
+#endif
+  for (; CurPtr != BufferEnd; ++CurPtr)
+    for (char C : {Chars...})
+      if (*CurPtr == C)
+        return CurPtr;
+  return BufferEnd;
+}
+
+/// If \p CurPtr points to a backslash that starts an escaped newline, return a
+/// pointer past the newline, otherwise return null.
+static const char *skipEscapedNewLine(const char *CurPtr) {
+  assert(*CurPtr == '\\');
+  ++CurPtr;
+  while (isHorizontalWhitespace(*CurPtr))
+    ++CurPtr;
+  if (*CurPtr != '\n' && *CurPtr != '\r')
+    return nullptr;
+  // Consume a \r\n or \n\r pair as one newline.
+  if ((CurPtr[1] == '\n' || CurPtr[1] == '\r') && CurPtr[0] != CurPtr[1])
+    ++CurPtr;
+  return CurPtr + 1;
+}
+
+void Lexer::skipExcludedLines() {
+  assert(LexingRawMode && !ParsingPreprocessorDirective &&
+         "Can only skip excluded lines in raw mode");
+  // Trigraphs can spell a '#' or a backslash, and a code-completion point may
+  // be anywhere; leave those to the full lexer.
+  if (LangOpts.Trigraphs || (PP && PP->getCodeCompletionFileLoc() == FileLoc))
+    return;
+  // The lexer is still working through text that an earlier call stopped in
+  // front of, such as the tokens before a string literal.  Scanning it again
+  // for every token would make long lines quadratic.
+  if (BufferPtr >= UnskippableStart && BufferPtr < UnskippableEnd)
+    return;
+  bool LineComments =
+      LangOpts.LineComment && (LangOpts.CPlusPlus || !LangOpts.TraditionalCPP);
+
+  // Only whitespace and comments can be skipped without lexing the tokens
+  // around them, so keep track of the last point known to be between two
+  // tokens, and resume lexing from there on anything that needs the lexer.
+  const char *CurPtr = BufferPtr;
+  const char *TokStart = CurPtr;
+  bool TokAtStartOfLine = IsAtStartOfLine;
+  bool AtStartOfLine = IsAtStartOfLine;
+  while (true) {
+    if (AtStartOfLine) {
+      while (isHorizontalWhitespace(*CurPtr) ||
+             (*CurPtr == 0 && CurPtr != BufferEnd))
+        ++CurPtr;
+      TokStart = CurPtr;
+      TokAtStartOfLine = true;
+      // This may be a directive, possibly with a '%:' split by an escaped
+      // newline.
+      if (*CurPtr == '#' || (LangOpts.Digraphs && CurPtr[0] == '%' &&
+                             (CurPtr[1] == ':' || CurPtr[1] == '\\')))
+        break;
+    } else {
+      CurPtr = findFirstOf<'\n', '\r', '"', '\'', '/', '\\'>(CurPtr, BufferEnd);
+    }
+
+    if (CurPtr == BufferEnd) {
+      TokStart = CurPtr;
+      TokAtStartOfLine = AtStartOfLine;
+      break;
+    }
+
+    switch (*CurPtr) {
+    case '\n':
+    case '\r':
+      AtStartOfLine = true;
+      ++CurPtr;
+      continue;
+
+    case '\\':
+      // An escaped newline joins two lines.  At the start of a line it may be
+      // part of the next token, so leave it, and anything else, to the lexer.
+      if (!AtStartOfLine)
+        if (const char *NextLine = skipEscapedNewLine(CurPtr)) {
+          CurPtr = NextLine;
+          continue;
+        }
+      break;
+
+    case '"':
+    case '\'':
+      // Literals need the lexer, to tell character literals from digit
+      // separators and to find the end of raw string literals.
+      break;
+
+    case '/':
+      if (CurPtr[1] == '/') {
+        if (!LineComments)
+          break;
+        // Skip to the first newline that is not escaped.
+        const char *Comment = CurPtr;
+        while (true) {
+          CurPtr = findFirstOf<'\n', '\r'>(CurPtr, BufferEnd);
+          if (CurPtr == BufferEnd)
+            break;
+          const char *BeforeNewLine = CurPtr - 1;
+          while (BeforeNewLine != Comment &&
+                 isHorizontalWhitespace(*BeforeNewLine))
+            --BeforeNewLine;
+          if (*BeforeNewLine != '\\')
+            break;
+          CurPtr = skipEscapedNewLine(BeforeNewLine);
+        }
+        TokStart = CurPtr;
+        TokAtStartOfLine = AtStartOfLine;
+        continue;
+      }
+      if (CurPtr[1] == '*') {
+        // Skip to the "*/", leaving an escaped newline between the '*' and
+        // the '/' to the lexer.  A '/' right after the "/*" never ends it.
+        const char *Body = CurPtr + 2;
+        CurPtr = Body == BufferEnd ? Body : Body + 1;
+        while (true) {
+          CurPtr = findFirstOf<'/'>(CurPtr, BufferEnd);
+          if (CurPtr == BufferEnd || CurPtr[-1] == '*')
+            break;
+          if (isVerticalWhitespace(CurPtr[-1])) {
+            const char *BeforeNewLine = CurPtr - 1;
+            while (BeforeNewLine != Body && isWhitespace(*BeforeNewLine))
+              --BeforeNewLine;
+            if (*BeforeNewLine == '\\')
+              break;
+          }
+          ++CurPtr;
+        }
+        if (CurPtr == BufferEnd || CurPtr[-1] != '*')
+          break;
+        TokStart = ++CurPtr;
+        TokAtStartOfLine = AtStartOfLine;
+        continue;
+      }
+      // This may be a comment with an escaped newline after the '/'.
+      if (CurPtr[1] == '\\')
+        break;
+      LLVM_FALLTHROUGH;
+    default:
+      AtStartOfLine = false;
+      ++CurPtr;
+      continue;
+    }
+    break;
+  }
+
+  UnskippableStart = TokStart;
+  UnskippableEnd = CurPtr;
+  if (TokStart == BufferPtr)
+    return;
+  BufferPtr = TokStart;
+  IsAtStartOfLine = IsAtPhysicalStartOfLine = TokAtStartOfLine;
+}
+
 //===----------------------------------------------------------------------===//
 // Primary Lexing Entry Points
 //===----------------------------------------------------------------------===//
@@ -42,6 +42,7 @@
 #include "llvm/Support/AlignOf.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/TimeProfiler.h"
 #include <algorithm>
 #include <cassert>
 #include <cstring>
@@ -418,6 +419,7 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation HashTokenLoc,
                                                 bool FoundNonSkipPortion,
                                                 bool FoundElse,
                                                 SourceLocation ElseLoc) {
+  llvm::TimeTraceScope TimeScope("SkipExcludedConditionalBlock");
   ++NumSkipped;
   assert(!CurTokenLexer && CurPPLexer && "Lexing a macro, not a file?");
 
@@ -438,6 +440,9 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation HashTokenLoc,
   }
   SourceLocation endLoc;
   while (true) {
+    // Get to the next line that may hold a directive without lexing the lines
+    // in between.
+    CurLexer->skipExcludedLines();
     CurLexer->Lex(Tok);
 
     if (Tok.is(tok::code_completion)) {
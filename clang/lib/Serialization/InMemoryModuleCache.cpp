@@ -13,6 +13,7 @@ using namespace clang;
 
 InMemoryModuleCache::State
 InMemoryModuleCache::getPCMState(llvm::StringRef Filename) const {
+  std::lock_guard<std::mutex> Guard(Lock);
   auto I = PCMs.find(Filename);
   if (I == PCMs.end())
     return Unknown;
@@ -24,15 +25,39 @@ InMemoryModuleCache::getPCMState(llvm::StringRef Filename) const {
 llvm::MemoryBuffer &
 InMemoryModuleCache::addPCM(llvm::StringRef Filename,
                             std::unique_ptr<llvm::MemoryBuffer> Buffer) {
-  auto Insertion = PCMs.insert(std::make_pair(Filename, std::move(Buffer)));
-  assert(Insertion.second && "Already has a PCM");
-  return *Insertion.first->second.Buffer;
+  std::lock_guard<std::mutex> Guard(Lock);
+  auto Insertion = PCMs.try_emplace(Filename);
+  auto &PCM = Insertion.first->second;
+  if (Insertion.second) {
+    PCM.Buffer = std::move(Buffer);
+    return *PCM.Buffer;
+  }
+  assert(ConcurrentBuilds && "Already has a PCM");
+
+  // Another thread added the PCM since this one looked it up. Use its buffer,
+  // unless it has been dropped in the meantime. In that case the PCM stays to
+  // be built, and the buffer read from disk is only kept for this thread.
+  if (PCM.Buffer)
+    return *PCM.Buffer;
+  DroppedBuffers.push_back(std::move(Buffer));
+  return *DroppedBuffers.back();
 }
 
 llvm::MemoryBuffer &
 InMemoryModuleCache::addBuiltPCM(llvm::StringRef Filename,
                                  std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+  std::lock_guard<std::mutex> Guard(Lock);
   auto &PCM = PCMs[Filename];
+  if (ConcurrentBuilds) {
+    // Another thread built the same PCM, if it gave up waiting for the lock
+    // file. Keep the first one.
+    if (PCM.IsFinal)
+      return *PCM.Buffer;
+    // Another thread read the previous version from disk while this one was
+    // building it, and may still be reading it.
+    if (PCM.Buffer)
+      DroppedBuffers.push_back(std::move(PCM.Buffer));
+  }
   assert(!PCM.IsFinal && "Trying to override finalized PCM?");
   assert(!PCM.Buffer && "Trying to override tentative PCM?");
   PCM.Buffer = std::move(Buffer);
@@ -42,6 +67,7 @@ InMemoryModuleCache::addBuiltPCM(llvm::StringRef Filename,
 
 llvm::MemoryBuffer *
 InMemoryModuleCache::lookupPCM(llvm::StringRef Filename) const {
+  std::lock_guard<std::mutex> Guard(Lock);
   auto I = PCMs.find(Filename);
   if (I == PCMs.end())
     return nullptr;
@@ -57,24 +83,50 @@ bool InMemoryModuleCache::shouldBuildPCM(llvm::StringRef Filename) const {
 }
 
 bool InMemoryModuleCache::tryToDropPCM(llvm::StringRef Filename) {
+  std::lock_guard<std::mutex> Guard(Lock);
   auto I = PCMs.find(Filename);
   assert(I != PCMs.end() && "PCM to remove is unknown...");
 
   auto &PCM = I->second;
+  // Another thread may have dropped the PCM first.
+  if (ConcurrentBuilds && !PCM.Buffer)
+    return false;
   assert(PCM.Buffer && "PCM to remove is scheduled to be built...");
 
   if (PCM.IsFinal)
     return true;
 
-  PCM.Buffer.reset();
+  // Another thread may have looked the buffer up before it was dropped.
+  if (ConcurrentBuilds)
+    DroppedBuffers.push_back(std::move(PCM.Buffer));
+  else
+    PCM.Buffer.reset();
   return false;
 }
 
 void InMemoryModuleCache::finalizePCM(llvm::StringRef Filename) {
+  std::lock_guard<std::mutex> Guard(Lock);
   auto I = PCMs.find(Filename);
   assert(I != PCMs.end() && "PCM to finalize is unknown...");
 
   auto &PCM = I->second;
+  // Another thread may have found the PCM out of date and dropped it. It
+  // stays to be built.
+  if (ConcurrentBuilds && !PCM.Buffer)
+    return;
   assert(PCM.Buffer && "Trying to finalize a dropped PCM...");
   PCM.IsFinal = true;
 }
+
+void InMemoryModuleCache::beginConcurrentBuilds() {
+  std::lock_guard<std::mutex> Guard(Lock);
+  ++ConcurrentBuilds;
+}
+
+void InMemoryModuleCache::endConcurrentBuilds() {
+  std::lock_guard<std::mutex> Guard(Lock);
+  assert(ConcurrentBuilds && "Not building modules concurrently");
+  // Once the other threads are done, nobody holds the dropped buffers.
+  if (--ConcurrentBuilds == 0)
+    DroppedBuffers.clear();
+}
@@ -1016,10 +1016,10 @@ bool ExprEngine::shouldInlineCall(const CallEvent &Call, const Decl *D,
       (!isSmall(CalleeADC) || IsRecursive))
     return false;
 
-  // Do not inline large functions too many times.
-  if ((Engine.FunctionSummaries->getNumTimesInlined(D) >
-       Opts.MaxTimesInlineLarge) &&
-      isLarge(CalleeADC)) {
+  // Do not inline large functions too many times. Check the size first, so
+  // that the count is only consulted where it matters.
+  if (isLarge(CalleeADC) && Engine.FunctionSummaries->getNumTimesInlined(D) >
+                                Opts.MaxTimesInlineLarge) {
     NumReachedInlineCountMax++;
     return false;
   }
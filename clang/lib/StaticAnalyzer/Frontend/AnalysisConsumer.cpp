@@ -22,10 +22,14 @@
 #include "clang/Analysis/CodeInjector.h"
 #include "clang/Analysis/MacroExpansionContext.h"
 #include "clang/Analysis/PathDiagnostic.h"
+#include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/Stack.h"
 #include "clang/CrossTU/CrossTranslationUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendAction.h"
 #include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "clang/StaticAnalyzer/Checkers/LocalCheckers.h"
 #include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
@@ -34,13 +38,17 @@
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <memory>
 #include <queue>
 #include <utility>
@@ -67,6 +75,95 @@ STATISTIC(MaxCFGSize, "The maximum number of basic blocks in a function.");
 
 namespace {
 
+/// Numbers the functions of a translation unit in a fixed order. Every
+/// analysis shard parses its own copy of the translation unit, so shards refer
+/// to functions by these numbers when they report back to shard 0.
+class FunctionNumbering : public RecursiveASTVisitor<FunctionNumbering> {
+public:
+  std::vector<const Decl *> Functions;
+  llvm::DenseMap<const Decl *, unsigned> IDs;
+
+  /// Identifies the copy of the translation unit. Copies with the same hash
+  /// have the same source locations and number their functions the same way.
+  llvm::hash_code Hash;
+
+  FunctionNumbering(ASTContext &C, const SetOfDecls &TopLevelDecls,
+                    unsigned NumTopLevelDecls) {
+    const SourceManager &SM = C.getSourceManager();
+    Hash = llvm::hash_combine(SM.local_sloc_entry_size(),
+                              SM.loaded_sloc_entry_size(),
+                              SM.getNextLocalOffset());
+    for (unsigned I = 0; I != NumTopLevelDecls; ++I)
+      TraverseDecl(TopLevelDecls[I]);
+  }
+
+  Optional<unsigned> getID(const Decl *D) const {
+    auto I = IDs.find(D);
+    if (I == IDs.end())
+      return None;
+    return I->second;
+  }
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+  bool shouldWalkTypesOfTypeLocs() const { return false; }
+
+  bool VisitFunctionDecl(FunctionDecl *D) { return add(D); }
+  bool VisitObjCMethodDecl(ObjCMethodDecl *D) { return add(D); }
+  bool VisitBlockDecl(BlockDecl *D) { return add(D); }
+
+private:
+  bool add(const Decl *D) {
+    if (IDs.try_emplace(D, Functions.size()).second) {
+      Functions.push_back(D);
+      Hash = llvm::hash_combine(Hash, D->getKind(),
+                                D->getLocation().getRawEncoding());
+    }
+    return true;
+  }
+};
+
+/// The analysis of a top-level function by an analysis shard. It only stands
+/// if the function summaries it used were the same as they would have been
+/// in a single-threaded analysis.
+struct SpeculativeResult {
+  ExprEngine::InliningModes IMode;
+
+  /// True if the analysis found bugs. The reports themselves are not kept;
+  /// shard 0 analyzes the function again to emit them.
+  bool HasReports = false;
+
+  /// False if the analysis depends on a function without an ID.
+  bool Complete = true;
+
+  /// The IDs of the functions which count as visited after the analysis.
+  std::vector<unsigned> VisitedCallees;
+
+  /// A function summary used by the analysis, and what it was left as.
+  struct SummaryChange {
+    unsigned ID;
+    FunctionSummariesTy::SummaryAccess Access;
+    FunctionSummariesTy::FunctionSummary After;
+  };
+  std::vector<SummaryChange> Summaries;
+};
+
+/// The outcome of one of the speculative shards of a translation unit.
+struct AnalysisShard {
+  /// The invocation and options the shard runs with.
+  std::shared_ptr<CompilerInvocation> Invocation;
+  AnalyzerOptionsRef Opts;
+
+  /// True once the shard has analyzed its share of the functions.
+  bool Analyzed = false;
+
+  /// The hash of the shard's function numbering.
+  llvm::hash_code Hash;
+
+  /// The analyzed functions, by their position in call graph order.
+  llvm::DenseMap<unsigned, SpeculativeResult> Results;
+};
+
 class AnalysisConsumer : public AnalysisASTConsumer,
                          public RecursiveASTVisitor<AnalysisConsumer> {
   enum {
@@ -84,6 +181,7 @@ class AnalysisConsumer : public AnalysisASTConsumer,
   std::vector<std::function<void(CheckerRegistry &)>> CheckerRegistrationFns;
 
 public:
+  CompilerInstance &CI;
   ASTContext *Ctx;
   Preprocessor &PP;
   const std::string OutDir;
@@ -120,13 +218,39 @@ public:
   /// translation unit.
   FunctionSummariesTy FunctionSummaries;
 
+  /// When the path-sensitive analysis of the translation unit is split between
+  /// several threads, shards 1 to \c NumShards each parse a copy of the
+  /// translation unit. Shard \c ShardIndex analyzes every \c NumShards-th
+  /// top-level function in call graph order, starting at the
+  /// (\c ShardIndex - 1)-th one, as if no other function had been analyzed.
+  /// Shard 0 belongs to the compiler invocation. It runs all the other checks,
+  /// then walks the functions in call graph order like a single-threaded
+  /// analysis. It takes over the results of the other shards where they are
+  /// the same as its own would be, and analyzes the rest itself.
+  unsigned ShardIndex;
+  unsigned NumShards;
+
+  /// In shard 0, the other shards.
+  std::vector<AnalysisShard> Shards;
+
+  /// In the other shards, where they store their results.
+  AnalysisShard *ShardOutput = nullptr;
+
+  /// Numbers the functions when there are several shards.
+  std::unique_ptr<FunctionNumbering> Numbering;
+
+  /// Whether the last path-sensitive analysis found bugs.
+  bool HasPathReports = false;
+
   AnalysisConsumer(CompilerInstance &CI, const std::string &outdir,
                    AnalyzerOptionsRef opts, ArrayRef<std::string> plugins,
-                   CodeInjector *injector)
-      : RecVisitorMode(0), RecVisitorBR(nullptr), Ctx(nullptr),
+                   CodeInjector *injector, unsigned ShardIndex = 0,
+                   unsigned NumShards = 1)
+      : RecVisitorMode(0), RecVisitorBR(nullptr), CI(CI), Ctx(nullptr),
         PP(CI.getPreprocessor()), OutDir(outdir), Opts(std::move(opts)),
         Plugins(plugins), Injector(injector), CTU(CI),
-        MacroExpansions(CI.getLangOpts()) {
+        MacroExpansions(CI.getLangOpts()), ShardIndex(ShardIndex),
+        NumShards(NumShards) {
     DigestAnalyzerOptions();
     if (Opts->PrintStats || Opts->ShouldSerializeStats) {
       AnalyzerTimers = std::make_unique<llvm::TimerGroup>(
@@ -351,9 +475,43 @@ private:
   AnalysisMode getModeForDecl(Decl *D, AnalysisMode Mode);
   void runAnalysisOnTranslationUnit(ASTContext &C);
 
+  /// Start analyzing the other shards of the translation unit, if the options
+  /// ask for it. Returns the thread pool running them, or null.
+  std::unique_ptr<llvm::ThreadPool> startAnalysisShards();
+  void runAnalysisShard(unsigned Index);
+
+  /// In a shard other than shard 0, analyze the top-level function \p D at
+  /// position \p Position in call graph order, and record the result.
+  void analyzeSpeculatively(unsigned Position, Decl *D,
+                            ExprEngine::InliningModes IMode,
+                            SetOfConstDecls *VisitedCallees);
+
+  /// In shard 0, take over the result of the shard which analyzed the
+  /// top-level function at position \p Position, if it is the same as
+  /// analyzing it here with \p IMode would give. Returns false if the function
+  /// needs to be analyzed here.
+  bool takeSpeculativeResult(unsigned Position,
+                             ExprEngine::InliningModes IMode,
+                             SetOfConstDecls &VisitedCallees);
+
   /// Print \p S to stderr if \c Opts->AnalyzerDisplayProgress is set.
   void reportAnalyzerProgress(StringRef S);
 }; // namespace
+
+/// Parses and analyzes one of the other shards of a translation unit on behalf
+/// of shard 0.
+class AnalysisShardAction : public ASTFrontendAction {
+  AnalysisConsumer &Owner;
+  unsigned Index;
+
+public:
+  AnalysisShardAction(AnalysisConsumer &Owner, unsigned Index)
+      : Owner(Owner), Index(Index) {}
+
+protected:
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
+                                                 StringRef InFile) override;
+};
 } // end anonymous namespace
 
 
@@ -415,6 +573,14 @@ static bool shouldSkipFunction(const Decl *D,
   return Visited.count(D);
 }
 
+/// Returns the declaration which stands for \p Callee in the set of visited
+/// functions.
+static const Decl *getVisitedDecl(const Decl *Callee) {
+  // Decls from CallGraph are already canonical. But Decls coming from
+  // CallExprs may be not. We should canonicalize them manually.
+  return isa<ObjCMethodDecl>(Callee) ? Callee : Callee->getCanonicalDecl();
+}
+
 ExprEngine::InliningModes
 AnalysisConsumer::getInliningModeForFunction(const Decl *D,
                                              const SetOfConstDecls &Visited) {
@@ -448,6 +614,7 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   // often.
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
+  unsigned Position = 0;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
@@ -460,6 +627,12 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    // Leave the functions of the other shards to them. Every shard sees the
+    // same call graph, so the positions agree.
+    unsigned CurrentPosition = Position++;
+    if (ShardIndex != 0 && CurrentPosition % NumShards != ShardIndex - 1)
+      continue;
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
@@ -467,16 +640,18 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
 
     // Analyze the function.
     SetOfConstDecls VisitedCallees;
+    ExprEngine::InliningModes IMode = getInliningModeForFunction(D, Visited);
+    SetOfConstDecls *VisitedCalleesOrNull =
+        Mgr->options.InliningMode == All ? nullptr : &VisitedCallees;
 
-    HandleCode(D, AM_Path, getInliningModeForFunction(D, Visited),
-               (Mgr->options.InliningMode == All ? nullptr : &VisitedCallees));
+    if (ShardIndex != 0)
+      analyzeSpeculatively(CurrentPosition, D, IMode, VisitedCalleesOrNull);
+    else if (!takeSpeculativeResult(CurrentPosition, IMode, VisitedCallees))
+      HandleCode(D, AM_Path, IMode, VisitedCalleesOrNull);
 
     // Add the visited callees to the global visited set.
     for (const Decl *Callee : VisitedCallees)
-      // Decls from CallGraph are already canonical. But Decls coming from
-      // CallExprs may be not. We should canonicalize them manually.
-      Visited.insert(isa<ObjCMethodDecl>(Callee) ? Callee
-                                                 : Callee->getCanonicalDecl());
+      Visited.insert(getVisitedDecl(Callee));
     VisitedAsTopLevel.insert(D);
   }
 }
@@ -491,6 +666,25 @@ static bool isBisonFile(ASTContext &C) {
 }
 
 void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
+  // The other shards only run the path-sensitive checks on their share of the
+  // top-level functions; everything else is done once, by shard 0.
+  if (ShardIndex != 0) {
+    Numbering = std::make_unique<FunctionNumbering>(C, LocalTUDecls,
+                                                    LocalTUDecls.size());
+    ShardOutput->Hash = Numbering->Hash;
+    HandleDeclsCallGraph(LocalTUDecls.size());
+    ShardOutput->Analyzed = true;
+    return;
+  }
+
+  // Let the other shards, if any, analyze the functions while this thread
+  // runs the other checks. Number the functions before those checks, at the
+  // same point as the other shards do.
+  std::unique_ptr<llvm::ThreadPool> ShardPool = startAnalysisShards();
+  if (ShardPool)
+    Numbering = std::make_unique<FunctionNumbering>(C, LocalTUDecls,
+                                                    LocalTUDecls.size());
+
   BugReporter BR(*Mgr);
   TranslationUnitDecl *TU = C.getTranslationUnitDecl();
   if (SyntaxCheckTimer)
@@ -518,6 +712,9 @@ void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
     TraverseDecl(LocalTUDecls[i]);
   }
 
+  if (ShardPool)
+    ShardPool->wait();
+
   if (Mgr->shouldInlineCall())
     HandleDeclsCallGraph(LocalTUDeclsSize);
 
@@ -528,6 +725,217 @@ void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
   RecVisitorBR = nullptr;
 }
 
+std::unique_ptr<llvm::ThreadPool> AnalysisConsumer::startAnalysisShards() {
+  // Every shard builds its own copy of the translation unit from the compiler
+  // invocation, and its results are only meaningful here if the copy is the
+  // same. Analyses which load more code on demand, or which cannot be
+  // recreated from the invocation, stay on one thread. So do those which
+  // print something for every analyzed function.
+  unsigned Jobs = Opts->AnalysisJobs;
+  ArrayRef<FrontendInputFile> Inputs = CI.getFrontendOpts().Inputs;
+  if (Jobs <= 1 || !Mgr->shouldInlineCall() || Opts->IsNaiveCTUEnabled ||
+      Injector || !CheckerRegistrationFns.empty() ||
+      !Opts->DumpExplodedGraphTo.empty() ||
+      Opts->visualizeExplodedGraphWithGraphViz || Opts->PrintStats ||
+      Opts->ShouldSerializeStats || Opts->AnalyzerDisplayProgress ||
+      Inputs.size() != 1 ||
+      Inputs[0].getKind().getFormat() != InputKind::Source)
+    return nullptr;
+
+  NumShards = Jobs;
+  Shards.resize(NumShards);
+  for (AnalysisShard &Shard : Shards) {
+    // The shard's only output are the results it hands over to shard 0.
+    Shard.Invocation = std::make_shared<CompilerInvocation>(CI.getInvocation());
+    FrontendOptions &FrontendOpts = Shard.Invocation->getFrontendOpts();
+    FrontendOpts.DisableFree = false;
+    FrontendOpts.ShowStats = false;
+    FrontendOpts.StatsFile.clear();
+    Shard.Invocation->getDependencyOutputOpts() = DependencyOutputOptions();
+    DiagnosticOptions &DiagOpts = Shard.Invocation->getDiagnosticOpts();
+    DiagOpts.DiagnosticLogFile.clear();
+    DiagOpts.DiagnosticSerializationFile.clear();
+    DiagOpts.VerifyDiagnostics = 0;
+
+    // Don't free the remapped file buffers; they are owned by our caller.
+    Shard.Invocation->getPreprocessorOpts().RetainRemappedFileBuffers = true;
+
+    Shard.Opts = new AnalyzerOptions(*Opts);
+    Shard.Opts->AnalysisDiagOpt = PD_NONE;
+    Shard.Opts->ShouldDisplayMacroExpansions = false;
+  }
+
+  auto Pool =
+      std::make_unique<llvm::ThreadPool>(llvm::hardware_concurrency(Jobs));
+  for (unsigned Index = 1; Index <= NumShards; ++Index)
+    Pool->async([this, Index] { runAnalysisShard(Index); });
+  return Pool;
+}
+
+void AnalysisConsumer::runAnalysisShard(unsigned Index) {
+  // The shard's copy of the translation unit is freed once it is analyzed.
+  CompilerInstance Instance(CI.getPCHContainerOperations());
+  Instance.setInvocation(Shards[Index - 1].Invocation);
+
+  // The diagnostics about the code itself are emitted by shard 0.
+  Instance.createDiagnostics(new IgnoringDiagConsumer(),
+                             /*ShouldOwnClient=*/true);
+  Instance.createFileManager(&CI.getFileManager().getVirtualFileSystem());
+
+  // Parse and analyze on a thread of our own, so that we get a stack as large
+  // as the main thread's; the thread pool's threads have the default stack
+  // size. With crash recovery enabled, a shard which crashes is never marked
+  // as analyzed, so shard 0 does its share of the work instead.
+  llvm::CrashRecoveryContext CRC;
+  CRC.RunSafelyOnThread(
+      [&]() {
+        noteBottomOfStack();
+        AnalysisShardAction Action(*this, Index);
+        Instance.ExecuteAction(Action);
+      },
+      DesiredStackSize);
+}
+
+void AnalysisConsumer::analyzeSpeculatively(unsigned Position, Decl *D,
+                                            ExprEngine::InliningModes IMode,
+                                            SetOfConstDecls *VisitedCallees) {
+  FunctionSummariesTy::AccessMapTy Accesses;
+  FunctionSummaries.recordAccesses(&Accesses);
+  HasPathReports = false;
+  HandleCode(D, AM_Path, IMode, VisitedCallees);
+  FunctionSummaries.recordAccesses(nullptr);
+
+  SpeculativeResult &Result = ShardOutput->Results[Position];
+  Result.IMode = IMode;
+  Result.HasReports = HasPathReports;
+
+  if (VisitedCallees) {
+    for (const Decl *Callee : *VisitedCallees) {
+      Optional<unsigned> ID = Numbering->getID(getVisitedDecl(Callee));
+      if (!ID) {
+        Result.Complete = false;
+        return;
+      }
+      Result.VisitedCallees.push_back(*ID);
+    }
+  }
+
+  for (const auto &Access : Accesses) {
+    Optional<unsigned> ID = Numbering->getID(Access.first);
+    if (!ID) {
+      Result.Complete = false;
+      return;
+    }
+    const FunctionSummariesTy::FunctionSummary *After =
+        FunctionSummaries.lookup(Access.first);
+    Result.Summaries.push_back(
+        {*ID, Access.second,
+         After ? *After : FunctionSummariesTy::FunctionSummary()});
+  }
+}
+
+/// Returns true if an analysis which used a function summary as described by
+/// \p Used, and left it as \p After, would have gone the same way if the
+/// summary had been \p Current instead.
+static bool
+isEquivalentSummary(const FunctionSummariesTy::SummaryAccess &Used,
+                    const FunctionSummariesTy::FunctionSummary &Current,
+                    const FunctionSummariesTy::FunctionSummary &After,
+                    unsigned MaxTimesInlineLarge) {
+  auto MayInline =
+      [](const FunctionSummariesTy::FunctionSummary &S) -> Optional<bool> {
+    if (!S.InlineChecked)
+      return None;
+    return static_cast<bool>(S.MayInline);
+  };
+
+  // If the analysis did not ask whether the function may be inlined, it is
+  // left unchecked.
+  Optional<bool> Before = MayInline(Used.Before);
+  Optional<bool> Now = MayInline(Current);
+  if (Before != Now && MayInline(After)) {
+    // Only the check of the function's own properties allows inlining, and
+    // it gives the same answer in every shard. So a function which has not
+    // been checked yet is as good as one which that check allowed.
+    if (Before.hasValue() == Now.hasValue())
+      return false;
+    if (!Before.getValueOr(true) || !Now.getValueOr(true))
+      return false;
+    // If the analysis ran the check itself, it must have allowed inlining.
+    if (!Before && !*MayInline(After))
+      return false;
+  }
+
+  // The number of times a function was inlined only matters up to the limit.
+  if (Used.ReadTimesInlined &&
+      std::min<unsigned>(Used.Before.TimesInlined, MaxTimesInlineLarge + 1) !=
+          std::min<unsigned>(Current.TimesInlined, MaxTimesInlineLarge + 1))
+    return false;
+
+  return true;
+}
+
+bool AnalysisConsumer::takeSpeculativeResult(unsigned Position,
+                                             ExprEngine::InliningModes IMode,
+                                             SetOfConstDecls &VisitedCallees) {
+  if (Shards.empty())
+    return false;
+  const AnalysisShard &Shard = Shards[Position % Shards.size()];
+  if (!Shard.Analyzed || Shard.Hash != Numbering->Hash)
+    return false;
+  auto I = Shard.Results.find(Position);
+  if (I == Shard.Results.end())
+    return false;
+  const SpeculativeResult &Result = I->second;
+  if (Result.HasReports || !Result.Complete || Result.IMode != IMode)
+    return false;
+
+  FunctionSummariesTy::FunctionSummary Unused;
+  for (const SpeculativeResult::SummaryChange &Change : Result.Summaries) {
+    const FunctionSummariesTy::FunctionSummary *Current =
+        FunctionSummaries.lookup(Numbering->Functions[Change.ID]);
+    if (!isEquivalentSummary(Change.Access, Current ? *Current : Unused,
+                             Change.After, Opts->MaxTimesInlineLarge))
+      return false;
+  }
+
+  // Make the summaries what analyzing the function here would have made them.
+  for (const SpeculativeResult::SummaryChange &Change : Result.Summaries) {
+    FunctionSummariesTy::FunctionSummary &Summary =
+        FunctionSummaries.findOrInsertSummary(Numbering->Functions[Change.ID])
+            ->second;
+    const FunctionSummariesTy::FunctionSummary &After = Change.After;
+    if (After.InlineChecked) {
+      Summary.InlineChecked = 1;
+      Summary.MayInline = After.MayInline;
+    }
+    Summary.TimesInlined +=
+        After.TimesInlined - Change.Access.Before.TimesInlined;
+    if (After.VisitedBasicBlocks.size() > Summary.VisitedBasicBlocks.size()) {
+      Summary.VisitedBasicBlocks.resize(After.VisitedBasicBlocks.size());
+      Summary.TotalBasicBlocks = After.TotalBasicBlocks;
+    }
+    Summary.VisitedBasicBlocks |= After.VisitedBasicBlocks;
+  }
+
+  for (unsigned ID : Result.VisitedCallees)
+    VisitedCallees.insert(Numbering->Functions[ID]);
+  return true;
+}
+
+std::unique_ptr<ASTConsumer>
+AnalysisShardAction::CreateASTConsumer(CompilerInstance &CI, StringRef) {
+  // Like CreateAnalysisConsumer, so that the shard parses like shard 0 did.
+  CI.getDiagnostics().setWarningsAsErrors(false);
+
+  AnalysisShard &Shard = Owner.Shards[Index - 1];
+  auto Consumer = std::make_unique<AnalysisConsumer>(
+      CI, Owner.OutDir, std::move(Shard.Opts), Owner.Plugins,
+      /*injector=*/nullptr, Index, Owner.NumShards);
+  Consumer->ShardOutput = &Shard;
+  return std::move(Consumer);
+}
+
 void AnalysisConsumer::reportAnalyzerProgress(StringRef S) {
   if (Opts->AnalyzerDisplayProgress)
     llvm::errs() << S;
@@ -719,9 +1127,12 @@ void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
     Eng.ViewGraph(Mgr->options.TrimGraph);
 
   // Display warnings.
+  BugReporter &BR = Eng.getBugReporter();
+  if (BR.EQClasses_begin() != BR.EQClasses_end())
+    HasPathReports = true;
   if (BugReporterTimer)
     BugReporterTimer->startTimer();
-  Eng.getBugReporter().FlushReports();
+  BR.FlushReports();
   if (BugReporterTimer)
     BugReporterTimer->stopTimer();
 }
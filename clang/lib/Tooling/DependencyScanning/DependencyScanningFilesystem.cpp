@@ -7,16 +7,56 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
+#include "clang/Basic/Version.h"
 #include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/Threading.h"
 
 using namespace clang;
 using namespace tooling;
 using namespace dependencies;
 
+CachedFileSystemEntry CachedFileSystemEntry::createMinimizedEntry(
+    const llvm::vfs::Status &Stat, StringRef Contents,
+    PreprocessorSkippedRangeMapping Mapping) {
+  CachedFileSystemEntry Result;
+  size_t Size = Contents.size();
+  Result.MaybeStat = llvm::vfs::Status(Stat.getName(), Stat.getUniqueID(),
+                                       Stat.getLastModificationTime(),
+                                       Stat.getUser(), Stat.getGroup(), Size,
+                                       Stat.getType(), Stat.getPermissions());
+  Result.Contents.reserve(Size + 1);
+  Result.Contents.append(Contents.begin(), Contents.end());
+  // Implicitly null terminate the contents for Clang's lexer.
+  Result.Contents.push_back('\0');
+  Result.Contents.pop_back();
+  Result.PPSkippedRangeMapping = std::move(Mapping);
+  return Result;
+}
+
 CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
-    StringRef Filename, llvm::vfs::FileSystem &FS, bool Minimize) {
+    StringRef Filename, llvm::vfs::FileSystem &FS, bool Minimize,
+    DependencyScanningPersistentCache *PersistentCache) {
+  if (!Minimize)
+    PersistentCache = nullptr;
+
+  // If the file hasn't changed since it was cached, there's no need to read it.
+  if (PersistentCache) {
+    llvm::ErrorOr<llvm::vfs::Status> Stat = FS.status(Filename);
+    if (Stat && Stat->isRegularFile())
+      if (auto Hash = PersistentCache->getContentHash(*Stat))
+        if (auto File = PersistentCache->getMinimizedFile(*Hash))
+          return createMinimizedEntry(*Stat, File->Contents,
+                                      std::move(File->Mapping));
+  }
+
   // Load the file and its content from the file system.
   llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> MaybeFile =
       FS.openFileForRead(Filename);
@@ -31,10 +71,23 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
       F.getBuffer(Stat->getName());
   if (!MaybeBuffer)
     return MaybeBuffer.getError();
+  const auto &Buffer = *MaybeBuffer;
+
+  // The file may have been touched without changing, or an identical file may
+  // have been minimized already.
+  DependencyScanningPersistentCache::ContentHash Hash;
+  if (PersistentCache) {
+    Hash = DependencyScanningPersistentCache::hashContents(
+        Buffer->getBuffer());
+    if (auto File = PersistentCache->getMinimizedFile(Hash)) {
+      PersistentCache->setContentHash(*Stat, Hash);
+      return createMinimizedEntry(*Stat, File->Contents,
+                                  std::move(File->Mapping));
+    }
+  }
 
   llvm::SmallString<1024> MinimizedFileContents;
   // Minimize the file down to directives that might affect the dependencies.
-  const auto &Buffer = *MaybeBuffer;
   SmallVector<minimize_source_to_dependency_directives::Token, 64> Tokens;
   if (!Minimize || minimizeSourceToDependencyDirectives(
                        Buffer->getBuffer(), MinimizedFileContents, Tokens)) {
@@ -51,24 +104,9 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
     return Result;
   }
 
-  CachedFileSystemEntry Result;
-  size_t Size = MinimizedFileContents.size();
-  Result.MaybeStat = llvm::vfs::Status(Stat->getName(), Stat->getUniqueID(),
-                                       Stat->getLastModificationTime(),
-                                       Stat->getUser(), Stat->getGroup(), Size,
-                                       Stat->getType(), Stat->getPermissions());
   // The contents produced by the minimizer must be null terminated.
   assert(MinimizedFileContents.data()[MinimizedFileContents.size()] == '\0' &&
          "not null terminated contents");
-  // Even though there's an implicit null terminator in the minimized contents,
-  // we want to temporarily make it explicit. This will ensure that the
-  // std::move will preserve it even if it needs to do a copy if the
-  // SmallString still has the small capacity.
-  MinimizedFileContents.push_back('\0');
-  Result.Contents = std::move(MinimizedFileContents);
-  // Now make the null terminator implicit again, so that Clang's lexer can find
-  // it right where the buffer ends.
-  Result.Contents.pop_back();
 
   // Compute the skipped PP ranges that speedup skipping over inactive
   // preprocessor blocks.
@@ -86,9 +124,16 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
     }
     Mapping[Range.Offset] = Range.Length;
   }
-  Result.PPSkippedRangeMapping = std::move(Mapping);
 
-  return Result;
+  if (PersistentCache) {
+    DependencyScanningPersistentCache::MinimizedFile File;
+    File.Contents = MinimizedFileContents;
+    File.Mapping = Mapping;
+    PersistentCache->setMinimizedFile(Hash, File);
+    PersistentCache->setContentHash(*Stat, Hash);
+  }
+
+  return createMinimizedEntry(*Stat, MinimizedFileContents, std::move(Mapping));
 }
 
 CachedFileSystemEntry
@@ -99,6 +144,185 @@ CachedFileSystemEntry::createDirectoryEntry(llvm::vfs::Status &&Stat) {
   return Result;
 }
 
+namespace {
+/// Bump this whenever the layout of the entries changes.
+constexpr uint32_t PersistentCacheFormatVersion = 1;
+constexpr char MinimizedFileMagic[4] = {'D', 'S', 'M', 'F'};
+constexpr char ContentHashMagic[4] = {'D', 'S', 'C', 'H'};
+/// Files modified this recently are not recorded in the stat index, as a
+/// further change within the same timestamp granularity would go unnoticed.
+constexpr std::chrono::seconds RacyModificationWindow(2);
+} // end anonymous namespace
+
+/// Atomically replace the entry at \p EntryPath with \p Data. Failures are
+/// ignored, as the entry is then simply missing from the cache.
+static void writeCacheEntry(StringRef Dir, StringRef EntryPath,
+                            StringRef Data) {
+  SmallString<256> TempModel(Dir);
+  llvm::sys::path::append(TempModel, "tmp-%%%%%%%%");
+  llvm::Expected<llvm::sys::fs::TempFile> Temp =
+      llvm::sys::fs::TempFile::create(TempModel);
+  if (!Temp) {
+    llvm::consumeError(Temp.takeError());
+    return;
+  }
+  {
+    llvm::raw_fd_ostream OS(Temp->FD, /*shouldClose=*/false);
+    OS << Data;
+    OS.flush();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::consumeError(Temp->discard());
+      return;
+    }
+  }
+  // keep() removes the temporary file itself if the rename fails, except on
+  // Windows where another process may have the entry open.
+  if (llvm::Error E = Temp->keep(EntryPath)) {
+    llvm::handleAllErrors(std::move(E), [&](const llvm::ECError &EC) {
+      if (EC.convertToErrorCode() == std::errc::permission_denied)
+        llvm::consumeError(Temp->discard());
+    });
+  }
+}
+
+/// \returns The contents of the entry at \p EntryPath following the magic
+/// \p Magic, or None if the entry is missing or of a different kind.
+static Optional<std::unique_ptr<llvm::MemoryBuffer>>
+readCacheEntry(StringRef EntryPath, StringRef Magic) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(EntryPath, /*IsText=*/false,
+                                  /*RequiresNullTerminator=*/false,
+                                  /*IsVolatile=*/true);
+  if (!Buffer || !(*Buffer)->getBuffer().startswith(Magic))
+    return None;
+  return std::move(*Buffer);
+}
+
+DependencyScanningPersistentCache::DependencyScanningPersistentCache(
+    StringRef Path)
+    : Path(Path.str()) {
+  llvm::sys::fs::create_directories(Path);
+  Version = getClangFullRepositoryVersion();
+  Version += '\0';
+  Version += llvm::utostr(PersistentCacheFormatVersion);
+}
+
+DependencyScanningPersistentCache::ContentHash
+DependencyScanningPersistentCache::hashContents(StringRef Contents) {
+  return llvm::SHA1::hash(llvm::arrayRefFromStringRef(Contents));
+}
+
+DependencyScanningPersistentCache::ContentHash
+DependencyScanningPersistentCache::getKey(StringRef Kind,
+                                          ArrayRef<uint8_t> Data) const {
+  llvm::SHA1 Hasher;
+  Hasher.update(Version);
+  Hasher.update(Kind);
+  Hasher.update(Data);
+  StringRef Digest = Hasher.final();
+  ContentHash Key;
+  std::copy(Digest.begin(), Digest.end(), Key.begin());
+  return Key;
+}
+
+SmallString<256>
+DependencyScanningPersistentCache::getEntryPath(const ContentHash &Hash) const {
+  SmallString<256> EntryPath(Path);
+  // Use the prefix that llvm::pruneCache recognizes.
+  llvm::sys::path::append(EntryPath,
+                          "llvmcache-" + llvm::toHex(Hash, /*LowerCase=*/true));
+  return EntryPath;
+}
+
+DependencyScanningPersistentCache::ContentHash
+DependencyScanningPersistentCache::getStatKey(
+    const llvm::vfs::Status &Stat) const {
+  SmallString<64> Key;
+  llvm::raw_svector_ostream OS(Key);
+  llvm::support::endian::Writer W(OS, llvm::support::little);
+  W.write(Stat.getUniqueID().getDevice());
+  W.write(Stat.getUniqueID().getFile());
+  W.write(Stat.getSize());
+  W.write<uint64_t>(
+      Stat.getLastModificationTime().time_since_epoch().count());
+  return getKey(StringRef(ContentHashMagic, 4),
+                llvm::arrayRefFromStringRef(Key));
+}
+
+Optional<DependencyScanningPersistentCache::ContentHash>
+DependencyScanningPersistentCache::getContentHash(
+    const llvm::vfs::Status &Stat) const {
+  auto Buffer = readCacheEntry(getEntryPath(getStatKey(Stat)),
+                               StringRef(ContentHashMagic, 4));
+  if (!Buffer)
+    return None;
+  StringRef Data = (*Buffer)->getBuffer().drop_front(4);
+  ContentHash Hash;
+  if (Data.size() != Hash.size())
+    return None;
+  std::copy(Data.begin(), Data.end(), Hash.begin());
+  return Hash;
+}
+
+void DependencyScanningPersistentCache::setContentHash(
+    const llvm::vfs::Status &Stat, const ContentHash &Hash) const {
+  if (std::chrono::system_clock::now() - Stat.getLastModificationTime() <
+      RacyModificationWindow)
+    return;
+  SmallString<32> Data(StringRef(ContentHashMagic, 4));
+  Data += llvm::toStringRef(Hash);
+  writeCacheEntry(Path, getEntryPath(getStatKey(Stat)), Data);
+}
+
+Optional<DependencyScanningPersistentCache::MinimizedFile>
+DependencyScanningPersistentCache::getMinimizedFile(
+    const ContentHash &Hash) const {
+  ContentHash Key = getKey(StringRef(MinimizedFileMagic, 4), Hash);
+
+  auto Buffer =
+      readCacheEntry(getEntryPath(Key), StringRef(MinimizedFileMagic, 4));
+  if (!Buffer)
+    return None;
+  StringRef Data = (*Buffer)->getBuffer().drop_front(4);
+
+  // The magic is followed by the number of skipped ranges, the ranges as pairs
+  // of offset and length, and the minimized contents.
+  using namespace llvm::support;
+  if (Data.size() < 4)
+    return None;
+  uint32_t NumRanges = endian::read32le(Data.data());
+  Data = Data.drop_front(4);
+  if (Data.size() / 8 < NumRanges)
+    return None;
+  MinimizedFile File;
+  for (uint32_t I = 0; I != NumRanges; ++I) {
+    uint32_t Offset = endian::read32le(Data.data());
+    uint32_t Length = endian::read32le(Data.data() + 4);
+    File.Mapping[Offset] = Length;
+    Data = Data.drop_front(8);
+  }
+  File.Contents = Data;
+  return File;
+}
+
+void DependencyScanningPersistentCache::setMinimizedFile(
+    const ContentHash &Hash, const MinimizedFile &File) const {
+  ContentHash Key = getKey(StringRef(MinimizedFileMagic, 4), Hash);
+
+  std::string Data;
+  llvm::raw_string_ostream OS(Data);
+  OS.write(MinimizedFileMagic, 4);
+  llvm::support::endian::Writer W(OS, llvm::support::little);
+  W.write<uint32_t>(File.Mapping.size());
+  for (const auto &Range : File.Mapping) {
+    W.write<uint32_t>(Range.first);
+    W.write<uint32_t>(Range.second);
+  }
+  OS << File.Contents;
+  writeCacheEntry(Path, getEntryPath(Key), OS.str());
+}
+
 DependencyScanningFilesystemSharedCache::
     DependencyScanningFilesystemSharedCache() {
   // This heuristic was chosen using a empirical testing on a
@@ -185,7 +409,7 @@ DependencyScanningWorkerFilesystem::getOrCreateFileSystemEntry(
             std::move(*MaybeStatus));
       else
         CacheEntry = CachedFileSystemEntry::createFileEntry(
-            Filename, FS, !KeepOriginalSource);
+            Filename, FS, !KeepOriginalSource, PersistentCache);
     }
 
     Result = &CacheEntry;
@@ -160,7 +160,8 @@ DependencyScanningWorker::DependencyScanningWorker(
         std::make_unique<ExcludedPreprocessorDirectiveSkipMapping>();
   if (Service.getMode() == ScanningMode::MinimizedSourcePreprocessing)
     DepFS = new DependencyScanningWorkerFilesystem(
-        Service.getSharedCache(), RealFS, PPSkipMappings.get());
+        Service.getSharedCache(), RealFS, PPSkipMappings.get(),
+        Service.getPersistentCache());
   if (Service.canReuseFileManager())
     Files = new FileManager(FileSystemOptions(), RealFS);
 }
@@ -0,0 +1,126 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core %s \
+// RUN:   -analyzer-config max-times-inline-large=2 \
+// RUN:   -analyzer-output=text 2> %t.1.txt
+// RUN: %clang_analyze_cc1 -analyzer-checker=core %s \
+// RUN:   -analyzer-config max-times-inline-large=2 \
+// RUN:   -analyzer-output=text -analyzer-config jobs=2 2> %t.2.txt
+// RUN: %clang_analyze_cc1 -analyzer-checker=core %s \
+// RUN:   -analyzer-config max-times-inline-large=2 \
+// RUN:   -analyzer-output=text -analyzer-config jobs=5 2> %t.5.txt
+// RUN: diff %t.1.txt %t.2.txt
+// RUN: diff %t.1.txt %t.5.txt
+// RUN: FileCheck --input-file=%t.1.txt %s
+
+// The shards analyze their functions with the function summaries they built
+// themselves. Each result is only used if inlining in it went the same way
+// it would have with the summaries of a single-threaded analysis. These
+// functions are inlined in ways that make the summaries differ between the
+// shards, so the output must still be the same as with one thread.
+
+// A recursive function, inlined into itself.
+int *recurse(int n, int *p) {
+  if (n <= 0)
+    return p;
+  return recurse(n - 1, p);
+}
+
+void use_recurse(void) {
+  int *p = recurse(3, 0);
+  // CHECK-DAG: analysis-jobs-summaries.c:[[@LINE+1]]:{{[0-9]+}}: warning: Dereference of null pointer
+  *p = 1;
+}
+
+// Mutually recursive functions, called from top-level functions that are
+// analyzed by different shards.
+int pong(int n, int *p);
+
+int ping(int n, int *p) {
+  if (n <= 0)
+    // CHECK-DAG: analysis-jobs-summaries.c:[[@LINE+1]]:{{[0-9]+}}: warning: Dereference of null pointer
+    return *p;
+  return pong(n - 1, p);
+}
+
+int pong(int n, int *p) {
+  if (n <= 0)
+    return 0;
+  return ping(n - 1, p);
+}
+
+void use_ping(void) { ping(2, 0); }
+void use_pong(void) { pong(1, 0); }
+int use_ping_pong(int *p) { return ping(4, p) + pong(4, p); }
+
+// A large function may only be inlined a few times in the translation unit,
+// so whether each caller inlines it depends on the callers analyzed before.
+int large(int x) {
+  int r = 0;
+  if (x == 1) r += 1;
+  if (x == 2) r += 2;
+  if (x == 3) r += 3;
+  if (x == 4) r += 4;
+  if (x == 5) r += 5;
+  if (x == 6) r += 6;
+  if (x == 7) r += 7;
+  if (x == 8) r += 8;
+  return r;
+}
+
+void use_large1(void) {
+  int *p = 0;
+  if (large(1) == 1)
+    *p = 1;
+}
+
+void use_large2(void) {
+  int *p = 0;
+  if (large(2) == 2)
+    *p = 2;
+}
+
+void use_large3(void) {
+  int *p = 0;
+  if (large(3) == 3)
+    *p = 3;
+}
+
+void use_large4(void) {
+  int *p = 0;
+  if (large(4) == 4)
+    *p = 4;
+}
+
+void use_large5(void) {
+  int *p = 0;
+  if (large(5) == 5)
+    *p = 5;
+}
+
+// A function whose summary is changed to not inlinable once an inlined call
+// to it runs into the block visit limit. The callers analyzed before that
+// inline it, the ones after it don't.
+int spin(int n) {
+  int i = 0;
+  while (i < n)
+    ++i;
+  return i;
+}
+
+void use_spin1(int n) {
+  int *p = 0;
+  if (spin(n) == 100)
+    *p = 1;
+}
+
+void use_spin2(int n) {
+  int *p = 0;
+  if (spin(n) == 200)
+    *p = 2;
+}
+
+void use_spin3(void) {
+  int *p = 0;
+  if (spin(2) == 2)
+    // CHECK-DAG: analysis-jobs-summaries.c:[[@LINE+1]]:{{[0-9]+}}: warning: Dereference of null pointer
+    *p = 3;
+}
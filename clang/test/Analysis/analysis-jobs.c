@@ -0,0 +1,41 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode -verify %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode -verify %s \
+// RUN:   -analyzer-config jobs=3
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode %s \
+// RUN:   -analyzer-output=plist -o %t.1.plist
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,deadcode %s \
+// RUN:   -analyzer-output=plist -o %t.3.plist -analyzer-config jobs=3
+// RUN: diff %t.1.plist %t.3.plist
+
+// The top-level functions are split between the threads in call graph order;
+// the diagnostics must not depend on which thread found them.
+
+void deref(int *p) {
+  *p = 1; // expected-warning {{Dereference of null pointer}}
+}
+
+void first(void) {
+  deref(0);
+}
+
+void second(void) {
+  int *p = 0;
+  *p = 2; // expected-warning {{Dereference of null pointer}}
+}
+
+int third(int x) {
+  int y = x; // expected-warning {{Value stored to 'y' during its initialization is never read}}
+  return 10 / (x - x); // expected-warning {{Division by zero}}
+}
+
+void fourth(int *p) {
+  if (p)
+    return;
+  deref(p);
+}
+
+void fifth(void) {
+  int *p = 0;
+  if (!p)
+    *p = 5; // expected-warning {{Dereference of null pointer}}
+}
@@ -45,6 +45,9 @@
 // RUN: %clang -fmodules-disable-diagnostic-validation -### %s 2>&1 | FileCheck -check-prefix=MODULES_DISABLE_DIAGNOSTIC_VALIDATION %s
 // MODULES_DISABLE_DIAGNOSTIC_VALIDATION: -fmodules-disable-diagnostic-validation
 
+// RUN: %clang -fmodules -fmodules-build-jobs=4 -### %s 2>&1 | FileCheck -check-prefix=MODULES_BUILD_JOBS %s
+// MODULES_BUILD_JOBS: "-fmodules-build-jobs=4"
+
 // RUN: %clang -fmodules -### %s 2>&1 | FileCheck -check-prefix=MODULES_PREBUILT_PATH_DEFAULT %s
 // MODULES_PREBUILT_PATH_DEFAULT-NOT: -fprebuilt-module-path
 
@@ -202,6 +202,15 @@
 // CHK-INT-HEADER: clang{{.*}} "-triple" "x86_64-unknown-linux-gnu" {{.*}} "-include" "[[INPUT1]]" "-dependency-filter" "[[INPUT1]]" {{.*}} "-o" "[[OUTPUT2:.+.o]]"
 // CHK-INT-HEADER: clang-offload-bundler{{.*}} "-type=o" "-targets=sycl-spir64-unknown-unknown-sycldevice,host-x86_64-unknown-linux-gnu" {{.*}} "-inputs=[[OUTPUT1]],[[OUTPUT2]]"
 
+/// Check -fparallel-offload-jobs=<n> is accepted and validated.
+// RUN: %clang -target x86_64-unknown-linux-gnu -fsycl -fparallel-offload-jobs=4 -c %s -### 2>&1 \
+// RUN:  | FileCheck %s -check-prefix=CHK-PARALLEL-JOBS
+// CHK-PARALLEL-JOBS-NOT: argument unused
+// CHK-PARALLEL-JOBS: clang-offload-bundler
+// RUN: %clang -target x86_64-unknown-linux-gnu -fsycl -fparallel-offload-jobs=0 -c %s -### 2>&1 \
+// RUN:  | FileCheck %s -check-prefix=CHK-PARALLEL-JOBS-INVALID
+// CHK-PARALLEL-JOBS-INVALID: invalid integral value '0' in '-fparallel-offload-jobs=0'
+
 /// ###########################################################################
 
 /// Check the phases also add a library to make sure it is treated as input by
@@ -0,0 +1,55 @@
+/// Check that -fparallel-offload-jobs runs the independent jobs of an
+/// offloading compilation at the same time, and that what the driver prints
+/// and returns is the same as for the sequential execution.
+// REQUIRES: x86-registered-target
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: cp %s %t/a.cpp
+// RUN: cp %s %t/b.cpp
+// RUN: echo '#ifdef __SYCL_DEVICE_ONLY__' > %t/bad.cpp
+// RUN: echo '#error device compilation failed' >> %t/bad.cpp
+// RUN: echo '#endif' >> %t/bad.cpp
+
+/// -### doesn't run anything, so it prints the jobs in the same order with and
+/// without the option: each input is compiled for the device, then for the
+/// host, and then bundled.
+// RUN: cd %t && %clangxx -target x86_64-unknown-linux-gnu -fsycl \
+// RUN:   -fno-integrated-cc1 -c a.cpp b.cpp -### 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-ORDER %s
+// RUN: cd %t && %clangxx -target x86_64-unknown-linux-gnu -fsycl \
+// RUN:   -fno-integrated-cc1 -fparallel-offload-jobs=4 -c a.cpp b.cpp -### 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-ORDER %s
+// CHK-ORDER: clang{{.*}} "-fsycl-is-device"{{.*}} "a.cpp"
+// CHK-ORDER: clang{{.*}} "-fsycl-is-host"{{.*}} "a.cpp"
+// CHK-ORDER: clang-offload-bundler{{.*}} "-outputs=a.o"
+// CHK-ORDER: clang{{.*}} "-fsycl-is-device"{{.*}} "b.cpp"
+// CHK-ORDER: clang{{.*}} "-fsycl-is-host"{{.*}} "b.cpp"
+// CHK-ORDER: clang-offload-bundler{{.*}} "-outputs=b.o"
+
+/// With -v, a command line is printed when its job starts. The device
+/// compilations of both inputs don't depend on anything, so they both start
+/// before any other job, while the sequential execution starts them in job
+/// order.
+// RUN: cd %t && rm -f a.o b.o && %clangxx -target x86_64-unknown-linux-gnu \
+// RUN:   -fsycl -fno-integrated-cc1 -fparallel-offload-jobs=4 -c a.cpp b.cpp \
+// RUN:   -v 2>&1 | FileCheck -check-prefix=CHK-PARALLEL %s
+// RUN: test -f %t/a.o && test -f %t/b.o
+// CHK-PARALLEL: clang{{.*}} "-fsycl-is-device"{{.*}} "a.cpp"
+// CHK-PARALLEL-NOT: "-fsycl-is-host"
+// CHK-PARALLEL: clang{{.*}} "-fsycl-is-device"{{.*}} "b.cpp"
+// CHK-PARALLEL-DAG: clang{{.*}} "-fsycl-is-host"{{.*}} "a.cpp"
+// CHK-PARALLEL-DAG: clang{{.*}} "-fsycl-is-host"{{.*}} "b.cpp"
+// CHK-PARALLEL-DAG: clang-offload-bundler{{.*}} "-outputs=a.o"
+// CHK-PARALLEL-DAG: clang-offload-bundler{{.*}} "-outputs=b.o"
+
+/// A failing job makes the driver fail, its diagnostics are printed once, and
+/// the input it belongs to is not bundled.
+// RUN: cd %t && rm -f a.o bad.o && not %clangxx \
+// RUN:   -target x86_64-unknown-linux-gnu -fsycl -fno-integrated-cc1 \
+// RUN:   -fparallel-offload-jobs=4 -c a.cpp bad.cpp 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHK-FAIL %s
+// RUN: not test -f %t/bad.o
+// CHK-FAIL: bad.cpp:2:2: error: device compilation failed
+// CHK-FAIL-NOT: error: device compilation failed
+
+void foo() {}
@@ -0,0 +1,32 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo '#include "B.h"' > %t/A.h
+// RUN: echo '#include "C.h"' >> %t/A.h
+// RUN: echo '#warning in B' > %t/B.h
+// RUN: echo '// C' > %t/C.h
+// RUN: echo 'module A { header "A.h" use B use C }' > %t/module.modulemap
+// RUN: echo 'module B { header "B.h" }' >> %t/module.modulemap
+// RUN: echo 'module C { header "C.h" }' >> %t/module.modulemap
+
+// The modules that A uses are built together before A.
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:            -fmodules-build-jobs=2 -fsyntax-only %s -I %t \
+// RUN:            -Rmodule-build 2>&1 | FileCheck %s
+
+// CHECK: building module 'B'
+// CHECK: building module 'C'
+// CHECK: warning: in B
+// CHECK: finished building module 'B'
+// CHECK: finished building module 'C'
+// CHECK: building module 'A'
+// CHECK-NOT: remark: building module
+// CHECK: finished building module 'A'
+
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:            -fmodules-build-jobs=2 -fsyntax-only %s -I %t \
+// RUN:            -Rmodule-build 2>&1 | FileCheck -allow-empty \
+// RUN:    -check-prefix=CACHED %s
+
+// CACHED-NOT: building module
+
+@import A;
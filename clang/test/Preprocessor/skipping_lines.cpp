@@ -0,0 +1,66 @@
+// RUN: %clang_cc1 -E -std=c++14 %s | FileCheck --strict-whitespace %s
+
+// Excluded blocks are skipped without lexing most of their lines; check that
+// directives hidden in comments and literals stay hidden, and that those after
+// them are still found.
+
+#if 0
+/* a block comment
+#endif
+*/ #else
+first
+#endif
+// CHECK: {{^}}first{{$}}
+
+#if 0
+int i = 1'000; /* digit separator, not a character literal
+#endif
+*/
+#else
+second
+#endif
+// CHECK: {{^}}second{{$}}
+
+#if 0
+const char *s = "/*";
+#else
+third
+#endif
+// CHECK: {{^}}third{{$}}
+
+#if 0
+const char *r = R"(
+#endif
+)";
+// a line comment that continues \
+#endif
+#else
+fourth
+#endif
+// CHECK: {{^}}fourth{{$}}
+
+#if 0
+x = 1; /* spanning
+*/ #endif
+  %:else
+fifth
+#endif
+// CHECK: {{^}}fifth{{$}}
+
+#if 0
+y = 2 \
+#endif
+#elif 1
+sixth
+#endif
+// CHECK: {{^}}sixth{{$}}
+
+#if 0
+a b c "d" e /* f
+#endif
+*/ g h 'i' j // k \
+#endif
+#else
+seventh
+#endif
+// CHECK: {{^}}seventh{{$}}
@@ -12,6 +12,7 @@
 #include "clang/Tooling/DependencyScanning/DependencyScanningTool.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
+#include "llvm/Support/CachePruning.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/InitLLVM.h"
@@ -160,6 +161,18 @@ llvm::cl::opt<bool> SkipExcludedPPRanges(
         "until reaching the end directive."),
     llvm::cl::init(true), llvm::cl::cat(DependencyScannerCategory));
 
+llvm::cl::opt<std::string> PersistentCachePath(
+    "persistent-cache-path",
+    llvm::cl::desc("Directory in which to cache minimized sources between "
+                   "runs. It can be shared by concurrent invocations."),
+    llvm::cl::cat(DependencyScannerCategory));
+
+llvm::cl::opt<std::string> PersistentCachePolicy(
+    "persistent-cache-policy",
+    llvm::cl::desc("Pruning policy for the persistent cache, in the format "
+                   "used by the ThinLTO cache."),
+    llvm::cl::cat(DependencyScannerCategory));
+
 llvm::cl::opt<bool> Verbose("v", llvm::cl::Optional,
                             llvm::cl::desc("Use verbose output."),
                             llvm::cl::init(false),
@@ -481,8 +494,19 @@ int main(int argc, const char **argv) {
   // Print out the dependency results to STDOUT by default.
   SharedStream DependencyOS(llvm::outs());
 
+  llvm::Optional<llvm::CachePruningPolicy> CachePolicy;
+  if (!PersistentCachePolicy.empty()) {
+    auto MaybePolicy = llvm::parseCachePruningPolicy(PersistentCachePolicy);
+    if (!MaybePolicy) {
+      llvm::errs() << "error: invalid persistent cache policy: "
+                   << llvm::toString(MaybePolicy.takeError()) << "\n";
+      return 1;
+    }
+    CachePolicy = *MaybePolicy;
+  }
+
   DependencyScanningService Service(ScanMode, Format, ReuseFileManager,
-                                    SkipExcludedPPRanges);
+                                    SkipExcludedPPRanges, PersistentCachePath);
   llvm::ThreadPool Pool(llvm::hardware_concurrency(NumThreads));
   std::vector<std::unique_ptr<DependencyScanningTool>> WorkerTools;
   for (unsigned I = 0; I < Pool.getThreadCount(); ++I)
@@ -540,6 +564,9 @@ int main(int argc, const char **argv) {
   }
   Pool.wait();
 
+  if (CachePolicy && !PersistentCachePath.empty())
+    llvm::pruneCache(PersistentCachePath, *CachePolicy);
+
   if (Format == ScanningOutputFormat::Full)
     FD.printFullOutput(llvm::outs());
 
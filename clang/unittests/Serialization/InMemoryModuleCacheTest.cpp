@@ -116,4 +116,60 @@ TEST(InMemoryModuleCacheTest, finalizePCM) {
   EXPECT_TRUE(Cache.isPCMFinal("B"));
 }
 
+TEST(InMemoryModuleCacheTest, concurrentBuilds) {
+  auto B1 = getBuffer(1);
+  auto B2 = getBuffer(2);
+  auto B3 = getBuffer(3);
+  auto B4 = getBuffer(4);
+  auto *RawB1 = B1.get();
+  auto *RawB2 = B2.get();
+  auto *RawB3 = B3.get();
+
+  InMemoryModuleCache Cache;
+  Cache.beginConcurrentBuilds();
+
+  // Another thread added the PCM first; its buffer is kept.
+  EXPECT_EQ(RawB1, &Cache.addPCM("B", std::move(B1)));
+  EXPECT_EQ(RawB1, &Cache.addPCM("B", getBuffer(5)));
+  EXPECT_EQ(InMemoryModuleCache::Tentative, Cache.getPCMState("B"));
+
+  // Dropping twice leaves the PCM to be built, and so does finalizing it.
+  EXPECT_FALSE(Cache.tryToDropPCM("B"));
+  EXPECT_FALSE(Cache.tryToDropPCM("B"));
+  Cache.finalizePCM("B");
+  EXPECT_EQ(InMemoryModuleCache::ToBuild, Cache.getPCMState("B"));
+
+  // A buffer read from disk after the drop doesn't resurrect the PCM.
+  EXPECT_EQ(RawB2, &Cache.addPCM("B", std::move(B2)));
+  EXPECT_EQ(InMemoryModuleCache::ToBuild, Cache.getPCMState("B"));
+  EXPECT_EQ(nullptr, Cache.lookupPCM("B"));
+
+  // The first build wins.
+  EXPECT_EQ(RawB3, &Cache.addBuiltPCM("B", std::move(B3)));
+  EXPECT_EQ(RawB3, &Cache.addBuiltPCM("B", std::move(B4)));
+  EXPECT_TRUE(Cache.isPCMFinal("B"));
+
+  // Building replaces a tentative PCM.
+  auto C1 = getBuffer(1);
+  auto C2 = getBuffer(2);
+  auto *RawC2 = C2.get();
+  Cache.addPCM("C", std::move(C1));
+  EXPECT_EQ(RawC2, &Cache.addBuiltPCM("C", std::move(C2)));
+  EXPECT_TRUE(Cache.isPCMFinal("C"));
+
+  Cache.endConcurrentBuilds();
+  EXPECT_EQ(RawB3, Cache.lookupPCM("B"));
+  EXPECT_EQ(RawC2, Cache.lookupPCM("C"));
+
+#if !defined(NDEBUG) && GTEST_HAS_DEATH_TEST
+  // The checks are back once the builds are done.
+  Cache.addPCM("D", getBuffer(1));
+  EXPECT_FALSE(Cache.tryToDropPCM("D"));
+  EXPECT_DEATH(Cache.addPCM("D", getBuffer(2)), "Already has a PCM");
+  EXPECT_DEATH(Cache.tryToDropPCM("D"),
+               "PCM to remove is scheduled to be built");
+  EXPECT_DEATH(Cache.finalizePCM("D"), "Trying to finalize a dropped PCM");
+#endif
+}
+
 } // namespace
@@ -14,8 +14,10 @@
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
@@ -203,5 +205,94 @@ TEST(DependencyScanner, ScanDepsReuseFilemanagerHasInclude) {
   EXPECT_EQ(convert_to_slash(Deps[5]), "/root/symlink.h");
 }
 
+TEST(DependencyScanner, PersistentCache) {
+  using namespace dependencies;
+  SmallString<128> CacheDir;
+  ASSERT_FALSE(
+      llvm::sys::fs::createUniqueDirectory("scan-deps-cache", CacheDir));
+  DependencyScanningPersistentCache PersistentCache(CacheDir);
+
+  auto VFS = llvm::makeIntrusiveRefCnt<llvm::vfs::InMemoryFileSystem>();
+  StringRef Contents = "#define FOO 1\n"
+                       "#if 0\n"
+                       "#include \"first.h\"\n"
+                       "#include \"second.h\"\n"
+                       "#endif\n"
+                       "int x;\n";
+  StringRef Minimized = "#define FOO 1\n"
+                        "#if 0\n"
+                        "#include \"first.h\"\n"
+                        "#include \"second.h\"\n"
+                        "#endif\n";
+  VFS->addFile("/root/header.h", 0, llvm::MemoryBuffer::getMemBuffer(Contents));
+  auto Stat = VFS->status("/root/header.h");
+  ASSERT_TRUE(Stat);
+  auto Hash = DependencyScanningPersistentCache::hashContents(Contents);
+
+  auto getMinimized = [&]() -> std::string {
+    DependencyScanningFilesystemSharedCache SharedCache;
+    DependencyScanningWorkerFilesystem DepFS(SharedCache, VFS, nullptr,
+                                             &PersistentCache);
+    auto File = DepFS.openFileForRead("/root/header.h");
+    if (!File)
+      return "<error>";
+    auto Buffer = (*File)->getBuffer("/root/header.h");
+    if (!Buffer)
+      return "<error>";
+    return (*Buffer)->getBuffer().str();
+  };
+
+  EXPECT_FALSE(PersistentCache.getContentHash(*Stat));
+  EXPECT_FALSE(PersistentCache.getMinimizedFile(Hash));
+  EXPECT_EQ(getMinimized(), Minimized);
+
+  // The minimized file is now on disk, along with the hash of the contents
+  // and the skipped ranges of the excluded block.
+  auto CachedHash = PersistentCache.getContentHash(*Stat);
+  ASSERT_TRUE(CachedHash);
+  EXPECT_EQ(*CachedHash, Hash);
+  auto CachedFile = PersistentCache.getMinimizedFile(Hash);
+  ASSERT_TRUE(CachedFile);
+  EXPECT_EQ(CachedFile->Contents, Minimized);
+  CachedFileSystemEntry Uncached =
+      CachedFileSystemEntry::createFileEntry("/root/header.h", *VFS);
+  EXPECT_FALSE(Uncached.getPPSkippedRangeMapping().empty());
+  EXPECT_EQ(CachedFile->Mapping, Uncached.getPPSkippedRangeMapping());
+
+  // The entry created from the cache has the same skipped ranges.
+  CachedFileSystemEntry FromCache = CachedFileSystemEntry::createFileEntry(
+      "/root/header.h", *VFS, /*Minimize=*/true, &PersistentCache);
+  EXPECT_EQ(FromCache.getPPSkippedRangeMapping(),
+            Uncached.getPPSkippedRangeMapping());
+
+  // A new scan with an empty in-memory cache is served from disk. Replace the
+  // cached minimized file so that minimizing the file again would be noticed.
+  DependencyScanningPersistentCache::MinimizedFile Replaced;
+  Replaced.Contents = "#define FOO 2\n";
+  PersistentCache.setMinimizedFile(Hash, Replaced);
+  EXPECT_EQ(getMinimized(), "#define FOO 2\n");
+
+  // The contents of an unchanged file are looked up by its status, without
+  // hashing them again.
+  auto OtherHash = DependencyScanningPersistentCache::hashContents("other");
+  Replaced.Contents = "#define BAR 1\n";
+  PersistentCache.setMinimizedFile(OtherHash, Replaced);
+  PersistentCache.setContentHash(*Stat, OtherHash);
+  EXPECT_EQ(getMinimized(), "#define BAR 1\n");
+
+  // Skipped ranges survive the round trip through the cache.
+  DependencyScanningPersistentCache::MinimizedFile WithRanges;
+  WithRanges.Contents = Minimized;
+  WithRanges.Mapping[3] = 40;
+  WithRanges.Mapping[100] = 0x12345678;
+  PersistentCache.setMinimizedFile(OtherHash, WithRanges);
+  CachedFile = PersistentCache.getMinimizedFile(OtherHash);
+  ASSERT_TRUE(CachedFile);
+  EXPECT_EQ(CachedFile->Contents, Minimized);
+  EXPECT_EQ(CachedFile->Mapping, WithRanges.Mapping);
+
+  llvm::sys::fs::remove_directories(CacheDir);
+}
+
 } // end namespace tooling
 } // end namespace clang
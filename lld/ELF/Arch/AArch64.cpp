@@ -33,6 +33,7 @@ public:
   AArch64();
   RelExpr getRelExpr(RelType type, const Symbol &s,
                      const uint8_t *loc) const override;
+  RelExpr getPlainRelExpr(RelType type) const override;
   RelType getDynRel(RelType type) const override;
   void writeGotPlt(uint8_t *buf, const Symbol &s) const override;
   void writePltHeader(uint8_t *buf) const override;
@@ -79,8 +80,7 @@ AArch64::AArch64() {
   needsThunks = true;
 }
 
-RelExpr AArch64::getRelExpr(RelType type, const Symbol &s,
-                            const uint8_t *loc) const {
+RelExpr AArch64::getPlainRelExpr(RelType type) const {
   switch (type) {
   case R_AARCH64_ABS16:
   case R_AARCH64_ABS32:
@@ -102,26 +102,6 @@ RelExpr AArch64::getRelExpr(RelType type, const Symbol &s,
   case R_AARCH64_MOVW_UABS_G2_NC:
   case R_AARCH64_MOVW_UABS_G3:
     return R_ABS;
-  case R_AARCH64_TLSDESC_ADR_PAGE21:
-    return R_AARCH64_TLSDESC_PAGE;
-  case R_AARCH64_TLSDESC_LD64_LO12:
-  case R_AARCH64_TLSDESC_ADD_LO12:
-    return R_TLSDESC;
-  case R_AARCH64_TLSDESC_CALL:
-    return R_TLSDESC_CALL;
-  case R_AARCH64_TLSLE_ADD_TPREL_HI12:
-  case R_AARCH64_TLSLE_ADD_TPREL_LO12_NC:
-  case R_AARCH64_TLSLE_LDST8_TPREL_LO12_NC:
-  case R_AARCH64_TLSLE_LDST16_TPREL_LO12_NC:
-  case R_AARCH64_TLSLE_LDST32_TPREL_LO12_NC:
-  case R_AARCH64_TLSLE_LDST64_TPREL_LO12_NC:
-  case R_AARCH64_TLSLE_LDST128_TPREL_LO12_NC:
-  case R_AARCH64_TLSLE_MOVW_TPREL_G0:
-  case R_AARCH64_TLSLE_MOVW_TPREL_G0_NC:
-  case R_AARCH64_TLSLE_MOVW_TPREL_G1:
-  case R_AARCH64_TLSLE_MOVW_TPREL_G1_NC:
-  case R_AARCH64_TLSLE_MOVW_TPREL_G2:
-    return R_TPREL;
   case R_AARCH64_CALL26:
   case R_AARCH64_CONDBR19:
   case R_AARCH64_JUMP26:
@@ -144,6 +124,38 @@ RelExpr AArch64::getRelExpr(RelType type, const Symbol &s,
   case R_AARCH64_ADR_PREL_PG_HI21:
   case R_AARCH64_ADR_PREL_PG_HI21_NC:
     return R_AARCH64_PAGE_PC;
+  default:
+    return R_NONE;
+  }
+}
+
+RelExpr AArch64::getRelExpr(RelType type, const Symbol &s,
+                            const uint8_t *loc) const {
+  RelExpr expr = getPlainRelExpr(type);
+  if (expr != R_NONE)
+    return expr;
+
+  switch (type) {
+  case R_AARCH64_TLSDESC_ADR_PAGE21:
+    return R_AARCH64_TLSDESC_PAGE;
+  case R_AARCH64_TLSDESC_LD64_LO12:
+  case R_AARCH64_TLSDESC_ADD_LO12:
+    return R_TLSDESC;
+  case R_AARCH64_TLSDESC_CALL:
+    return R_TLSDESC_CALL;
+  case R_AARCH64_TLSLE_ADD_TPREL_HI12:
+  case R_AARCH64_TLSLE_ADD_TPREL_LO12_NC:
+  case R_AARCH64_TLSLE_LDST8_TPREL_LO12_NC:
+  case R_AARCH64_TLSLE_LDST16_TPREL_LO12_NC:
+  case R_AARCH64_TLSLE_LDST32_TPREL_LO12_NC:
+  case R_AARCH64_TLSLE_LDST64_TPREL_LO12_NC:
+  case R_AARCH64_TLSLE_LDST128_TPREL_LO12_NC:
+  case R_AARCH64_TLSLE_MOVW_TPREL_G0:
+  case R_AARCH64_TLSLE_MOVW_TPREL_G0_NC:
+  case R_AARCH64_TLSLE_MOVW_TPREL_G1:
+  case R_AARCH64_TLSLE_MOVW_TPREL_G1_NC:
+  case R_AARCH64_TLSLE_MOVW_TPREL_G2:
+    return R_TPREL;
   case R_AARCH64_LD64_GOT_LO12_NC:
   case R_AARCH64_TLSIE_LD64_GOTTPREL_LO12_NC:
     return R_GOT;
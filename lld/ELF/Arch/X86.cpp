@@ -26,6 +26,7 @@ public:
   int getTlsGdRelaxSkip(RelType type) const override;
   RelExpr getRelExpr(RelType type, const Symbol &s,
                      const uint8_t *loc) const override;
+  RelExpr getPlainRelExpr(RelType type) const override;
   int64_t getImplicitAddend(const uint8_t *buf, RelType type) const override;
   void writeGotPltHeader(uint8_t *buf) const override;
   RelType getDynRel(RelType type) const override;
@@ -74,6 +75,23 @@ int X86::getTlsGdRelaxSkip(RelType type) const {
   return 2;
 }
 
+RelExpr X86::getPlainRelExpr(RelType type) const {
+  switch (type) {
+  case R_386_8:
+  case R_386_16:
+  case R_386_32:
+    return R_ABS;
+  case R_386_PLT32:
+    return R_PLT_PC;
+  case R_386_PC8:
+  case R_386_PC16:
+  case R_386_PC32:
+    return R_PC;
+  default:
+    return R_NONE;
+  }
+}
+
 RelExpr X86::getRelExpr(RelType type, const Symbol &s,
                         const uint8_t *loc) const {
   // There are 4 different TLS variable models with varying degrees of
@@ -84,23 +102,17 @@ RelExpr X86::getRelExpr(RelType type, const Symbol &s,
       type == R_386_TLS_GOTIE)
     config->hasStaticTlsModel = true;
 
+  RelExpr expr = getPlainRelExpr(type);
+  if (expr != R_NONE)
+    return expr;
+
   switch (type) {
-  case R_386_8:
-  case R_386_16:
-  case R_386_32:
-    return R_ABS;
   case R_386_TLS_LDO_32:
     return R_DTPREL;
   case R_386_TLS_GD:
     return R_TLSGD_GOTPLT;
   case R_386_TLS_LDM:
     return R_TLSLD_GOTPLT;
-  case R_386_PLT32:
-    return R_PLT_PC;
-  case R_386_PC8:
-  case R_386_PC16:
-  case R_386_PC32:
-    return R_PC;
   case R_386_GOTPC:
     return R_GOTPLTONLY_PC;
   case R_386_TLS_IE:
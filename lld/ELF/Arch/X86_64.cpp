@@ -29,6 +29,7 @@ public:
   int getTlsGdRelaxSkip(RelType type) const override;
   RelExpr getRelExpr(RelType type, const Symbol &s,
                      const uint8_t *loc) const override;
+  RelExpr getPlainRelExpr(RelType type) const override;
   RelType getDynRel(RelType type) const override;
   void writeGotPltHeader(uint8_t *buf) const override;
   void writeGotPlt(uint8_t *buf, const Symbol &s) const override;
@@ -308,11 +309,7 @@ bool X86_64::deleteFallThruJmpInsn(InputSection &is, InputFile *file,
   return true;
 }
 
-RelExpr X86_64::getRelExpr(RelType type, const Symbol &s,
-                           const uint8_t *loc) const {
-  if (type == R_X86_64_GOTTPOFF)
-    config->hasStaticTlsModel = true;
-
+RelExpr X86_64::getPlainRelExpr(RelType type) const {
   switch (type) {
   case R_X86_64_8:
   case R_X86_64_16:
@@ -320,6 +317,28 @@ RelExpr X86_64::getRelExpr(RelType type, const Symbol &s,
   case R_X86_64_32S:
   case R_X86_64_64:
     return R_ABS;
+  case R_X86_64_PLT32:
+    return R_PLT_PC;
+  case R_X86_64_PC8:
+  case R_X86_64_PC16:
+  case R_X86_64_PC32:
+  case R_X86_64_PC64:
+    return R_PC;
+  default:
+    return R_NONE;
+  }
+}
+
+RelExpr X86_64::getRelExpr(RelType type, const Symbol &s,
+                           const uint8_t *loc) const {
+  if (type == R_X86_64_GOTTPOFF)
+    config->hasStaticTlsModel = true;
+
+  RelExpr expr = getPlainRelExpr(type);
+  if (expr != R_NONE)
+    return expr;
+
+  switch (type) {
   case R_X86_64_DTPOFF32:
   case R_X86_64_DTPOFF64:
     return R_DTPREL;
@@ -334,13 +353,6 @@ RelExpr X86_64::getRelExpr(RelType type, const Symbol &s,
   case R_X86_64_SIZE32:
   case R_X86_64_SIZE64:
     return R_SIZE;
-  case R_X86_64_PLT32:
-    return R_PLT_PC;
-  case R_X86_64_PC8:
-  case R_X86_64_PC16:
-  case R_X86_64_PC32:
-  case R_X86_64_PC64:
-    return R_PC;
   case R_X86_64_GOT32:
   case R_X86_64_GOT64:
     return R_GOTPLT;
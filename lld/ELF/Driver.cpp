@@ -2188,6 +2188,13 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   if (errorCount())
     return;
 
+  // Symbol resolution is done, so the local symbols of the object files can be
+  // created independently of each other.
+  {
+    llvm::TimeTraceScope timeScope("Initialize local symbols");
+    parallelForEach(objectFiles, initializeLocalSymbols);
+  }
+
   // We want to declare linker script's symbols early,
   // so that we can version them.
   // They also might be exported if referenced by DSOs.
@@ -2229,6 +2236,7 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   // With this the symbol table should be complete. After this, no new names
   // except a few linker-synthesized ones will be added to the symbol table.
   compileBitcodeFiles<ELFT>();
+  parallelForEach(objectFiles, initializeLocalSymbols);
 
   // Handle --exclude-libs again because lto.tmp may reference additional
   // libcalls symbols defined in an excluded archive. This may override
@@ -1078,22 +1078,52 @@ StringRef ObjFile<ELFT>::getSectionName(const Elf_Shdr &sec) {
   return CHECK(getObj().getSectionName(sec, sectionStringTable), this);
 }
 
+// Creates the local symbol eSym in storage.
+template <class ELFT>
+Symbol *ObjFile<ELFT>::createLocalSymbol(const Elf_Sym &eSym, void *storage) {
+  uint32_t secIdx = getSectionIndex(eSym);
+  if (secIdx >= this->sections.size())
+    fatal(toString(this) + ": invalid section index: " + Twine(secIdx));
+  InputSectionBase *sec = this->sections[secIdx];
+  uint8_t type = eSym.getType();
+  if (this->stringTable.size() <= eSym.st_name)
+    fatal(toString(this) + ": invalid symbol name offset");
+  StringRefZ name = this->stringTable.data() + eSym.st_name;
+
+  if (eSym.st_shndx == SHN_UNDEF)
+    return new (storage)
+        Undefined(this, name, STB_LOCAL, eSym.st_other, type);
+  if (sec == &InputSection::discarded)
+    return new (storage) Undefined(this, name, STB_LOCAL, eSym.st_other, type,
+                                   /*discardedSecIdx=*/secIdx);
+  return new (storage) Defined(this, name, STB_LOCAL, eSym.st_other, type,
+                               eSym.st_value, eSym.st_size, sec);
+}
+
 // Initialize this->Symbols. this->Symbols is a parallel array as
 // its corresponding ELF symbol table.
 template <class ELFT> void ObjFile<ELFT>::initializeSymbols() {
   ArrayRef<Elf_Sym> eSyms = this->getELFSyms<ELFT>();
   this->symbols.resize(eSyms.size());
 
+  // Local symbols are not added to the symbol table because they are not
+  // visible from other object files. Those below firstGlobal are created later
+  // by initializeLocalSymbols(), which can run for many files in parallel, so
+  // only allocate memory for them here. The allocator is not thread-safe.
+  if (firstGlobal)
+    localSymbolStorage =
+        getSpecificAllocSingleton<SymbolUnion>().Allocate(firstGlobal);
+
   // Fill in InputFile::symbols. Some entries have been initialized
   // because of LazyObjFile.
   for (size_t i = 0, end = eSyms.size(); i != end; ++i) {
     if (this->symbols[i])
       continue;
     const Elf_Sym &eSym = eSyms[i];
-    uint32_t secIdx = getSectionIndex(eSym);
-    if (secIdx >= this->sections.size())
-      fatal(toString(this) + ": invalid section index: " + Twine(secIdx));
     if (eSym.getBinding() != STB_LOCAL) {
+      uint32_t secIdx = getSectionIndex(eSym);
+      if (secIdx >= this->sections.size())
+        fatal(toString(this) + ": invalid section index: " + Twine(secIdx));
       if (i < firstGlobal)
         error(toString(this) + ": non-local symbol (" + Twine(i) +
               ") found at index < .symtab's sh_info (" + Twine(firstGlobal) +
@@ -1103,32 +1133,17 @@ template <class ELFT> void ObjFile<ELFT>::initializeSymbols() {
       continue;
     }
 
-    // Handle local symbols. Local symbols are not added to the symbol
-    // table because they are not visible from other object files. We
-    // allocate symbol instances and add their pointers to symbols.
-    if (i >= firstGlobal)
-      errorOrWarn(toString(this) + ": STB_LOCAL symbol (" + Twine(i) +
-                  ") found at index >= .symtab's sh_info (" +
-                  Twine(firstGlobal) + ")");
-
-    InputSectionBase *sec = this->sections[secIdx];
-    uint8_t type = eSym.getType();
-    if (type == STT_FILE)
+    // STT_FILE names the file in diagnostics, which can be reported before
+    // the local symbols are created.
+    if (eSym.getType() == STT_FILE)
       sourceFile = CHECK(eSym.getName(this->stringTable), this);
-    if (this->stringTable.size() <= eSym.st_name)
-      fatal(toString(this) + ": invalid symbol name offset");
-    StringRefZ name = this->stringTable.data() + eSym.st_name;
+    if (i < firstGlobal)
+      continue;
 
-    if (eSym.st_shndx == SHN_UNDEF)
-      this->symbols[i] =
-          make<Undefined>(this, name, STB_LOCAL, eSym.st_other, type);
-    else if (sec == &InputSection::discarded)
-      this->symbols[i] =
-          make<Undefined>(this, name, STB_LOCAL, eSym.st_other, type,
-                          /*discardedSecIdx=*/secIdx);
-    else
-      this->symbols[i] = make<Defined>(this, name, STB_LOCAL, eSym.st_other,
-                                       type, eSym.st_value, eSym.st_size, sec);
+    errorOrWarn(toString(this) + ": STB_LOCAL symbol (" + Twine(i) +
+                ") found at index >= .symtab's sh_info (" + Twine(firstGlobal) +
+                ")");
+    this->symbols[i] = createLocalSymbol(eSym, make<SymbolUnion>());
   }
 
   // Symbol resolution of non-local symbols.
@@ -1212,6 +1227,37 @@ template <class ELFT> void ObjFile<ELFT>::initializeSymbols() {
   }
 }
 
+template <class ELFT> void ObjFile<ELFT>::initializeLocalSymbols() {
+  if (!localSymbolStorage)
+    return;
+  ArrayRef<Elf_Sym> eSyms = this->getELFSyms<ELFT>();
+  for (size_t i = 0; i != firstGlobal; ++i)
+    if (!this->symbols[i])
+      this->symbols[i] = createLocalSymbol(eSyms[i], &localSymbolStorage[i]);
+  localSymbolStorage = nullptr;
+}
+
+void elf::initializeLocalSymbols(InputFile *file) {
+  if (file->kind() != InputFile::ObjKind)
+    return;
+  switch (config->ekind) {
+  case ELF32LEKind:
+    cast<ObjFile<ELF32LE>>(file)->initializeLocalSymbols();
+    return;
+  case ELF32BEKind:
+    cast<ObjFile<ELF32BE>>(file)->initializeLocalSymbols();
+    return;
+  case ELF64LEKind:
+    cast<ObjFile<ELF64LE>>(file)->initializeLocalSymbols();
+    return;
+  case ELF64BEKind:
+    cast<ObjFile<ELF64BE>>(file)->initializeLocalSymbols();
+    return;
+  default:
+    llvm_unreachable("unknown ELFT");
+  }
+}
+
 ArchiveFile::ArchiveFile(std::unique_ptr<Archive> &&file)
     : InputFile(ArchiveKind, file->getMemoryBufferRef()),
       file(std::move(file)) {}
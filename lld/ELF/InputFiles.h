@@ -42,6 +42,7 @@ namespace elf {
 using llvm::object::Archive;
 
 class Symbol;
+union SymbolUnion;
 
 // If -reproduce option is given, all input files are written
 // to this tar archive.
@@ -53,6 +54,10 @@ llvm::Optional<MemoryBufferRef> readFile(StringRef path);
 // Add symbols in File to the symbol table.
 void parseFile(InputFile *file);
 
+// Create the local symbols of File if it is an object file. This is deferred
+// from parseFile() so that it can be done for many files in parallel.
+void initializeLocalSymbols(InputFile *file);
+
 // The root class of input files.
 class InputFile {
 public:
@@ -206,6 +211,7 @@ public:
   }
 
   void parse(bool ignoreComdats = false);
+  void initializeLocalSymbols();
 
   StringRef getShtGroupSignature(ArrayRef<Elf_Shdr> sections,
                                  const Elf_Shdr &sec);
@@ -259,6 +265,7 @@ private:
   void initializeSections(bool ignoreComdats);
   void initializeSymbols();
   void initializeJustSymbols();
+  Symbol *createLocalSymbol(const Elf_Sym &eSym, void *storage);
 
   InputSectionBase *getRelocTarget(const Elf_Shdr &sec);
   InputSectionBase *createInputSection(const Elf_Shdr &sec);
@@ -283,6 +290,10 @@ private:
   // .shstrtab contents.
   StringRef sectionStringTable;
 
+  // Memory for the local symbols below firstGlobal, allocated by parse() and
+  // filled in by initializeLocalSymbols(). Null once they have been created.
+  SymbolUnion *localSymbolStorage = nullptr;
+
   // Debugging information to retrieve source file and line for error
   // reporting. Linker may find reasonable number of errors in a
   // single object file, so we cache debugging information in order to
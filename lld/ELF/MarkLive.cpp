@@ -17,6 +17,10 @@
 // bits. Writer will then ignore sections whose Live bits are off, so that
 // such sections are not included into output.
 //
+// The traversal is done by multiple threads. Live bits are set atomically, so
+// each section is visited once, and the set of live sections doesn't depend on
+// the order in which they are found.
+//
 //===----------------------------------------------------------------------===//
 
 #include "MarkLive.h"
@@ -29,9 +33,12 @@
 #include "Target.h"
 #include "lld/Common/Memory.h"
 #include "lld/Common/Strings.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Object/ELF.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/TimeProfiler.h"
+#include <atomic>
 #include <functional>
 #include <vector>
 
@@ -51,12 +58,27 @@ public:
   void moveToMain();
 
 private:
-  void enqueue(InputSectionBase *sec, uint64_t offset);
+  // The state of one task of the mark phase.
+  struct Worklist {
+    // A list of sections to visit.
+    SmallVector<InputSection *, 0> queue;
+
+    // Symbols referenced from live sections and live pieces of mergeable
+    // sections. These share memory with other symbols and pieces, so they are
+    // updated after the traversal instead of by the tasks. Sets, because a
+    // symbol or piece is usually referenced by many relocations.
+    DenseSet<Symbol *> usedSymbols;
+    DenseSet<SectionPiece *> livePieces;
+  };
+
+  void enqueue(Worklist &wl, InputSectionBase *sec, uint64_t offset);
   void markSymbol(Symbol *sym);
   void mark();
+  void visit(Worklist &wl, InputSectionBase &sec);
 
   template <class RelTy>
-  void resolveReloc(InputSectionBase &sec, RelTy &rel, bool fromFDE);
+  void resolveReloc(Worklist &wl, InputSectionBase &sec, RelTy &rel,
+                    bool fromFDE);
 
   template <class RelTy>
   void scanEhFrameSection(EhInputSection &eh, ArrayRef<RelTy> rels);
@@ -64,8 +86,8 @@ private:
   // The index of the partition that we are currently processing.
   unsigned partition;
 
-  // A list of sections to visit.
-  SmallVector<InputSection *, 0> queue;
+  // The GC roots.
+  Worklist roots;
 
   // There are normally few input sections whose names are valid C
   // identifiers, so we just store a std::vector instead of a multimap.
@@ -88,12 +110,16 @@ static uint64_t getAddend(InputSectionBase &sec,
 
 template <class ELFT>
 template <class RelTy>
-void MarkLive<ELFT>::resolveReloc(InputSectionBase &sec, RelTy &rel,
-                                  bool fromFDE) {
+void MarkLive<ELFT>::resolveReloc(Worklist &wl, InputSectionBase &sec,
+                                  RelTy &rel, bool fromFDE) {
   Symbol &sym = sec.getFile<ELFT>()->getRelocTargetSym(rel);
 
-  // If a symbol is referenced in a live section, it is used.
-  sym.used = true;
+  // If a symbol is referenced in a live section, it is used. The flag is only
+  // read for undefined and shared symbols, and for local symbols that -r and
+  // --emit-relocs keep in the symbol table, so other symbols are not recorded.
+  if (!isa<Defined>(sym) || (config->copyRelocs && sym.isLocal()))
+    if (!sym.used || isa<SharedSymbol>(sym))
+      wl.usedSymbols.insert(&sym);
 
   if (auto *d = dyn_cast<Defined>(&sym)) {
     auto *relSec = dyn_cast_or_null<InputSectionBase>(d->section);
@@ -114,16 +140,12 @@ void MarkLive<ELFT>::resolveReloc(InputSectionBase &sec, RelTy &rel,
     // discarded, marking the LSDA will unnecessarily retain the text section.
     if (!(fromFDE && ((relSec->flags & (SHF_EXECINSTR | SHF_LINK_ORDER)) ||
                       relSec->nextInSectionGroup)))
-      enqueue(relSec, offset);
+      enqueue(wl, relSec, offset);
     return;
   }
 
-  if (auto *ss = dyn_cast<SharedSymbol>(&sym))
-    if (!ss->isWeak())
-      ss->getFile().isNeeded = true;
-
   for (InputSectionBase *sec : cNamedSections.lookup(sym.getName()))
-    enqueue(sec, 0);
+    enqueue(wl, sec, 0);
 }
 
 // The .eh_frame section is an unfortunate special case.
@@ -153,14 +175,14 @@ void MarkLive<ELFT>::scanEhFrameSection(EhInputSection &eh,
     if (read32<ELFT::TargetEndianness>(piece.data().data() + 4) == 0) {
       // This is a CIE, we only need to worry about the first relocation. It is
       // known to point to the personality function.
-      resolveReloc(eh, rels[firstRelI], false);
+      resolveReloc(roots, eh, rels[firstRelI], false);
       continue;
     }
 
     uint64_t pieceEnd = piece.inputOff + piece.size;
     for (size_t j = firstRelI, end2 = rels.size();
          j < end2 && rels[j].r_offset < pieceEnd; ++j)
-      resolveReloc(eh, rels[j], true);
+      resolveReloc(roots, eh, rels[j], true);
   }
 }
 
@@ -185,7 +207,8 @@ static bool isReserved(InputSectionBase *sec) {
 }
 
 template <class ELFT>
-void MarkLive<ELFT>::enqueue(InputSectionBase *sec, uint64_t offset) {
+void MarkLive<ELFT>::enqueue(Worklist &wl, InputSectionBase *sec,
+                             uint64_t offset) {
   // Skip over discarded sections. This in theory shouldn't happen, because
   // the ELF spec doesn't allow a relocation to point to a deduplicated
   // COMDAT section directly. Unfortunately this happens in practice (e.g.
@@ -196,25 +219,46 @@ void MarkLive<ELFT>::enqueue(InputSectionBase *sec, uint64_t offset) {
   // Usually, a whole section is marked as live or dead, but in mergeable
   // (splittable) sections, each piece of data has independent liveness bit.
   // So we explicitly tell it which offset is in use.
-  if (auto *ms = dyn_cast<MergeInputSection>(sec))
-    ms->getSectionPiece(offset)->live = true;
+  if (auto *ms = dyn_cast<MergeInputSection>(sec)) {
+    SectionPiece *piece = ms->getSectionPiece(offset);
+    if (!piece->live)
+      wl.livePieces.insert(piece);
+  }
 
   // Set Sec->Partition to the meet (i.e. the "minimum") of Partition and
   // Sec->Partition in the following lattice: 1 < other < 0. If Sec->Partition
-  // doesn't change, we don't need to do anything.
-  if (sec->partition == 1 || sec->partition == partition)
-    return;
-  sec->partition = sec->partition ? 1 : partition;
+  // doesn't change, we don't need to do anything. Other tasks may be updating
+  // it at the same time, so only the task whose update succeeds visits Sec.
+  //
+  // SectionBase::partition is a plain uint8_t because sections are copied
+  // (see copySectionsIntoPartitions), so it is accessed through a cast to
+  // std::atomic<uint8_t>. That is not sanctioned by the standard; it relies on
+  // std::atomic<uint8_t> being a lock-free wrapper with the size and alignment
+  // of uint8_t and no other state, which is how libstdc++, libc++ and the MSVC
+  // STL implement it, and on GCC, Clang and MSVC treating the byte as
+  // accessed atomically. All accesses during the traversal go through the cast.
+  static_assert(sizeof(std::atomic<uint8_t>) == sizeof(sec->partition) &&
+                    alignof(std::atomic<uint8_t>) == alignof(uint8_t),
+                "partition must be updatable atomically");
+  static_assert(ATOMIC_CHAR_LOCK_FREE == 2, "byte atomics must be lock-free");
+  auto &secPartition = *reinterpret_cast<std::atomic<uint8_t> *>(
+      &sec->partition);
+  uint8_t old = secPartition.load(std::memory_order_relaxed);
+  do {
+    if (old == 1 || old == partition)
+      return;
+  } while (!secPartition.compare_exchange_weak(old, old ? 1 : partition,
+                                               std::memory_order_relaxed));
 
   // Add input section to the queue.
   if (InputSection *s = dyn_cast<InputSection>(sec))
-    queue.push_back(s);
+    wl.queue.push_back(s);
 }
 
 template <class ELFT> void MarkLive<ELFT>::markSymbol(Symbol *sym) {
   if (auto *d = dyn_cast_or_null<Defined>(sym))
     if (auto *isec = dyn_cast_or_null<InputSectionBase>(d->section))
-      enqueue(isec, d->value);
+      enqueue(roots, isec, d->value);
 }
 
 // This is the main function of the garbage collector.
@@ -262,14 +306,14 @@ template <class ELFT> void MarkLive<ELFT>::run() {
     }
 
     if (sec->flags & SHF_GNU_RETAIN) {
-      enqueue(sec, 0);
+      enqueue(roots, sec, 0);
       continue;
     }
     if (sec->flags & SHF_LINK_ORDER)
       continue;
 
     if (isReserved(sec) || script->shouldKeep(sec)) {
-      enqueue(sec, 0);
+      enqueue(roots, sec, 0);
     } else if (!config->zStartStopGC && isValidCIdentifier(sec->name) &&
                !sec->nextInSectionGroup) {
       cNamedSections[saver.save("__start_" + sec->name)].push_back(sec);
@@ -280,25 +324,63 @@ template <class ELFT> void MarkLive<ELFT>::run() {
   mark();
 }
 
+template <class ELFT>
+void MarkLive<ELFT>::visit(Worklist &wl, InputSectionBase &sec) {
+  if (sec.areRelocsRela) {
+    for (const typename ELFT::Rela &rel : sec.template relas<ELFT>())
+      resolveReloc(wl, sec, rel, false);
+  } else {
+    for (const typename ELFT::Rel &rel : sec.template rels<ELFT>())
+      resolveReloc(wl, sec, rel, false);
+  }
+
+  for (InputSectionBase *isec : sec.dependentSections)
+    enqueue(wl, isec, 0);
+
+  // Mark the next group member.
+  if (sec.nextInSectionGroup)
+    enqueue(wl, sec.nextInSectionGroup, 0);
+}
+
 template <class ELFT> void MarkLive<ELFT>::mark() {
-  // Mark all reachable sections.
+  // Mark all reachable sections. This is done in rounds. A round splits the
+  // queued sections between tasks, and each task follows references from its
+  // sections depth-first until it has visited sectionsPerTask sections. What
+  // is left in the tasks' queues is split again in the next round.
+  const size_t maxTasks = 256;
+  const size_t sectionsPerTask = 1024;
+  std::vector<Worklist> lists(maxTasks);
+  SmallVector<InputSection *, 0> queue = std::move(roots.queue);
+  roots.queue.clear();
+
   while (!queue.empty()) {
-    InputSectionBase &sec = *queue.pop_back_val();
-
-    if (sec.areRelocsRela) {
-      for (const typename ELFT::Rela &rel : sec.template relas<ELFT>())
-        resolveReloc(sec, rel, false);
-    } else {
-      for (const typename ELFT::Rel &rel : sec.template rels<ELFT>())
-        resolveReloc(sec, rel, false);
+    size_t numTasks = std::min(queue.size(), maxTasks);
+    parallelForEachN(0, numTasks, [&](size_t i) {
+      Worklist &wl = lists[i];
+      for (size_t j = i; j < queue.size(); j += numTasks)
+        wl.queue.push_back(queue[j]);
+      for (size_t n = 0; n != sectionsPerTask && !wl.queue.empty(); ++n)
+        visit(wl, *wl.queue.pop_back_val());
+    });
+
+    queue.clear();
+    for (Worklist &wl : lists) {
+      queue.append(wl.queue.begin(), wl.queue.end());
+      wl.queue.clear();
     }
+  }
 
-    for (InputSectionBase *isec : sec.dependentSections)
-      enqueue(isec, 0);
-
-    // Mark the next group member.
-    if (sec.nextInSectionGroup)
-      enqueue(sec.nextInSectionGroup, 0);
+  lists.push_back(std::move(roots));
+  roots = Worklist();
+  for (Worklist &wl : lists) {
+    for (Symbol *sym : wl.usedSymbols) {
+      sym->used = true;
+      if (auto *ss = dyn_cast<SharedSymbol>(sym))
+        if (!ss->isWeak())
+          ss->getFile().isNeeded = true;
+    }
+    for (SectionPiece *piece : wl.livePieces)
+      piece->live = true;
   }
 }
 
@@ -324,7 +406,7 @@ template <class ELFT> void MarkLive<ELFT>::moveToMain() {
       continue;
     if (symtab->find(("__start_" + sec->name).str()) ||
         symtab->find(("__stop_" + sec->name).str()))
-      enqueue(sec, 0);
+      enqueue(roots, sec, 0);
   }
 
   mark();
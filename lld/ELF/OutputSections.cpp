@@ -295,15 +295,16 @@ template <class ELFT> void OutputSection::maybeCompress() {
   hdr->ch_size = size;
   hdr->ch_addralign = alignment;
 
-  // Write section contents to a temporary buffer and compress it.
+  // Write section contents to a temporary buffer and compress it. Sections
+  // larger than a chunk are split and their chunks are compressed in parallel.
   std::vector<uint8_t> buf(size);
   writeTo<ELFT>(buf.data());
   // We chose 1 as the default compression level because it is the fastest. If
   // -O2 is given, we use level 6 to compress debug info more by ~15%. We found
   // that level 7 to 9 doesn't make much difference (~1% more compression) while
   // they take significant amount of time (~2x), so level 6 seems enough.
-  if (Error e = zlib::compress(toStringRef(buf), compressedData,
-                               config->optimize >= 2 ? 6 : 1))
+  if (Error e = zlib::parallelCompress(toStringRef(buf), compressedData,
+                                       config->optimize >= 2 ? 6 : 1))
     fatal("compress failed: " + llvm::toString(std::move(e)));
 
   // Update section headers.
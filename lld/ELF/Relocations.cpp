@@ -55,6 +55,7 @@
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/Demangle/Demangle.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 
@@ -1284,6 +1285,36 @@ static void processRelocAux(InputSectionBase &sec, RelExpr expr, RelType type,
               getLocation(sec, sym, offset));
 }
 
+// Relax relocations.
+//
+// If we know that a PLT entry will be resolved within the same ELF module, we
+// can skip PLT access and directly jump to the destination function. For
+// example, if we are linking a main executable, all dynamic symbols that can
+// be resolved within the executable will actually be resolved that way at
+// runtime, because the main executable is always at the beginning of a search
+// list. We can leverage that fact.
+static RelExpr relaxExpr(RelExpr expr, RelType type, int64_t &addend,
+                         const Symbol &sym, const uint8_t *relocatedAddr) {
+  if (sym.isPreemptible || (sym.isGnuIFunc() && !config->zIfuncNoplt))
+    return expr;
+  if (expr == R_GOT_PC) {
+    if (!isAbsoluteValue(sym))
+      return target->adjustGotPcExpr(type, addend, relocatedAddr);
+    return expr;
+  }
+  // The 0x8000 bit of r_addend of R_PPC_PLTREL24 is used to choose call
+  // stub type. It should be ignored if optimized to R_PC.
+  if (config->emachine == EM_PPC && expr == R_PPC32_PLTREL)
+    addend &= ~0x8000;
+  // R_HEX_GD_PLT_B22_PCREL (call a@GDPLT) is transformed into
+  // call __tls_get_addr even if the symbol is non-preemptible.
+  if (config->emachine == EM_HEXAGON &&
+      (type == R_HEX_GD_PLT_B22_PCREL || type == R_HEX_GD_PLT_B22_PCREL_X ||
+       type == R_HEX_GD_PLT_B32_PCREL_X))
+    return expr;
+  return fromPlt(expr);
+}
+
 template <class ELFT, class RelTy>
 static void scanReloc(InputSectionBase &sec, OffsetGetter &getOffset, RelTy *&i,
                       RelTy *start, RelTy *end) {
@@ -1354,31 +1385,7 @@ static void scanReloc(InputSectionBase &sec, OffsetGetter &getOffset, RelTy *&i,
     }
   }
 
-  // Relax relocations.
-  //
-  // If we know that a PLT entry will be resolved within the same ELF module, we
-  // can skip PLT access and directly jump to the destination function. For
-  // example, if we are linking a main executable, all dynamic symbols that can
-  // be resolved within the executable will actually be resolved that way at
-  // runtime, because the main executable is always at the beginning of a search
-  // list. We can leverage that fact.
-  if (!sym.isPreemptible && (!sym.isGnuIFunc() || config->zIfuncNoplt)) {
-    if (expr != R_GOT_PC) {
-      // The 0x8000 bit of r_addend of R_PPC_PLTREL24 is used to choose call
-      // stub type. It should be ignored if optimized to R_PC.
-      if (config->emachine == EM_PPC && expr == R_PPC32_PLTREL)
-        addend &= ~0x8000;
-      // R_HEX_GD_PLT_B22_PCREL (call a@GDPLT) is transformed into
-      // call __tls_get_addr even if the symbol is non-preemptible.
-      if (!(config->emachine == EM_HEXAGON &&
-           (type == R_HEX_GD_PLT_B22_PCREL ||
-            type == R_HEX_GD_PLT_B22_PCREL_X ||
-            type == R_HEX_GD_PLT_B32_PCREL_X)))
-      expr = fromPlt(expr);
-    } else if (!isAbsoluteValue(sym)) {
-      expr = target->adjustGotPcExpr(type, addend, relocatedAddr);
-    }
-  }
+  expr = relaxExpr(expr, type, addend, sym, relocatedAddr);
 
   // If the relocation does not emit a GOT or GOTPLT entry but its computation
   // uses their addresses, we need GOT or GOTPLT to be created.
@@ -1566,6 +1573,17 @@ static void checkPPC64TLSRelax(InputSectionBase &sec, ArrayRef<RelTy> rels) {
   }
 }
 
+// Sort relocations by offset for more efficient searching for
+// R_RISCV_PCREL_HI20 and R_PPC64_ADDR64.
+static void sortRelocations(InputSectionBase &sec) {
+  if (config->emachine == EM_RISCV ||
+      (config->emachine == EM_PPC64 && sec.name == ".toc"))
+    llvm::stable_sort(sec.relocations,
+                      [](const Relocation &lhs, const Relocation &rhs) {
+                        return lhs.offset < rhs.offset;
+                      });
+}
+
 template <class ELFT, class RelTy>
 static void scanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels) {
   OffsetGetter getOffset(sec);
@@ -1579,23 +1597,153 @@ static void scanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels) {
   for (auto i = rels.begin(), end = rels.end(); i != end;)
     scanReloc<ELFT>(sec, getOffset, i, rels.begin(), end);
 
-  // Sort relocations by offset for more efficient searching for
-  // R_RISCV_PCREL_HI20 and R_PPC64_ADDR64.
-  if (config->emachine == EM_RISCV ||
-      (config->emachine == EM_PPC64 && sec.name == ".toc"))
-    llvm::stable_sort(sec.relocations,
-                      [](const Relocation &lhs, const Relocation &rhs) {
-                        return lhs.offset < rhs.offset;
-                      });
+  sortRelocations(sec);
 }
 
-template <class ELFT> void elf::scanRelocations(InputSectionBase &s) {
+namespace {
+// A relocation left to the serial part of scanRelocations().
+struct DeferredReloc {
+  // Index of the relocation in the relocation section.
+  uint32_t relIndex;
+  // Number of entries of InputSectionBase::relocations that precede it.
+  uint32_t pos;
+};
+} // namespace
+
+// Handles a relocation whose only effect is an entry in sec.relocations, i.e.
+// one that is a link-time constant and needs neither GOT/PLT entries, dynamic
+// relocations nor diagnostics. This touches no state other than sec's, so it
+// can run for many sections in parallel. Returns false if the relocation has
+// to go through scanReloc().
+template <class ELFT, class RelTy>
+static bool scanLocalReloc(InputSectionBase &sec, OffsetGetter &getOffset,
+                           const RelTy &rel, const RelTy *end) {
+  uint64_t offset = getOffset.get(rel.r_offset);
+  if (offset == uint64_t(-1))
+    return true;
+
+  // Undefined and shared symbols may need diagnostics, copy relocations or
+  // canonical PLT entries, and TLS and ifunc symbols have their own rules.
+  Symbol &sym =
+      sec.getFile<ELFT>()->getSymbol(rel.getSymbol(config->isMips64EL));
+  if (!isa<Defined>(sym) || sym.isTls() || sym.isGnuIFunc())
+    return false;
+
+  // getRelExpr() reports unknown relocation types, so only the types that
+  // the target classifies without diagnostics are handled here.
+  RelType type = rel.getType(config->isMips64EL);
+  RelExpr expr = target->getPlainRelExpr(type);
+  if (expr == R_NONE)
+    return false;
+  const uint8_t *relocatedAddr = sec.data().begin() + rel.r_offset;
+  int64_t addend = computeAddend<ELFT>(rel, end, sec, expr, sym.isLocal());
+  expr = relaxExpr(expr, type, addend, sym, relocatedAddr);
+
+  if (needsPlt(expr) || needsGot(expr) ||
+      oneof<R_GOTPLTONLY_PC, R_GOTPLTREL, R_GOTPLT, R_TLSGD_GOTPLT,
+            R_GOTONLY_PC, R_GOTREL, R_PPC64_TOCBASE, R_PPC64_RELAX_TOC,
+            R_TPREL, R_TPREL_NEG>(expr))
+    return false;
+  // isStaticLinkTimeConstant() reports this case as an error.
+  if (config->isPic && isRelExpr(expr) && isAbsoluteValue(sym))
+    return false;
+  if (!isStaticLinkTimeConstant(expr, type, sym, sec, offset))
+    return false;
+
+  sec.relocations.push_back({expr, type, offset, addend, &sym});
+  return true;
+}
+
+template <class ELFT, class RelTy>
+static void scanLocalRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels,
+                            std::vector<DeferredReloc> &deferred) {
+  OffsetGetter getOffset(sec);
+  sec.relocations.reserve(rels.size());
+
+  // A relaxed TLS relocation may consume the one that follows it (see
+  // getTlsGdRelaxSkip()), so that one is deferred as well.
+  bool afterTls = false;
+  for (size_t i = 0, e = rels.size(); i != e; ++i) {
+    const RelTy &rel = rels[i];
+    if (!afterTls && scanLocalReloc<ELFT>(sec, getOffset, rel, rels.end()))
+      continue;
+    deferred.push_back({uint32_t(i), uint32_t(sec.relocations.size())});
+    afterTls = sec.getFile<ELFT>()
+                   ->getSymbol(rel.getSymbol(config->isMips64EL))
+                   .isTls();
+  }
+}
+
+// Runs scanReloc() on the relocations deferred by scanLocalRelocs(), keeping
+// sec.relocations in relocation order.
+template <class ELFT, class RelTy>
+static void scanDeferredRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels,
+                               ArrayRef<DeferredReloc> deferred) {
+  SmallVector<Relocation, 0> local = std::move(sec.relocations);
+  sec.relocations.clear();
+  sec.relocations.reserve(local.size() + deferred.size());
+
+  OffsetGetter getOffset(sec);
+  auto i = rels.begin();
+  uint32_t pos = 0;
+  for (const DeferredReloc &d : deferred) {
+    sec.relocations.append(local.begin() + pos, local.begin() + d.pos);
+    pos = d.pos;
+    // Skip relocations consumed by the previous one.
+    if (rels.begin() + d.relIndex < i)
+      continue;
+    i = rels.begin() + d.relIndex;
+    scanReloc<ELFT>(sec, getOffset, i, rels.begin(), rels.end());
+  }
+  sec.relocations.append(local.begin() + pos, local.end());
+}
+
+template <class ELFT> static void scanRelocs(InputSectionBase &s) {
   if (s.areRelocsRela)
     scanRelocs<ELFT>(s, s.relas<ELFT>());
   else
     scanRelocs<ELFT>(s, s.rels<ELFT>());
 }
 
+template <class ELFT>
+void elf::scanRelocations(ArrayRef<InputSectionBase *> sections) {
+  // MIPS and PPC64 keep per-file state while scanning, and MIPS N32 combines
+  // consecutive relocations. Scan them serially.
+  if (config->emachine == EM_MIPS || config->emachine == EM_PPC64) {
+    for (InputSectionBase *sec : sections)
+      scanRelocs<ELFT>(*sec);
+    return;
+  }
+
+  // GOT and PLT entries and dynamic relocations are created in the order
+  // relocations are visited, and so are undefined symbol diagnostics. To keep
+  // the output independent of the number of threads, first resolve the
+  // relocations that affect only their own section in parallel, then visit
+  // the rest serially in input order.
+  std::vector<std::vector<DeferredReloc>> deferred(sections.size());
+  parallelForEachN(0, sections.size(), [&](size_t i) {
+    InputSectionBase &sec = *sections[i];
+    if (sec.areRelocsRela)
+      scanLocalRelocs<ELFT>(sec, sec.relas<ELFT>(), deferred[i]);
+    else
+      scanLocalRelocs<ELFT>(sec, sec.rels<ELFT>(), deferred[i]);
+  });
+
+  for (size_t i = 0, e = sections.size(); i != e; ++i) {
+    if (deferred[i].empty())
+      continue;
+    InputSectionBase &sec = *sections[i];
+    if (sec.areRelocsRela)
+      scanDeferredRelocs<ELFT>(sec, sec.relas<ELFT>(), deferred[i]);
+    else
+      scanDeferredRelocs<ELFT>(sec, sec.rels<ELFT>(), deferred[i]);
+  }
+
+  parallelForEach(sections, [](InputSectionBase *sec) {
+    sortRelocations(*sec);
+  });
+}
+
 static bool mergeCmp(const InputSection *a, const InputSection *b) {
   // std::merge requires a strict weak ordering.
   if (a->outSecOff < b->outSecOff)
@@ -2115,10 +2263,10 @@ void elf::hexagonTLSSymbolUpdate(ArrayRef<OutputSection *> outputSections) {
       });
 }
 
-template void elf::scanRelocations<ELF32LE>(InputSectionBase &);
-template void elf::scanRelocations<ELF32BE>(InputSectionBase &);
-template void elf::scanRelocations<ELF64LE>(InputSectionBase &);
-template void elf::scanRelocations<ELF64BE>(InputSectionBase &);
+template void elf::scanRelocations<ELF32LE>(ArrayRef<InputSectionBase *>);
+template void elf::scanRelocations<ELF32BE>(ArrayRef<InputSectionBase *>);
+template void elf::scanRelocations<ELF64LE>(ArrayRef<InputSectionBase *>);
+template void elf::scanRelocations<ELF64BE>(ArrayRef<InputSectionBase *>);
 template void elf::reportUndefinedSymbols<ELF32LE>();
 template void elf::reportUndefinedSymbols<ELF32BE>();
 template void elf::reportUndefinedSymbols<ELF64LE>();
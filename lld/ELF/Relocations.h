@@ -122,8 +122,10 @@ struct JumpInstrMod {
 
 // This function writes undefined symbol diagnostics to an internal buffer.
 // Call reportUndefinedSymbols() after calling scanRelocations() to emit
-// the diagnostics.
-template <class ELFT> void scanRelocations(InputSectionBase &);
+// the diagnostics. Sections are processed in parallel, but the result is the
+// same as scanning them one by one in the given order.
+template <class ELFT>
+void scanRelocations(ArrayRef<InputSectionBase *> sections);
 
 template <class ELFT> void reportUndefinedSymbols();
 
@@ -633,7 +633,11 @@ static void reportDuplicate(Symbol *sym, InputFile *newFile,
   //   >>>            bar.o (/home/alice/src/bar.o)
   //   >>> defined at baz.c:563
   //   >>>            baz.o in archive libbaz.a
+  // The messages look for STT_FILE and enclosing function symbols, which may
+  // not have been created yet.
   auto *sec1 = cast<InputSectionBase>(d->section);
+  initializeLocalSymbols(sec1->file);
+  initializeLocalSymbols(errSec->file);
   std::string src1 = sec1->getSrcMsg(*sym, d->value);
   std::string obj1 = sec1->getObjMsg(d->value);
   std::string src2 = errSec->getSrcMsg(*sym, errOffset);
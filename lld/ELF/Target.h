@@ -28,6 +28,12 @@ public:
   virtual uint32_t calcEFlags() const { return 0; }
   virtual RelExpr getRelExpr(RelType type, const Symbol &s,
                              const uint8_t *loc) const = 0;
+  // Returns what getRelExpr() returns for a relocation type that doesn't
+  // depend on the symbol or the relocated bytes, or R_NONE. Unlike
+  // getRelExpr(), this reports no diagnostics and has no side effects, so
+  // that relocations can be scanned in parallel. The relocations of other
+  // types are scanned serially.
+  virtual RelExpr getPlainRelExpr(RelType type) const { return R_NONE; }
   virtual RelType getDynRel(RelType type) const { return 0; }
   virtual void writeGotPltHeader(uint8_t *buf) const {}
   virtual void writeGotHeader(uint8_t *buf) const {}
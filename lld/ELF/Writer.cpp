@@ -1995,7 +1995,9 @@ template <class ELFT> void Writer<ELFT>::finalizeSections() {
     // a linker-script-defined symbol is absolute.
     ppc64noTocRelax.clear();
     if (!config->relocatable) {
-      forEachRelSec(scanRelocations<ELFT>);
+      std::vector<InputSectionBase *> sections;
+      forEachRelSec([&](InputSectionBase &sec) { sections.push_back(&sec); });
+      scanRelocations<ELFT>(sections);
       reportUndefinedSymbols<ELFT>();
     }
   }
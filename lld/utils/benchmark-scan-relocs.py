@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""Benchmark relocation scanning in ld.lld on a generated large input set.
+
+This generates x86-64 assembly files with many functions, assembles them with
+llvm-mc and links the objects into a PIE or a shared object with ld.lld, once
+for each requested thread count. Most relocations are calls and data
+references to defined symbols, which are scanned in parallel; the rest need
+GOT or PLT entries or dynamic relocations, and are scanned serially. With
+--shared, the generated symbols are hidden, as they would otherwise be
+preemptible and almost every relocation would be scanned serially. The
+outputs of all thread counts must be identical, and the script fails if they
+are not.
+
+Typical use:
+
+  benchmark-scan-relocs.py --bin-dir build/bin --threads 1,4,16
+
+The time of each link is the median of several runs. With --time-trace, the
+time of the "Scan relocations" phase reported by ld.lld is printed as well.
+"""
+
+import argparse
+import filecmp
+import json
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def log(msg):
+    print(msg, file=sys.stderr)
+    sys.stderr.flush()
+
+
+def tool_path(bin_dir, tool):
+    exe = tool + ('.exe' if sys.platform == 'win32' else '')
+    path = os.path.abspath(os.path.join(bin_dir, exe))
+    if not os.path.exists(path):
+        sys.exit('error: {} not found in {}'.format(exe, bin_dir))
+    return path
+
+
+def write_file(args, index, path):
+    """Writes one input file with args.functions functions.
+
+    Each function calls the functions of the next file and refers to their
+    data, so the relocations cross input sections. Every tenth function also
+    refers to an undefined function and a shared variable, which go through
+    the PLT and the GOT. With --shared, the functions and data are hidden so
+    that references to them are not preemptible.
+    """
+    next_file = (index + 1) % args.files
+    lines = []
+    for f in range(args.functions):
+        name = 'f{}_{}'.format(index, f)
+        callee = 'f{}_{}'.format(next_file, (f + 1) % args.functions)
+        data = 'd{}_{}'.format(next_file, f)
+        lines += [
+            '.section .text.{0},"ax",@progbits'.format(name),
+            '.globl {0}'.format(name),
+            '.type {0},@function'.format(name),
+        ]
+        if args.shared:
+            lines += ['.hidden {0}'.format(name)]
+        lines += ['{0}:'.format(name)]
+        for _ in range(args.calls):
+            lines += [
+                '  call {0}'.format(callee),
+                '  leaq {0}(%rip), %rax'.format(data),
+                '  movl {0}+4(%rip), %ecx'.format(data),
+            ]
+        if f % 10 == 0:
+            lines += [
+                '  call ext_{0}@PLT'.format(f % 100),
+                '  movq ext_var_{0}@GOTPCREL(%rip), %rax'.format(f % 100),
+            ]
+        lines += ['  ret', '.size {0}, .-{0}'.format(name)]
+        lines += [
+            '.section .data.d{0}_{1},"aw",@progbits'.format(index, f),
+            '.globl d{0}_{1}'.format(index, f),
+        ]
+        if args.shared:
+            lines += ['.hidden d{0}_{1}'.format(index, f)]
+        lines += [
+            'd{0}_{1}:'.format(index, f),
+            '  .quad {0}'.format(callee),
+            '  .quad {0}'.format(data),
+            '  .long {0} - .'.format(callee),
+            '  .long 0',
+        ]
+    with open(path, 'w') as out:
+        out.write('\n'.join(lines) + '\n')
+
+
+def write_shared(path):
+    """Writes the shared object that defines the external symbols."""
+    lines = []
+    for i in range(100):
+        lines += [
+            '.text', '.globl ext_{0}'.format(i),
+            '.type ext_{0},@function'.format(i), 'ext_{0}:'.format(i), '  ret',
+            '.data', '.globl ext_var_{0}'.format(i),
+            '.type ext_var_{0},@object'.format(i), 'ext_var_{0}:'.format(i),
+            '  .quad 0', '.size ext_var_{0}, 8'.format(i),
+        ]
+    with open(path, 'w') as out:
+        out.write('\n'.join(lines) + '\n')
+
+
+def assemble(llvm_mc, src, obj):
+    subprocess.check_call([llvm_mc, '-filetype=obj',
+                           '-triple=x86_64-unknown-linux', src, '-o', obj])
+
+
+def scan_time(trace_file):
+    with open(trace_file) as f:
+        events = json.load(f)['traceEvents']
+    return sum(e['dur'] for e in events
+               if e.get('ph') == 'X' and e.get('name') == 'Scan relocations')
+
+
+def link(lld, args, objs, threads, output):
+    cmd = [lld, '--threads={}'.format(threads), '-o', output] + objs
+    cmd += ['-shared'] if args.shared else ['-pie', '-e', 'f0_0']
+    if args.time_trace:
+        cmd += ['--time-trace', '--time-trace-file=' + output + '.json']
+    wall, scan = [], []
+    for _ in range(args.runs):
+        start = time.perf_counter()
+        subprocess.check_call(cmd)
+        wall.append((time.perf_counter() - start) * 1000)
+        if args.time_trace:
+            scan.append(scan_time(output + '.json') / 1000)
+    return statistics.median(wall), scan and statistics.median(scan)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--bin-dir', required=True,
+                        help='directory containing ld.lld and llvm-mc')
+    parser.add_argument('--threads', default='1,{}'.format(os.cpu_count()),
+                        help='comma-separated thread counts to compare')
+    parser.add_argument('--files', type=int, default=200,
+                        help='number of input files')
+    parser.add_argument('--functions', type=int, default=500,
+                        help='number of functions per input file')
+    parser.add_argument('--calls', type=int, default=20,
+                        help='number of call sites per function')
+    parser.add_argument('--runs', type=int, default=5,
+                        help='number of links per thread count')
+    parser.add_argument('--shared', action='store_true',
+                        help='link a shared object instead of a PIE')
+    parser.add_argument('--time-trace', action='store_true',
+                        help='report the time of the scan phase')
+    parser.add_argument('--keep', metavar='DIR',
+                        help='generate the inputs in DIR and keep them')
+    args = parser.parse_args()
+
+    lld = tool_path(args.bin_dir, 'ld.lld')
+    llvm_mc = tool_path(args.bin_dir, 'llvm-mc')
+    thread_counts = [int(t) for t in args.threads.split(',')]
+
+    work_dir = args.keep or tempfile.mkdtemp(prefix='scan-relocs-')
+    os.makedirs(work_dir, exist_ok=True)
+    try:
+        log('Generating {} files with {} functions each in {}'.format(
+            args.files, args.functions, work_dir))
+        objs = []
+        for i in range(args.files):
+            src = os.path.join(work_dir, 'in{}.s'.format(i))
+            obj = os.path.join(work_dir, 'in{}.o'.format(i))
+            write_file(args, i, src)
+            assemble(llvm_mc, src, obj)
+            objs.append(obj)
+
+        shared_src = os.path.join(work_dir, 'ext.s')
+        shared_obj = os.path.join(work_dir, 'ext.o')
+        shared_lib = os.path.join(work_dir, 'libext.so')
+        write_shared(shared_src)
+        assemble(llvm_mc, shared_src, shared_obj)
+        subprocess.check_call([lld, '-shared', shared_obj, '-o', shared_lib])
+        objs.append(shared_lib)
+
+        outputs = []
+        print('{:>8} {:>12} {:>12}'.format('threads', 'link (ms)',
+                                           'scan (ms)'))
+        for threads in thread_counts:
+            output = os.path.join(work_dir, 'out.{}'.format(threads))
+            wall, scan = link(lld, args, objs, threads, output)
+            scan_str = '{:12.1f}'.format(scan) if args.time_trace else ''
+            print('{:>8} {:12.1f} {:>12}'.format(threads, wall, scan_str))
+            outputs.append(output)
+
+        for output in outputs[1:]:
+            if not filecmp.cmp(outputs[0], output, shallow=False):
+                sys.exit('error: {} differs from {}'.format(output,
+                                                            outputs[0]))
+    finally:
+        if not args.keep:
+            shutil.rmtree(work_dir)
+
+
+if __name__ == '__main__':
+    main()
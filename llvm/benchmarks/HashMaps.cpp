@@ -0,0 +1,95 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SwissTableMap.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+// Pointer keys spread like heap allocated IR objects, which is how most hot
+// compiler maps are keyed (Value *, const SCEV *, MCSymbol *, ...).
+static std::vector<int *> makeKeys(size_t N) {
+  static std::unique_ptr<int[]> Storage;
+  static size_t StorageSize = 0;
+  if (StorageSize < N * 4) {
+    StorageSize = N * 4;
+    Storage.reset(new int[StorageSize]);
+  }
+  std::vector<int *> Keys;
+  for (size_t I = 0; I != N; ++I)
+    Keys.push_back(&Storage[I * 4]);
+  std::shuffle(Keys.begin(), Keys.end(), std::mt19937(42));
+  return Keys;
+}
+
+template <typename MapT> static void BM_Insert(benchmark::State &State) {
+  std::vector<int *> Keys = makeKeys(State.range(0));
+  for (auto _ : State) {
+    MapT Map;
+    for (int *K : Keys)
+      Map[K] = 1;
+    benchmark::DoNotOptimize(Map.size());
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+
+template <typename MapT> static void BM_LookupHit(benchmark::State &State) {
+  std::vector<int *> Keys = makeKeys(State.range(0));
+  MapT Map;
+  for (int *K : Keys)
+    Map[K] = 1;
+  for (auto _ : State) {
+    unsigned Sum = 0;
+    for (int *K : Keys)
+      Sum += Map.lookup(K);
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+
+template <typename MapT> static void BM_LookupMiss(benchmark::State &State) {
+  std::vector<int *> Keys = makeKeys(State.range(0) * 2);
+  MapT Map;
+  for (size_t I = 0, E = Keys.size() / 2; I != E; ++I)
+    Map[Keys[I]] = 1;
+  for (auto _ : State) {
+    unsigned Sum = 0;
+    for (size_t I = Keys.size() / 2, E = Keys.size(); I != E; ++I)
+      Sum += Map.count(Keys[I]);
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * (Keys.size() / 2));
+}
+
+// Insert and erase in a sliding window, the pattern of maps caching analysis
+// results that are invalidated as the IR is rewritten.
+template <typename MapT> static void BM_EraseChurn(benchmark::State &State) {
+  std::vector<int *> Keys = makeKeys(State.range(0) * 4);
+  size_t Window = State.range(0);
+  for (auto _ : State) {
+    MapT Map;
+    for (size_t I = 0, E = Keys.size(); I != E; ++I) {
+      Map[Keys[I]] = 1;
+      if (I >= Window)
+        Map.erase(Keys[I - Window]);
+    }
+    benchmark::DoNotOptimize(Map.size());
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+
+using DenseMapT = DenseMap<int *, unsigned>;
+using SwissTableMapT = SwissTableMap<int *, unsigned>;
+
+BENCHMARK_TEMPLATE(BM_Insert, DenseMapT)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Insert, SwissTableMapT)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_LookupHit, DenseMapT)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_LookupHit, SwissTableMapT)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_LookupMiss, DenseMapT)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_LookupMiss, SwissTableMapT)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_EraseChurn, DenseMapT)->Range(64, 1 << 18);
+BENCHMARK_TEMPLATE(BM_EraseChurn, SwissTableMapT)->Range(64, 1 << 18);
+
+BENCHMARK_MAIN();
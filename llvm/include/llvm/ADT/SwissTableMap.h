@@ -0,0 +1,748 @@
+//===- llvm/ADT/SwissTableMap.h - Group probed hash table -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the SwissTableMap class, an open addressing hash table
+// with the same interface as DenseMap that keeps one byte of metadata per
+// bucket and probes buckets in groups.
+//
+// Each bucket has a control byte that is either Empty, Deleted, or holds the
+// 7 bits of the key's hash. A lookup loads the control bytes of a whole
+// group of buckets at once and compares them against the hash bits with a few
+// vector instructions, so that isEqual is only called for likely candidates.
+// The probe stops at the first group containing an Empty bucket.
+//
+// Unlike DenseMap, SwissTableMap does not reserve any key value: KeyInfoT only
+// needs to provide getHashValue and isEqual. Erased buckets are turned back
+// into Empty buckets whenever that cannot break a probe sequence, so tables
+// with heavy insert/erase churn do not accumulate tombstones as quickly.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_SWISSTABLEMAP_H
+#define LLVM_ADT_SWISSTABLEMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/EpochTracker.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemAlloc.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace llvm {
+
+namespace detail {
+
+/// The control bytes of a group of consecutive buckets, and the bit masks of
+/// the buckets in that group satisfying some property. Bit I of a mask
+/// corresponds to the I-th bucket of the group.
+class SwissTableGroup {
+public:
+  enum : unsigned { Width = 16 };
+  enum : int8_t { Empty = -128, Deleted = -2 };
+
+  explicit SwissTableGroup(const int8_t *Ctrl) {
+#ifdef __SSE2__
+    Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ctrl));
+#else
+    std::memcpy(Bytes, Ctrl, Width);
+#endif
+  }
+
+  /// \returns the buckets whose control byte is \p Byte.
+  uint32_t match(int8_t Byte) const {
+#ifdef __SSE2__
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(Byte), Bytes));
+#else
+    uint32_t Mask = 0;
+    for (unsigned I = 0; I != Width; ++I)
+      Mask |= uint32_t(Bytes[I] == Byte) << I;
+    return Mask;
+#endif
+  }
+
+  /// \returns the buckets that are Empty.
+  uint32_t matchEmpty() const { return match(Empty); }
+
+  /// \returns the buckets that are either Empty or Deleted, i.e. whose
+  /// control byte has its sign bit set.
+  uint32_t matchEmptyOrDeleted() const {
+#ifdef __SSE2__
+    return _mm_movemask_epi8(Bytes);
+#else
+    uint32_t Mask = 0;
+    for (unsigned I = 0; I != Width; ++I)
+      Mask |= uint32_t(Bytes[I] < 0) << I;
+    return Mask;
+#endif
+  }
+
+private:
+#ifdef __SSE2__
+  __m128i Bytes;
+#else
+  int8_t Bytes[Width];
+#endif
+};
+
+} // end namespace detail
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT,
+          bool IsConst = false>
+class SwissTableMapIterator;
+
+/// An open addressing hash table with the same interface as DenseMap, using
+/// per-bucket control bytes and group probing. See the file comment for
+/// details.
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>,
+          typename BucketT = llvm::detail::DenseMapPair<KeyT, ValueT>>
+class SwissTableMap : public DebugEpochBase {
+  template <typename T>
+  using const_arg_type_t = typename const_pointer_or_const_ref<T>::type;
+  using Group = detail::SwissTableGroup;
+
+public:
+  using size_type = unsigned;
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using value_type = BucketT;
+
+  using iterator = SwissTableMapIterator<KeyT, ValueT, KeyInfoT, BucketT>;
+  using const_iterator =
+      SwissTableMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>;
+
+  /// Create a SwissTableMap with space for at least \p InitialReserve
+  /// elements without growing.
+  explicit SwissTableMap(unsigned InitialReserve = 0) {
+    init(getMinBucketToReserveForEntries(InitialReserve));
+  }
+
+  SwissTableMap(const SwissTableMap &Other) { copyFrom(Other); }
+
+  SwissTableMap(SwissTableMap &&Other) {
+    init(0);
+    swap(Other);
+  }
+
+  template <typename InputIt>
+  SwissTableMap(const InputIt &I, const InputIt &E) {
+    init(getMinBucketToReserveForEntries(std::distance(I, E)));
+    insert(I, E);
+  }
+
+  SwissTableMap(std::initializer_list<value_type> Vals) {
+    init(getMinBucketToReserveForEntries(Vals.size()));
+    insert(Vals.begin(), Vals.end());
+  }
+
+  ~SwissTableMap() {
+    destroyAll();
+    deallocateBuckets();
+  }
+
+  SwissTableMap &operator=(const SwissTableMap &Other) {
+    if (&Other != this)
+      copyFrom(Other);
+    return *this;
+  }
+
+  SwissTableMap &operator=(SwissTableMap &&Other) {
+    destroyAll();
+    deallocateBuckets();
+    init(0);
+    swap(Other);
+    return *this;
+  }
+
+  void swap(SwissTableMap &RHS) {
+    this->incrementEpoch();
+    RHS.incrementEpoch();
+    std::swap(Buckets, RHS.Buckets);
+    std::swap(Ctrl, RHS.Ctrl);
+    std::swap(NumEntries, RHS.NumEntries);
+    std::swap(NumBuckets, RHS.NumBuckets);
+    std::swap(GrowthLeft, RHS.GrowthLeft);
+  }
+
+  inline iterator begin() {
+    if (empty())
+      return end();
+    return iterator(Buckets, Ctrl, Ctrl + NumBuckets, *this);
+  }
+  inline iterator end() {
+    return iterator(Buckets + NumBuckets, Ctrl + NumBuckets, Ctrl + NumBuckets,
+                    *this, true);
+  }
+  inline const_iterator begin() const {
+    if (empty())
+      return end();
+    return const_iterator(Buckets, Ctrl, Ctrl + NumBuckets, *this);
+  }
+  inline const_iterator end() const {
+    return const_iterator(Buckets + NumBuckets, Ctrl + NumBuckets,
+                          Ctrl + NumBuckets, *this, true);
+  }
+
+  LLVM_NODISCARD bool empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the map so that it can contain at least \p NumEntries items before
+  /// resizing again.
+  void reserve(size_type NumEntries) {
+    unsigned NewNumBuckets = getMinBucketToReserveForEntries(NumEntries);
+    incrementEpoch();
+    if (NewNumBuckets > NumBuckets)
+      rehash(NewNumBuckets);
+  }
+
+  void clear() {
+    incrementEpoch();
+    if (NumEntries == 0 && GrowthLeft == getMaxLoad(NumBuckets))
+      return;
+
+    // If the capacity of the array is huge, and the # elements used is small,
+    // shrink the array.
+    if (NumEntries * 4 < NumBuckets && NumBuckets > 64) {
+      shrink_and_clear();
+      return;
+    }
+
+    destroyAll();
+    resetCtrl();
+  }
+
+  void shrink_and_clear() {
+    unsigned OldNumEntries = NumEntries;
+    destroyAll();
+
+    // Reduce the number of buckets.
+    unsigned NewNumBuckets = 0;
+    if (OldNumEntries)
+      NewNumBuckets = std::max(64, 1 << (Log2_32_Ceil(OldNumEntries) + 1));
+    if (NewNumBuckets == NumBuckets) {
+      resetCtrl();
+      return;
+    }
+
+    deallocateBuckets();
+    init(NewNumBuckets);
+  }
+
+  /// Return 1 if the specified key is in the map, 0 otherwise.
+  size_type count(const_arg_type_t<KeyT> Val) const {
+    return findBucket(Val) != NumBuckets ? 1 : 0;
+  }
+
+  iterator find(const_arg_type_t<KeyT> Val) { return find_as(Val); }
+  const_iterator find(const_arg_type_t<KeyT> Val) const {
+    return find_as(Val);
+  }
+
+  /// Alternate version of find() which allows a different, and possibly
+  /// less expensive, key type.
+  /// The KeyInfoT is responsible for supplying methods
+  /// getHashValue(LookupKeyT) and isEqual(LookupKeyT, KeyT) for each key
+  /// type used.
+  template <class LookupKeyT> iterator find_as(const LookupKeyT &Val) {
+    unsigned I = findBucket(Val);
+    if (I == NumBuckets)
+      return end();
+    return makeIterator(I);
+  }
+  template <class LookupKeyT>
+  const_iterator find_as(const LookupKeyT &Val) const {
+    unsigned I = findBucket(Val);
+    if (I == NumBuckets)
+      return end();
+    return makeConstIterator(I);
+  }
+
+  /// lookup - Return the entry for the specified key, or a default
+  /// constructed value if no such entry exists.
+  ValueT lookup(const_arg_type_t<KeyT> Val) const {
+    unsigned I = findBucket(Val);
+    if (I == NumBuckets)
+      return ValueT();
+    return Buckets[I].getSecond();
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    return try_emplace(KV.first, KV.second);
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(std::pair<KeyT, ValueT> &&KV) {
+    return try_emplace(std::move(KV.first), std::move(KV.second));
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // The value is constructed in-place if the key is not in the map, otherwise
+  // it is not moved.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(KeyT &&Key, Ts &&... Args) {
+    return tryEmplaceImpl(std::move(Key), std::forward<Ts>(Args)...);
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // The value is constructed in-place if the key is not in the map, otherwise
+  // it is not moved.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(const KeyT &Key, Ts &&... Args) {
+    return tryEmplaceImpl(Key, std::forward<Ts>(Args)...);
+  }
+
+  /// insert - Range insertion of pairs.
+  template <typename InputIt> void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  bool erase(const KeyT &Val) {
+    unsigned I = findBucket(Val);
+    if (I == NumBuckets)
+      return false; // not in map.
+    eraseBucket(I);
+    return true;
+  }
+  void erase(iterator I) { eraseBucket(&*I - Buckets); }
+
+  value_type &FindAndConstruct(const KeyT &Key) {
+    return *try_emplace(Key).first;
+  }
+
+  ValueT &operator[](const KeyT &Key) { return FindAndConstruct(Key).second; }
+
+  value_type &FindAndConstruct(KeyT &&Key) {
+    return *try_emplace(std::move(Key)).first;
+  }
+
+  ValueT &operator[](KeyT &&Key) {
+    return FindAndConstruct(std::move(Key)).second;
+  }
+
+  /// isPointerIntoBucketsArray - Return true if the specified pointer points
+  /// somewhere into the map's array of buckets (i.e. either to a key or
+  /// value in the map).
+  bool isPointerIntoBucketsArray(const void *Ptr) const {
+    return Ptr >= Buckets && Ptr < Buckets + NumBuckets;
+  }
+
+  /// getPointerIntoBucketsArray() - Return an opaque pointer into the buckets
+  /// array.  In conjunction with the previous method, this can be used to
+  /// determine whether an insertion caused the map to reallocate.
+  const void *getPointerIntoBucketsArray() const { return Buckets; }
+
+  /// Return the approximate size (in bytes) of the actual map.
+  /// This is just the raw memory used by the map and control bytes.
+  /// If entries are pointers to objects, the size of the referenced objects
+  /// are not included.
+  size_t getMemorySize() const {
+    return NumBuckets * (sizeof(BucketT) + sizeof(int8_t));
+  }
+
+private:
+  BucketT *Buckets = nullptr;
+  int8_t *Ctrl = nullptr;
+  unsigned NumEntries = 0;
+  unsigned NumBuckets = 0;
+  /// Number of Empty buckets that can still be filled before the load factor
+  /// is exceeded.
+  unsigned GrowthLeft = 0;
+
+  /// At most 7/8 of the buckets are used before the table grows.
+  static unsigned getMaxLoad(unsigned NumBuckets) {
+    return NumBuckets - NumBuckets / 8;
+  }
+
+  /// Returns the number of buckets to allocate to ensure that the map can
+  /// accommodate \p NumEntries without growing. The bucket count is zero or a
+  /// power of two that is a multiple of the group width.
+  static unsigned getMinBucketToReserveForEntries(unsigned NumEntries) {
+    if (NumEntries == 0)
+      return 0;
+    return std::max<unsigned>(Group::Width,
+                              NextPowerOf2(NumEntries * 8 / 7 + 1));
+  }
+
+  /// Split the hash value of a key into the group the probe starts from and
+  /// the 7 bits stored in the control byte. Like DenseMap, the probe starts
+  /// from the low bits of the hash, which keeps the locality DenseMapInfo
+  /// hashes often have. The control bits must not correlate with the group,
+  /// so they are taken from the top of a multiplicative mix of all the bits.
+  static std::pair<size_t, int8_t> splitHash(unsigned Hash) {
+    uint64_t Mixed = uint64_t(Hash) * 0x9E3779B97F4A7C15ULL;
+    return {size_t(Hash), int8_t(Mixed >> 57)};
+  }
+
+  template <typename LookupKeyT>
+  static unsigned getHashValue(const LookupKeyT &Val) {
+    return KeyInfoT::getHashValue(Val);
+  }
+
+  unsigned getNumGroups() const { return NumBuckets / Group::Width; }
+
+  /// \returns the index of the bucket holding \p Val, or NumBuckets if there
+  /// is none.
+  template <typename LookupKeyT>
+  unsigned findBucket(const LookupKeyT &Val) const {
+    if (NumBuckets == 0)
+      return NumBuckets;
+
+    std::pair<size_t, int8_t> Hash = splitHash(getHashValue(Val));
+    unsigned GroupMask = getNumGroups() - 1;
+    unsigned GroupNo = Hash.first & GroupMask;
+    // Triangular probing visits every group once before repeating.
+    for (unsigned ProbeAmt = 1;; ++ProbeAmt) {
+      unsigned Base = GroupNo * Group::Width;
+      Group G(Ctrl + Base);
+      for (uint32_t Mask = G.match(Hash.second); Mask; Mask &= Mask - 1) {
+        unsigned I = Base + countTrailingZeros(Mask);
+        if (LLVM_LIKELY(KeyInfoT::isEqual(Val, Buckets[I].getFirst())))
+          return I;
+      }
+      if (LLVM_LIKELY(G.matchEmpty()))
+        return NumBuckets;
+      assert(ProbeAmt <= getNumGroups() && "Probed every group!");
+      GroupNo = (GroupNo + ProbeAmt) & GroupMask;
+    }
+  }
+
+  /// \returns the index of the first Empty or Deleted bucket on the probe
+  /// sequence of a key with hash \p Hash. The table must not be full.
+  unsigned findInsertBucket(size_t Hash) const {
+    unsigned GroupMask = getNumGroups() - 1;
+    unsigned GroupNo = Hash & GroupMask;
+    for (unsigned ProbeAmt = 1;; ++ProbeAmt) {
+      unsigned Base = GroupNo * Group::Width;
+      if (uint32_t Mask = Group(Ctrl + Base).matchEmptyOrDeleted())
+        return Base + countTrailingZeros(Mask);
+      assert(ProbeAmt <= getNumGroups() && "Probed every group!");
+      GroupNo = (GroupNo + ProbeAmt) & GroupMask;
+    }
+  }
+
+  template <typename KeyArg, typename... Ts>
+  std::pair<iterator, bool> tryEmplaceImpl(KeyArg &&Key, Ts &&... Args) {
+    unsigned I = findBucket(Key);
+    if (I != NumBuckets)
+      return std::make_pair(makeIterator(I), false); // Already in map.
+
+    incrementEpoch();
+    std::pair<size_t, int8_t> Hash = splitHash(getHashValue(Key));
+    if (NumBuckets != 0)
+      I = findInsertBucket(Hash.first);
+    // Reusing a Deleted bucket does not change the load of the table, filling
+    // an Empty one might require growing first.
+    if (NumBuckets == 0 || (Ctrl[I] == Group::Empty && GrowthLeft == 0)) {
+      grow();
+      I = findInsertBucket(Hash.first);
+    }
+
+    if (Ctrl[I] == Group::Empty)
+      --GrowthLeft;
+    Ctrl[I] = Hash.second;
+    ++NumEntries;
+
+    BucketT *TheBucket = Buckets + I;
+    ::new (&TheBucket->getFirst()) KeyT(std::forward<KeyArg>(Key));
+    ::new (&TheBucket->getSecond()) ValueT(std::forward<Ts>(Args)...);
+    return std::make_pair(makeIterator(I), true);
+  }
+
+  void eraseBucket(unsigned I) {
+    assert(Ctrl[I] >= 0 && "erasing an unused bucket!");
+    incrementEpoch();
+    Buckets[I].getSecond().~ValueT();
+    Buckets[I].getFirst().~KeyT();
+    --NumEntries;
+
+    // A probe never continues past a group with an Empty bucket. If this group
+    // already has one, no probe sequence relies on this bucket being used, so
+    // it can become Empty again instead of a tombstone.
+    unsigned Base = I & ~(Group::Width - 1);
+    if (Group(Ctrl + Base).matchEmpty()) {
+      Ctrl[I] = Group::Empty;
+      ++GrowthLeft;
+    } else {
+      Ctrl[I] = Group::Deleted;
+    }
+  }
+
+  /// Make room for at least one more element. If enough of the used buckets
+  /// are tombstones, rehash in place rather than doubling the table.
+  void grow() {
+    if (NumBuckets == 0) {
+      rehash(Group::Width);
+      return;
+    }
+    if (NumEntries < getMaxLoad(NumBuckets) / 2)
+      rehash(NumBuckets);
+    else
+      rehash(NumBuckets * 2);
+  }
+
+  void rehash(unsigned NewNumBuckets) {
+    BucketT *OldBuckets = Buckets;
+    int8_t *OldCtrl = Ctrl;
+    unsigned OldNumBuckets = NumBuckets;
+
+    allocateBuckets(NewNumBuckets);
+    resetCtrl();
+
+    for (unsigned I = 0; I != OldNumBuckets; ++I) {
+      if (OldCtrl[I] < 0)
+        continue;
+      BucketT &B = OldBuckets[I];
+      std::pair<size_t, int8_t> Hash = splitHash(getHashValue(B.getFirst()));
+      unsigned J = findInsertBucket(Hash.first);
+      Ctrl[J] = Hash.second;
+      --GrowthLeft;
+      ++NumEntries;
+
+      ::new (&Buckets[J].getFirst()) KeyT(std::move(B.getFirst()));
+      ::new (&Buckets[J].getSecond()) ValueT(std::move(B.getSecond()));
+      B.getSecond().~ValueT();
+      B.getFirst().~KeyT();
+    }
+
+    if (OldNumBuckets) {
+      deallocate_buffer(OldBuckets, sizeof(BucketT) * OldNumBuckets,
+                        alignof(BucketT));
+      deallocate_buffer(OldCtrl, OldNumBuckets, alignof(int8_t));
+    }
+  }
+
+  void init(unsigned InitNumBuckets) {
+    if (InitNumBuckets == 0) {
+      Buckets = nullptr;
+      Ctrl = nullptr;
+      NumBuckets = NumEntries = GrowthLeft = 0;
+      return;
+    }
+    allocateBuckets(InitNumBuckets);
+    resetCtrl();
+  }
+
+  /// Mark every bucket Empty. The buckets must not hold any live element.
+  void resetCtrl() {
+    NumEntries = 0;
+    GrowthLeft = getMaxLoad(NumBuckets);
+    if (NumBuckets)
+      std::memset(Ctrl, Group::Empty, NumBuckets);
+  }
+
+  void allocateBuckets(unsigned Num) {
+    assert((Num == 0 || (isPowerOf2_32(Num) && Num >= Group::Width)) &&
+           "invalid number of buckets!");
+    NumBuckets = Num;
+    if (NumBuckets == 0) {
+      Buckets = nullptr;
+      Ctrl = nullptr;
+      return;
+    }
+    Buckets = static_cast<BucketT *>(
+        allocate_buffer(sizeof(BucketT) * NumBuckets, alignof(BucketT)));
+    Ctrl = static_cast<int8_t *>(allocate_buffer(NumBuckets, alignof(int8_t)));
+  }
+
+  void deallocateBuckets() {
+    if (NumBuckets == 0)
+      return;
+    deallocate_buffer(Buckets, sizeof(BucketT) * NumBuckets, alignof(BucketT));
+    deallocate_buffer(Ctrl, NumBuckets, alignof(int8_t));
+  }
+
+  void destroyAll() {
+    for (unsigned I = 0; I != NumBuckets; ++I) {
+      if (Ctrl[I] < 0)
+        continue;
+      Buckets[I].getSecond().~ValueT();
+      Buckets[I].getFirst().~KeyT();
+    }
+  }
+
+  void copyFrom(const SwissTableMap &Other) {
+    destroyAll();
+    deallocateBuckets();
+    incrementEpoch();
+    allocateBuckets(Other.NumBuckets);
+    NumEntries = Other.NumEntries;
+    GrowthLeft = Other.GrowthLeft;
+    if (NumBuckets == 0)
+      return;
+
+    // Keep the layout, including tombstones, so that the copy is bucket for
+    // bucket identical to the original.
+    std::memcpy(Ctrl, Other.Ctrl, NumBuckets);
+    for (unsigned I = 0; I != NumBuckets; ++I) {
+      if (Ctrl[I] < 0)
+        continue;
+      ::new (&Buckets[I].getFirst()) KeyT(Other.Buckets[I].getFirst());
+      ::new (&Buckets[I].getSecond()) ValueT(Other.Buckets[I].getSecond());
+    }
+  }
+
+  iterator makeIterator(unsigned I) {
+    return iterator(Buckets + I, Ctrl + I, Ctrl + NumBuckets, *this, true);
+  }
+  const_iterator makeConstIterator(unsigned I) const {
+    return const_iterator(Buckets + I, Ctrl + I, Ctrl + NumBuckets, *this,
+                          true);
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT>
+inline void swap(SwissTableMap<KeyT, ValueT, KeyInfoT, BucketT> &LHS,
+                 SwissTableMap<KeyT, ValueT, KeyInfoT, BucketT> &RHS) {
+  LHS.swap(RHS);
+}
+
+/// Equality comparison for SwissTableMap.
+///
+/// Iterates over elements of LHS confirming that each (key, value) pair in LHS
+/// is also in RHS, and that no additional pairs are in RHS.
+/// Equivalent to N calls to RHS.find and N value comparisons. Amortized
+/// complexity is linear, worst case is O(N^2) (if every hash collides).
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT>
+bool operator==(const SwissTableMap<KeyT, ValueT, KeyInfoT, BucketT> &LHS,
+                const SwissTableMap<KeyT, ValueT, KeyInfoT, BucketT> &RHS) {
+  if (LHS.size() != RHS.size())
+    return false;
+
+  for (auto &KV : LHS) {
+    auto I = RHS.find(KV.first);
+    if (I == RHS.end() || I->second != KV.second)
+      return false;
+  }
+
+  return true;
+}
+
+/// Inequality comparison for SwissTableMap.
+///
+/// Equivalent to !(LHS == RHS). See operator== for performance notes.
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT>
+bool operator!=(const SwissTableMap<KeyT, ValueT, KeyInfoT, BucketT> &LHS,
+                const SwissTableMap<KeyT, ValueT, KeyInfoT, BucketT> &RHS) {
+  return !(LHS == RHS);
+}
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT,
+          bool IsConst>
+class SwissTableMapIterator : DebugEpochBase::HandleBase {
+  friend class SwissTableMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>;
+  friend class SwissTableMapIterator<KeyT, ValueT, KeyInfoT, BucketT, false>;
+
+public:
+  using difference_type = ptrdiff_t;
+  using value_type =
+      typename std::conditional<IsConst, const BucketT, BucketT>::type;
+  using pointer = value_type *;
+  using reference = value_type &;
+  using iterator_category = std::forward_iterator_tag;
+
+private:
+  pointer Ptr = nullptr;
+  const int8_t *Ctrl = nullptr;
+  const int8_t *CtrlEnd = nullptr;
+
+public:
+  SwissTableMapIterator() = default;
+
+  SwissTableMapIterator(pointer Pos, const int8_t *Ctrl, const int8_t *CtrlEnd,
+                        const DebugEpochBase &Epoch, bool NoAdvance = false)
+      : DebugEpochBase::HandleBase(&Epoch), Ptr(Pos), Ctrl(Ctrl),
+        CtrlEnd(CtrlEnd) {
+    assert(isHandleInSync() && "invalid construction!");
+    if (!NoAdvance)
+      AdvancePastEmptyBuckets();
+  }
+
+  // Converting ctor from non-const iterators to const iterators. SFINAE'd out
+  // for const iterator destinations so it doesn't end up as a user defined copy
+  // constructor.
+  template <bool IsConstSrc,
+            typename = std::enable_if_t<!IsConstSrc && IsConst>>
+  SwissTableMapIterator(
+      const SwissTableMapIterator<KeyT, ValueT, KeyInfoT, BucketT, IsConstSrc>
+          &I)
+      : DebugEpochBase::HandleBase(I), Ptr(I.Ptr), Ctrl(I.Ctrl),
+        CtrlEnd(I.CtrlEnd) {}
+
+  reference operator*() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    assert(Ctrl != CtrlEnd && "dereferencing end() iterator");
+    return *Ptr;
+  }
+  pointer operator->() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    assert(Ctrl != CtrlEnd && "dereferencing end() iterator");
+    return Ptr;
+  }
+
+  friend bool operator==(const SwissTableMapIterator &LHS,
+                         const SwissTableMapIterator &RHS) {
+    assert((!LHS.Ptr || LHS.isHandleInSync()) && "handle not in sync!");
+    assert((!RHS.Ptr || RHS.isHandleInSync()) && "handle not in sync!");
+    assert(LHS.getEpochAddress() == RHS.getEpochAddress() &&
+           "comparing incomparable iterators!");
+    return LHS.Ptr == RHS.Ptr;
+  }
+
+  friend bool operator!=(const SwissTableMapIterator &LHS,
+                         const SwissTableMapIterator &RHS) {
+    return !(LHS == RHS);
+  }
+
+  inline SwissTableMapIterator &operator++() { // Preincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    assert(Ctrl != CtrlEnd && "incrementing end() iterator");
+    ++Ptr;
+    ++Ctrl;
+    AdvancePastEmptyBuckets();
+    return *this;
+  }
+  SwissTableMapIterator operator++(int) { // Postincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    SwissTableMapIterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+private:
+  void AdvancePastEmptyBuckets() {
+    assert(Ctrl <= CtrlEnd);
+    while (Ctrl != CtrlEnd && *Ctrl < 0) {
+      ++Ptr;
+      ++Ctrl;
+    }
+  }
+};
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_SWISSTABLEMAP_H
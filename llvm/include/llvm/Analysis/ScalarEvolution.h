@@ -836,10 +836,20 @@ public:
   /// Called when the client has changed the disposition of values in
   /// this loop.
   ///
-  /// We don't have a way to invalidate per-loop dispositions. Clear and
-  /// recompute is simpler.
+  /// This drops the dispositions with respect to all the loops of the loop
+  /// nest containing \p L.
   void forgetLoopDispositions(const Loop *L);
 
+  /// Drop the memoized results that can be recomputed on demand (ranges,
+  /// dispositions, values at scopes, ...) if their size exceeds the budget set
+  /// by -scalar-evolution-cache-budget. This must only be called when no
+  /// query is in progress, e.g. between two passes.
+  void trimCaches();
+
+  /// Return the size in bytes of the memoized results that trimCaches can
+  /// drop.
+  size_t getTrimmableCacheSize() const;
+
   /// Determine the minimum number of zero bits that S is guaranteed to end in
   /// (at every loop iteration).  It is, at the same time, the minimum number
   /// of times S is divisible by 2.  For example, given {4,+,8} it returns 2.
@@ -144,10 +144,34 @@ class GsymCreator {
   AddressRanges Ranges;
   llvm::Optional<uint64_t> BaseAddress;
   bool Finalized = false;
+  /// The maximum number of FunctionInfo objects to keep in Funcs before they
+  /// are spilled to disk, or zero to keep all of them in memory.
+  size_t MaxFunctionInfosInMemory = 0;
+  /// Temporary files that each contain a sorted run of spilled FunctionInfo
+  /// objects, and the number of FunctionInfo objects they contain.
+  std::vector<std::string> SpilledRuns;
+  size_t NumSpilledFuncs = 0;
+  /// The first error that happened when spilling FunctionInfo objects. It is
+  /// reported by finalize().
+  std::string SpillError;
+  /// If any FunctionInfo objects were spilled, finalize() merges all of them
+  /// into this temporary file instead of keeping them in Funcs.
+  std::string MergedRun;
+  size_t NumMergedFuncs = 0;
+  uint64_t MergedMinAddr = 0;
+  uint64_t MergedMaxAddr = 0;
+
+  /// Sort Run and write it to a new temporary file in SpilledRuns.
+  void spillFunctionInfos(std::vector<FunctionInfo> &Run);
+
+  /// Merge all spilled runs into MergedRun while removing duplicate and
+  /// overlapping function infos the same way finalize() does for Funcs.
+  llvm::Error mergeSpilledRuns(llvm::raw_ostream &OS);
 
 public:
 
   GsymCreator();
+  ~GsymCreator();
 
   /// Save a GSYM file to a stand alone file.
   ///
@@ -197,6 +221,22 @@ public:
   /// \param   FI The function info object to emplace into our functions list.
   void addFunctionInfo(FunctionInfo &&FI);
 
+  /// Limit the number of FunctionInfo objects that are kept in memory.
+  ///
+  /// Whenever this many function infos have been added, they are sorted and
+  /// spilled to a temporary file. finalize() then merges the sorted runs back
+  /// together, so the peak memory used for function infos stays bounded
+  /// while the encoded GSYM data is the same as when everything is kept in
+  /// memory. Function infos that were spilled are not visited by
+  /// forEachFunctionInfo(), so clients that need to modify them must not set
+  /// a limit.
+  ///
+  /// \param MaxFuncs The maximum number of function infos to keep in memory,
+  ///                 or zero for no limit, which is the default.
+  void setMaxFunctionInfosInMemory(size_t MaxFuncs) {
+    MaxFunctionInfosInMemory = MaxFuncs;
+  }
+
   /// Finalize the data in the GSYM creator prior to saving the data out.
   ///
   /// Finalize must be called after all FunctionInfo objects have been added
@@ -17,6 +17,7 @@
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/OptBisect.h"
@@ -80,6 +81,73 @@ public:
   void registerCallbacks(PassInstrumentationCallbacks &PIC);
 };
 
+/// This class implements -track-pass-memory. It samples the heap usage of the
+/// process before and after every pass and analysis run and accumulates, per
+/// pass and per function, how much the live heap grew over each run and the
+/// largest growth seen at a pass boundary during it. Memory handed out by
+/// BumpPtrAllocator and the other LLVM allocators comes from malloc and is
+/// therefore included. At the end of its life-time it prints a report similar
+/// to -time-passes, and when -time-trace is active the samples are also
+/// recorded as a "Heap" counter.
+///
+/// The heap is only sampled at pass and analysis boundaries, so the maximum
+/// growth is not a high-water mark: an allocation spike that is freed again
+/// before a nested pass or analysis starts or finishes is not observed, and
+/// for a pass that runs nothing nested it is just the net growth if positive.
+class PassMemoryHandler {
+public:
+  PassMemoryHandler(bool Enabled) : Enabled(Enabled) {}
+
+  /// Destructor handles the print action if it has not been handled before.
+  ~PassMemoryHandler() { print(); }
+
+  // We intend this to be unique per-compilation, thus no copies.
+  PassMemoryHandler(const PassMemoryHandler &) = delete;
+  void operator=(const PassMemoryHandler &) = delete;
+
+  void registerCallbacks(PassInstrumentationCallbacks &PIC);
+
+  /// Prints out the memory usage report and then resets the collected data.
+  void print();
+
+  /// Set a custom output stream for subsequent reporting.
+  void setOutStream(raw_ostream &OutStream) { this->OutStream = &OutStream; }
+
+private:
+  struct MemoryInfo {
+    unsigned Count = 0;
+    /// Sum of the live heap growth over all runs, can be negative.
+    int64_t NetGrowth = 0;
+    /// Largest growth of the live heap sampled during a single run.
+    uint64_t MaxGrowth = 0;
+  };
+
+  struct ActivePass {
+    StringRef PassID;
+    std::string FunctionName;
+    size_t StartUsage;
+    size_t MaxUsage;
+  };
+
+  /// Samples the current heap usage and updates the maximum usage of all
+  /// passes that are currently running.
+  size_t sample();
+
+  void runBeforePass(StringRef PassID, Any IR);
+  void runAfterPass(StringRef PassID);
+
+  /// Stack of currently running passes, outermost first.
+  SmallVector<ActivePass, 8> PassStack;
+  StringMap<MemoryInfo> PassData;
+  StringMap<MemoryInfo> FunctionData;
+
+  /// Custom output stream to print the report into. By default (== nullptr)
+  /// we emit the report into the stream created by CreateInfoOutputFile().
+  raw_ostream *OutStream = nullptr;
+
+  bool Enabled;
+};
+
 // Debug logging for transformation and analysis passes.
 class PrintPassInstrumentation {
 public:
@@ -402,6 +470,7 @@ class StandardInstrumentations {
   PrintIRInstrumentation PrintIR;
   PrintPassInstrumentation PrintPass;
   TimePassesHandler TimePasses;
+  PassMemoryHandler PassMemory;
   OptNoneInstrumentation OptNone;
   OptBisectInstrumentation OptBisect;
   PreservedCFGCheckerInstrumentation PreservedCFGChecker;
@@ -421,6 +490,7 @@ public:
                          FunctionAnalysisManager *FAM = nullptr);
 
   TimePassesHandler &getTimePasses() { return TimePasses; }
+  PassMemoryHandler &getPassMemory() { return PassMemory; }
 };
 
 extern template class ChangeReporter<std::string>;
@@ -32,6 +32,21 @@ bool isAvailable();
 Error compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
                int Level = DefaultCompression);
 
+/// Default size of the chunks compressed independently by parallelCompress.
+static constexpr size_t DefaultParallelChunkSize = 1 << 20;
+
+/// Compress \p InputBuffer into a zlib stream, like compress. Inputs larger
+/// than \p ChunkSize are split into chunks which are deflated independently
+/// and in parallel, and then joined into a single valid stream. The result can
+/// be decompressed with uncompress, but it is slightly larger than the one
+/// produced by compress since chunks cannot refer to the data of the previous
+/// ones. The chunks are compressed on the threads of llvm::parallel::strategy;
+/// the result does not depend on their number.
+Error parallelCompress(StringRef InputBuffer,
+                       SmallVectorImpl<char> &CompressedBuffer,
+                       int Level = DefaultCompression,
+                       size_t ChunkSize = DefaultParallelChunkSize);
+
 Error uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                  size_t &UncompressedSize);
 
@@ -58,6 +58,11 @@ void timeTraceProfilerBegin(StringRef Name,
 /// Manually end the last time section.
 void timeTraceProfilerEnd();
 
+/// Record a sample of the counter \p Name with the given \p Value at the
+/// current time. Samples are emitted as counter events, which trace viewers
+/// display as a graph alongside the time sections.
+void timeTraceProfilerCounter(StringRef Name, int64_t Value);
+
 /// The TimeTraceScope is a helper class to call the begin and end functions
 /// of the time trace profiler.  When the object is constructed, it begins
 /// the section; and when it is destroyed, it stops it. If the time profiler
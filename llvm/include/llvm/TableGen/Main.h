@@ -13,6 +13,10 @@
 #ifndef LLVM_TABLEGEN_MAIN_H
 #define LLVM_TABLEGEN_MAIN_H
 
+#include "llvm/ADT/ArrayRef.h"
+#include <functional>
+#include <string>
+
 namespace llvm {
 
 class raw_ostream;
@@ -22,7 +26,19 @@ class RecordKeeper;
 /// Returns true on error, false otherwise.
 using TableGenMainFn = bool (raw_ostream &OS, RecordKeeper &Records);
 
-int TableGenMain(const char *argv0, TableGenMainFn *MainFn);
+/// An additional output of a tblgen invocation: the backend in Emit is run on
+/// the same records as the main action, and its output is written to
+/// Filename.
+struct TableGenOutput {
+  std::string Filename;
+  std::function<TableGenMainFn> Emit;
+};
+
+/// Parse the input file, run MainFn and write its output to the file given by
+/// -o. Each of ExtraOutputs is then run on the same records, so that several
+/// files can be generated from a single parse of the input.
+int TableGenMain(const char *argv0, TableGenMainFn *MainFn,
+                 ArrayRef<TableGenOutput> ExtraOutputs = None);
 
 } // end namespace llvm
 
@@ -1769,6 +1769,7 @@ class RecordKeeper {
   FoldingSet<RecordRecTy> RecordTypePool;
   std::map<std::string, Init *, std::less<>> ExtraGlobals;
   unsigned AnonCounter = 0;
+  bool EncodingsReversed = false;
 
   // These members are for the phase timing feature. We need a timer group,
   // the last timer started, and a flag to say whether the last timer
@@ -1810,6 +1811,12 @@ public:
     return It == ExtraGlobals.end() ? nullptr : It->second;
   }
 
+  /// Whether the instruction encodings of a little-endian target have been
+  /// reversed in place. Backends that run on the same records must not
+  /// reverse them again.
+  bool areEncodingsReversed() const { return EncodingsReversed; }
+  void setEncodingsReversed() { EncodingsReversed = true; }
+
   void saveInputFilename(std::string Filename) {
     InputFilename = Filename;
   }
@@ -147,6 +147,20 @@ STATISTIC(NumTripCountsNotComputed,
           "Number of loops without predictable loop counts");
 STATISTIC(NumBruteForceTripCountsComputed,
           "Number of loops with trip counts computed by force");
+STATISTIC(NumSCEVCacheHits, "Number of getSCEV queries answered from cache");
+STATISTIC(NumSCEVCacheMisses, "Number of getSCEV queries computed");
+STATISTIC(NumRangeCacheHits, "Number of range queries answered from cache");
+STATISTIC(NumRangeCacheMisses, "Number of range queries computed");
+STATISTIC(NumValueAtScopeCacheHits,
+          "Number of getSCEVAtScope queries answered from cache");
+STATISTIC(NumValueAtScopeCacheMisses,
+          "Number of getSCEVAtScope queries computed");
+STATISTIC(NumLoopDispositionCacheHits,
+          "Number of loop disposition queries answered from cache");
+STATISTIC(NumLoopDispositionCacheMisses,
+          "Number of loop disposition queries computed");
+STATISTIC(NumCacheTrims,
+          "Number of times the memoized results exceeded the cache budget");
 
 static cl::opt<unsigned>
 MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
@@ -233,6 +247,12 @@ static cl::opt<bool> UseExpensiveRangeSharpening(
     cl::desc("Use more powerful methods of sharpening expression ranges. May "
              "be costly in terms of compile time"));
 
+static cl::opt<unsigned> CacheBudget(
+    "scalar-evolution-cache-budget", cl::Hidden, cl::init(0),
+    cl::desc("Maximum size in KiB of the recomputable results memoized by "
+             "ScalarEvolution before they are dropped by trimCaches "
+             "(0 = unlimited)"));
+
 //===----------------------------------------------------------------------===//
 //                           SCEV class definitions
 //===----------------------------------------------------------------------===//
@@ -3887,6 +3907,7 @@ const SCEV *ScalarEvolution::getSCEV(Value *V) {
 
   const SCEV *S = getExistingSCEV(V);
   if (S == nullptr) {
+    ++NumSCEVCacheMisses;
     S = createSCEV(V);
     // During PHI resolution, it is possible to create two SCEVs for the same
     // V, so it is needed to double check whether V->S is inserted into
@@ -3910,6 +3931,8 @@ const SCEV *ScalarEvolution::getSCEV(Value *V) {
           !isa<GetElementPtrInst>(V))
         ExprValueMap[Stripped].insert({V, Offset});
     }
+  } else {
+    ++NumSCEVCacheHits;
   }
   return S;
 }
@@ -5735,8 +5758,11 @@ ScalarEvolution::getRangeRef(const SCEV *S,
 
   // See if we've computed this range already.
   DenseMap<const SCEV *, ConstantRange>::iterator I = Cache.find(S);
-  if (I != Cache.end())
+  if (I != Cache.end()) {
+    ++NumRangeCacheHits;
     return I->second;
+  }
+  ++NumRangeCacheMisses;
 
   if (const SCEVConstant *C = dyn_cast<SCEVConstant>(S))
     return setRange(C, SignHint, ConstantRange(C->getAPInt()));
@@ -7270,7 +7296,61 @@ void ScalarEvolution::forgetValue(Value *V) {
 }
 
 void ScalarEvolution::forgetLoopDispositions(const Loop *L) {
-  LoopDispositions.clear();
+  // Clients move instructions between L, its preheader and its exit blocks.
+  // All of those are either inside the outermost loop containing L or outside
+  // of any loop, so only the dispositions with respect to the loops of that
+  // loop nest can have changed. The cache may still refer to loops that have
+  // been deleted since, so compare the pointers without dereferencing them.
+  const Loop *Outermost = L;
+  while (const Loop *Parent = Outermost->getParentLoop())
+    Outermost = Parent;
+  SmallVector<const Loop *, 4> Nest = Outermost->getLoopsInPreorder();
+  SmallPtrSet<const Loop *, 8> NestLoops(Nest.begin(), Nest.end());
+
+  for (auto I = LoopDispositions.begin(), E = LoopDispositions.end(); I != E;
+       ++I) {
+    auto &Values = I->second;
+    llvm::erase_if(Values, [&](const auto &V) {
+      return NestLoops.count(V.getPointer());
+    });
+    if (Values.empty())
+      LoopDispositions.erase(I);
+  }
+}
+
+size_t ScalarEvolution::getTrimmableCacheSize() const {
+  // Only account for the memoized results that can be recomputed from the
+  // expressions and the IR at any time. ValueExprMap, the trip counts and the
+  // uniqued expressions themselves are what the other results are keyed on,
+  // so they are kept.
+  return HasRecMap.getMemorySize() + MinTrailingZerosCache.getMemorySize() +
+         ConstantEvolutionLoopExitValue.getMemorySize() +
+         ValuesAtScopes.getMemorySize() + LoopDispositions.getMemorySize() +
+         BlockDispositions.getMemorySize() + UnsignedRanges.getMemorySize() +
+         SignedRanges.getMemorySize();
+}
+
+void ScalarEvolution::trimCaches() {
+  if (!CacheBudget)
+    return;
+
+  size_t Size = getTrimmableCacheSize();
+  if (Size <= size_t(CacheBudget) * 1024)
+    return;
+
+  ++NumCacheTrims;
+  LLVM_DEBUG(dbgs() << "SCEV: dropping " << Size
+                    << " bytes of memoized results\n");
+  // Assign empty maps rather than clearing them, so that the buckets are
+  // actually freed.
+  HasRecMap = HasRecMapType();
+  MinTrailingZerosCache = decltype(MinTrailingZerosCache)();
+  ConstantEvolutionLoopExitValue = decltype(ConstantEvolutionLoopExitValue)();
+  ValuesAtScopes = decltype(ValuesAtScopes)();
+  LoopDispositions = decltype(LoopDispositions)();
+  BlockDispositions = decltype(BlockDispositions)();
+  UnsignedRanges = decltype(UnsignedRanges)();
+  SignedRanges = decltype(SignedRanges)();
 }
 
 /// Get the exact loop backedge taken count considering all loop exits. A
@@ -8432,9 +8512,12 @@ const SCEV *ScalarEvolution::getSCEVAtScope(const SCEV *V, const Loop *L) {
       ValuesAtScopes[V];
   // Check to see if we've folded this expression at this loop before.
   for (auto &LS : Values)
-    if (LS.first == L)
+    if (LS.first == L) {
+      ++NumValueAtScopeCacheHits;
       return LS.second ? LS.second : V;
+    }
 
+  ++NumValueAtScopeCacheMisses;
   Values.emplace_back(L, nullptr);
 
   // Otherwise compute it.
@@ -12382,9 +12465,12 @@ ScalarEvolution::LoopDisposition
 ScalarEvolution::getLoopDisposition(const SCEV *S, const Loop *L) {
   auto &Values = LoopDispositions[S];
   for (auto &V : Values) {
-    if (V.getPointer() == L)
+    if (V.getPointer() == L) {
+      ++NumLoopDispositionCacheHits;
       return V.getInt();
+    }
   }
+  ++NumLoopDispositionCacheMisses;
   Values.emplace_back(L, LoopVariant);
   LoopDisposition D = computeLoopDisposition(S, L);
   auto &Values2 = LoopDispositions[S];
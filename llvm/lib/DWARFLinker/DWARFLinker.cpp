@@ -49,6 +49,27 @@ static uint64_t getDebugInfoSize(DWARFContext &Dwarf) {
   return Size;
 }
 
+/// Extract the DIEs of every compile unit in \p Dwarf using \p Pool.
+///
+/// Extracting the DIE array of a unit only reads the input sections, so the
+/// units of an object file can be parsed independently of each other. The
+/// unit headers and the abbreviation sets are loaded serially beforehand,
+/// since DWARFContext and DWARFDebugAbbrev populate them lazily.
+static void extractCompileUnitsInParallel(DWARFContext &Dwarf,
+                                          ThreadPool &Pool) {
+  if (Dwarf.getNumCompileUnits() < 2)
+    return;
+
+  for (const auto &CU : Dwarf.compile_units())
+    CU->getAbbreviations();
+
+  for (const auto &CU : Dwarf.compile_units()) {
+    DWARFUnit *Unit = CU.get();
+    Pool.async([Unit]() { Unit->getUnitDIE(/*ExtractUnitDIEOnly=*/false); });
+  }
+  Pool.wait();
+}
+
 /// Similar to DWARFUnitSection::getUnitForOffset(), but returning our
 /// CompileUnit object instead.
 static CompileUnit *getUnitForOffset(const UnitListTy &Units, uint64_t Offset) {
@@ -2342,6 +2363,14 @@ bool DWARFLinker::link() {
       Options.TheAccelTableKind = AccelTableKind::Apple;
   }
 
+  // Parsing the DIEs of large object files dominates the first phase below.
+  // Unless we are asked to run single threaded, the compile units of each
+  // object file are extracted concurrently before being walked in order.
+  std::unique_ptr<ThreadPool> ExtractPool;
+  if (Options.Threads != 1)
+    ExtractPool =
+        std::make_unique<ThreadPool>(hardware_concurrency(Options.Threads));
+
   for (LinkContext &OptContext : ObjectContexts) {
     if (Options.Verbose) {
       if (DwarfLinkerClientID == DwarfLinkerClient::Dsymutil)
@@ -2378,6 +2407,9 @@ bool DWARFLinker::link() {
     OptContext.CompileUnits.reserve(
         OptContext.File.Dwarf->getNumCompileUnits());
 
+    if (ExtractPool)
+      extractCompileUnitsInParallel(*OptContext.File.Dwarf, *ExtractPool);
+
     for (const auto &CU : OptContext.File.Dwarf->compile_units()) {
       updateDwarfVersion(CU->getVersion());
       auto CUDie = CU->getUnitDIE(false);
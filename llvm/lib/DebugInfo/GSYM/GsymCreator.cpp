@@ -10,21 +10,152 @@
 #include "llvm/DebugInfo/GSYM/Header.h"
 #include "llvm/DebugInfo/GSYM/LineTable.h"
 #include "llvm/MC/StringTableBuilder.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <algorithm>
 #include <cassert>
 #include <functional>
+#include <queue>
 #include <vector>
 
 using namespace llvm;
 using namespace gsym;
 
+/// Spilled FunctionInfo objects are stored in temporary files as a sequence
+/// of records that each contain the start address of the function as a
+/// uint64_t, the size of the encoded FunctionInfo as a uint32_t, and the
+/// FunctionInfo in the same encoding that is used in GSYM files. All values
+/// are little endian.
+static llvm::Error writeSpilledFunctionInfo(raw_ostream &OS,
+                                            const FunctionInfo &FI) {
+  SmallString<256> Buffer;
+  raw_svector_ostream BufferStrm(Buffer);
+  FileWriter FW(BufferStrm, support::little);
+  if (Expected<uint64_t> OffsetOrErr = FI.encode(FW))
+    assert(*OffsetOrErr == 0);
+  else
+    return OffsetOrErr.takeError();
+  if (Buffer.size() > UINT32_MAX)
+    return createStringError(std::errc::invalid_argument,
+                             "FunctionInfo is too large to spill");
+  support::endian::write<uint64_t>(OS, FI.startAddress(), support::little);
+  support::endian::write<uint32_t>(OS, Buffer.size(), support::little);
+  OS << Buffer;
+  return Error::success();
+}
+
+namespace {
+/// Sequential reader for the records of a spilled run.
+class SpilledRunReader {
+  std::unique_ptr<MemoryBuffer> Buffer;
+  uint64_t Offset = 0;
+  uint64_t Address = 0;
+  StringRef Data;
+
+public:
+  static Expected<SpilledRunReader> open(StringRef Path) {
+    auto BufferOrErr = MemoryBuffer::getFile(Path);
+    if (!BufferOrErr)
+      return createFileError(Path, BufferOrErr.getError());
+    SpilledRunReader Reader;
+    Reader.Buffer = std::move(*BufferOrErr);
+    if (Error Err = Reader.advance())
+      return std::move(Err);
+    return std::move(Reader);
+  }
+
+  /// Returns true once all records were read.
+  bool done() const { return Data.data() == nullptr; }
+
+  /// The start address of the current record's FunctionInfo.
+  uint64_t getAddress() const { return Address; }
+
+  /// Decode the current record's FunctionInfo.
+  Expected<FunctionInfo> decode() const {
+    DataExtractor FIData(Data, /*IsLittleEndian=*/true, 8);
+    return FunctionInfo::decode(FIData, Address);
+  }
+
+  /// Move on to the next record.
+  Error advance() {
+    StringRef Bytes = Buffer->getBuffer();
+    if (Offset == Bytes.size()) {
+      Data = StringRef();
+      return Error::success();
+    }
+    DataExtractor Header(Bytes, /*IsLittleEndian=*/true, 8);
+    if (!Header.isValidOffsetForDataOfSize(Offset, 12))
+      return createStringError(std::errc::io_error,
+                               "truncated spilled FunctionInfo record");
+    Address = Header.getU64(&Offset);
+    const uint32_t Size = Header.getU32(&Offset);
+    if (!Header.isValidOffsetForDataOfSize(Offset, Size))
+      return createStringError(std::errc::io_error,
+                               "truncated spilled FunctionInfo record");
+    Data = Bytes.substr(Offset, Size);
+    Offset += Size;
+    return Error::success();
+  }
+};
+} // namespace
+
+/// Check if Prev, which sorts right before Curr, must be removed because Curr
+/// describes the same function or covers it, and report any overlap between
+/// them to OS. See GsymCreator::finalize() for the cases that are handled.
+static bool shouldRemovePrevious(raw_ostream &OS, const FunctionInfo &Prev,
+                                 const FunctionInfo &Curr) {
+  if (Prev.Range.intersects(Curr.Range)) {
+    // Overlapping address ranges.
+    if (Prev.Range == Curr.Range) {
+      // Same address range. Check if one is from debug info and the other
+      // is from a symbol table. If so, then keep the one with debug info.
+      // Our sorting guarantees that entries with matching address ranges
+      // that have debug info are last in the sort.
+      if (Prev == Curr) {
+        // FunctionInfo entries match exactly (range, lines, inlines)
+        OS << "warning: duplicate function info entries for range: "
+           << Curr.Range << '\n';
+      } else if (!Prev.hasRichInfo() && Curr.hasRichInfo()) {
+        // Same address range, one with no debug info (symbol) and the
+        // next with debug info. Keep the latter.
+      } else {
+        OS << "warning: same address range contains different debug "
+           << "info. Removing:\n"
+           << Prev << "\nIn favor of this one:\n"
+           << Curr << "\n";
+      }
+      return true;
+    }
+    // print warnings about overlaps
+    OS << "warning: function ranges overlap:\n"
+       << Prev << "\n"
+       << Curr << "\n";
+    return false;
+  }
+  if (Prev.Range.size() == 0 && Curr.Range.contains(Prev.Range.Start)) {
+    OS << "warning: removing symbol:\n"
+       << Prev << "\nKeeping:\n"
+       << Curr << "\n";
+    return true;
+  }
+  return false;
+}
 
 GsymCreator::GsymCreator() : StrTab(StringTableBuilder::ELF) {
   insertFile(StringRef());
 }
 
+GsymCreator::~GsymCreator() {
+  for (const std::string &Path : SpilledRuns)
+    sys::fs::remove(Path);
+  if (!MergedRun.empty())
+    sys::fs::remove(MergedRun);
+}
+
 uint32_t GsymCreator::insertFile(StringRef Path,
                                  llvm::sys::path::Style Style) {
   llvm::StringRef directory = llvm::sys::path::parent_path(Path, Style);
@@ -58,19 +189,26 @@ llvm::Error GsymCreator::save(StringRef Path,
 
 llvm::Error GsymCreator::encode(FileWriter &O) const {
   std::lock_guard<std::recursive_mutex> Guard(Mutex);
-  if (Funcs.empty())
+  // If function infos were spilled to disk, they are all in MergedRun after
+  // finalize() and Funcs is empty.
+  const bool IsMerged = !MergedRun.empty();
+  const size_t NumFuncs = IsMerged ? NumMergedFuncs : Funcs.size();
+  if (NumFuncs == 0 && SpilledRuns.empty())
     return createStringError(std::errc::invalid_argument,
                              "no functions to encode");
   if (!Finalized)
     return createStringError(std::errc::invalid_argument,
                              "GsymCreator wasn't finalized prior to encoding");
 
-  if (Funcs.size() > UINT32_MAX)
+  if (NumFuncs > UINT32_MAX)
     return createStringError(std::errc::invalid_argument,
                              "too many FunctionInfos");
 
-  const uint64_t MinAddr = BaseAddress ? *BaseAddress : Funcs.front().startAddress();
-  const uint64_t MaxAddr = Funcs.back().startAddress();
+  const uint64_t FirstAddr =
+      IsMerged ? MergedMinAddr : Funcs.front().startAddress();
+  const uint64_t MinAddr = BaseAddress ? *BaseAddress : FirstAddr;
+  const uint64_t MaxAddr =
+      IsMerged ? MergedMaxAddr : Funcs.back().startAddress();
   const uint64_t AddrDelta = MaxAddr - MinAddr;
   Header Hdr;
   Hdr.Magic = GSYM_MAGIC;
@@ -78,7 +216,7 @@ llvm::Error GsymCreator::encode(FileWriter &O) const {
   Hdr.AddrOffSize = 0;
   Hdr.UUIDSize = static_cast<uint8_t>(UUID.size());
   Hdr.BaseAddress = MinAddr;
-  Hdr.NumAddresses = static_cast<uint32_t>(Funcs.size());
+  Hdr.NumAddresses = static_cast<uint32_t>(NumFuncs);
   Hdr.StrtabOffset = 0; // We will fix this up later.
   Hdr.StrtabSize = 0; // We will fix this up later.
   memset(Hdr.UUID, 0, sizeof(Hdr.UUID));
@@ -104,20 +242,33 @@ llvm::Error GsymCreator::encode(FileWriter &O) const {
 
   // Write out the address offsets.
   O.alignTo(Hdr.AddrOffSize);
-  for (const auto &FuncInfo : Funcs) {
-    uint64_t AddrOffset = FuncInfo.startAddress() - Hdr.BaseAddress;
+  auto WriteAddrOffset = [&](uint64_t Addr) {
+    uint64_t AddrOffset = Addr - Hdr.BaseAddress;
     switch(Hdr.AddrOffSize) {
       case 1: O.writeU8(static_cast<uint8_t>(AddrOffset)); break;
       case 2: O.writeU16(static_cast<uint16_t>(AddrOffset)); break;
       case 4: O.writeU32(static_cast<uint32_t>(AddrOffset)); break;
       case 8: O.writeU64(AddrOffset); break;
     }
+  };
+  if (IsMerged) {
+    Expected<SpilledRunReader> ReaderOrErr = SpilledRunReader::open(MergedRun);
+    if (!ReaderOrErr)
+      return ReaderOrErr.takeError();
+    for (SpilledRunReader &Reader = *ReaderOrErr; !Reader.done();) {
+      WriteAddrOffset(Reader.getAddress());
+      if (llvm::Error Err = Reader.advance())
+        return Err;
+    }
+  } else {
+    for (const auto &FuncInfo : Funcs)
+      WriteAddrOffset(FuncInfo.startAddress());
   }
 
   // Write out all zeros for the AddrInfoOffsets.
   O.alignTo(4);
   const off_t AddrInfoOffsetsOffset = O.tell();
-  for (size_t i = 0, n = Funcs.size(); i < n; ++i)
+  for (size_t i = 0, n = NumFuncs; i < n; ++i)
     O.writeU32(0);
 
   // Write out the file table
@@ -142,11 +293,28 @@ llvm::Error GsymCreator::encode(FileWriter &O) const {
   std::vector<uint32_t> AddrInfoOffsets;
 
   // Write out the address infos for each function info.
-  for (const auto &FuncInfo : Funcs) {
-    if (Expected<uint64_t> OffsetOrErr = FuncInfo.encode(O))
+  if (IsMerged) {
+    Expected<SpilledRunReader> ReaderOrErr = SpilledRunReader::open(MergedRun);
+    if (!ReaderOrErr)
+      return ReaderOrErr.takeError();
+    for (SpilledRunReader &Reader = *ReaderOrErr; !Reader.done();) {
+      Expected<FunctionInfo> FuncInfo = Reader.decode();
+      if (!FuncInfo)
+        return FuncInfo.takeError();
+      if (Expected<uint64_t> OffsetOrErr = FuncInfo->encode(O))
         AddrInfoOffsets.push_back(OffsetOrErr.get());
-    else
+      else
         return OffsetOrErr.takeError();
+      if (llvm::Error Err = Reader.advance())
+        return Err;
+    }
+  } else {
+    for (const auto &FuncInfo : Funcs) {
+      if (Expected<uint64_t> OffsetOrErr = FuncInfo.encode(O))
+          AddrInfoOffsets.push_back(OffsetOrErr.get());
+      else
+          return OffsetOrErr.takeError();
+    }
   }
   // Fixup the string table offset and size in the header
   O.fixup32((uint32_t)StrtabOffset, offsetof(Header, StrtabOffset));
@@ -174,6 +342,13 @@ llvm::Error GsymCreator::finalize(llvm::raw_ostream &OS) {
   // Don't let the string table indexes change by finalizing in order.
   StrTab.finalizeInOrder();
 
+  if (!SpillError.empty())
+    return createStringError(std::errc::io_error,
+                             "failed to spill function infos: %s",
+                             SpillError.c_str());
+  if (!SpilledRuns.empty())
+    return mergeSpilledRuns(OS);
+
   // Remove duplicates function infos that have both entries from debug info
   // (DWARF or Breakpad) and entries from the SymbolTable.
   //
@@ -200,46 +375,8 @@ llvm::Error GsymCreator::finalize(llvm::raw_ostream &OS) {
   while (Curr != Funcs.end()) {
     // Can't check for overlaps or same address ranges if we don't have a
     // previous entry
-    if (Prev != Funcs.end()) {
-      if (Prev->Range.intersects(Curr->Range)) {
-        // Overlapping address ranges.
-        if (Prev->Range == Curr->Range) {
-          // Same address range. Check if one is from debug info and the other
-          // is from a symbol table. If so, then keep the one with debug info.
-          // Our sorting guarantees that entries with matching address ranges
-          // that have debug info are last in the sort.
-          if (*Prev == *Curr) {
-            // FunctionInfo entries match exactly (range, lines, inlines)
-            OS << "warning: duplicate function info entries for range: "
-               << Curr->Range << '\n';
-            Curr = Funcs.erase(Prev);
-          } else {
-            if (!Prev->hasRichInfo() && Curr->hasRichInfo()) {
-              // Same address range, one with no debug info (symbol) and the
-              // next with debug info. Keep the latter.
-              Curr = Funcs.erase(Prev);
-            } else {
-              OS << "warning: same address range contains different debug "
-                 << "info. Removing:\n"
-                 << *Prev << "\nIn favor of this one:\n"
-                 << *Curr << "\n";
-              Curr = Funcs.erase(Prev);
-            }
-          }
-        } else {
-          // print warnings about overlaps
-          OS << "warning: function ranges overlap:\n"
-             << *Prev << "\n"
-             << *Curr << "\n";
-        }
-      } else if (Prev->Range.size() == 0 &&
-                 Curr->Range.contains(Prev->Range.Start)) {
-        OS << "warning: removing symbol:\n"
-           << *Prev << "\nKeeping:\n"
-           << *Curr << "\n";
-        Curr = Funcs.erase(Prev);
-      }
-    }
+    if (Prev != Funcs.end() && shouldRemovePrevious(OS, *Prev, *Curr))
+      Curr = Funcs.erase(Prev);
     if (Curr == Funcs.end())
       break;
     Prev = Curr++;
@@ -261,6 +398,141 @@ llvm::Error GsymCreator::finalize(llvm::raw_ostream &OS) {
   return Error::success();
 }
 
+void GsymCreator::spillFunctionInfos(std::vector<FunctionInfo> &Run) {
+  llvm::sort(Run);
+  std::string Message;
+  int FD;
+  SmallString<128> Path;
+  if (std::error_code EC =
+          sys::fs::createTemporaryFile("gsym", "run", FD, Path)) {
+    Message = EC.message();
+  } else {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    for (const FunctionInfo &FI : Run) {
+      if (llvm::Error Err = writeSpilledFunctionInfo(OS, FI)) {
+        Message = toString(std::move(Err));
+        break;
+      }
+    }
+    OS.close();
+    if (Message.empty() && OS.has_error())
+      Message = OS.error().message();
+    OS.clear_error();
+  }
+
+  std::lock_guard<std::recursive_mutex> Guard(Mutex);
+  if (!Path.empty())
+    SpilledRuns.push_back(std::string(Path));
+  if (!Message.empty() && SpillError.empty())
+    SpillError = Message;
+  NumSpilledFuncs += Run.size();
+  Run.clear();
+}
+
+llvm::Error GsymCreator::mergeSpilledRuns(llvm::raw_ostream &OS) {
+  // Spill what is left in memory as one more run, so that all function infos
+  // go through the same merge.
+  if (!Funcs.empty()) {
+    std::vector<FunctionInfo> Run;
+    Run.swap(Funcs);
+    spillFunctionInfos(Run);
+    if (!SpillError.empty())
+      return createStringError(std::errc::io_error,
+                               "failed to spill function infos: %s",
+                               SpillError.c_str());
+  }
+
+  std::vector<SpilledRunReader> Readers;
+  for (const std::string &Path : SpilledRuns) {
+    Expected<SpilledRunReader> ReaderOrErr = SpilledRunReader::open(Path);
+    if (!ReaderOrErr)
+      return ReaderOrErr.takeError();
+    Readers.push_back(std::move(*ReaderOrErr));
+  }
+
+  // Merge the sorted runs with a heap that holds the next function info of
+  // each run. Function infos that compare equal are taken in run order.
+  struct HeapEntry {
+    FunctionInfo FI;
+    size_t RunIdx;
+  };
+  auto Later = [](const HeapEntry &LHS, const HeapEntry &RHS) {
+    if (RHS.FI < LHS.FI)
+      return true;
+    if (LHS.FI < RHS.FI)
+      return false;
+    return LHS.RunIdx > RHS.RunIdx;
+  };
+  std::priority_queue<HeapEntry, std::vector<HeapEntry>, decltype(Later)> Heap(
+      Later);
+  auto PushNext = [&](size_t RunIdx) -> llvm::Error {
+    SpilledRunReader &Reader = Readers[RunIdx];
+    if (Reader.done())
+      return Error::success();
+    Expected<FunctionInfo> FI = Reader.decode();
+    if (!FI)
+      return FI.takeError();
+    Heap.push({std::move(*FI), RunIdx});
+    return Reader.advance();
+  };
+  for (size_t I = 0, E = Readers.size(); I != E; ++I)
+    if (llvm::Error Err = PushNext(I))
+      return Err;
+
+  int FD;
+  SmallString<128> Path;
+  if (std::error_code EC =
+          sys::fs::createTemporaryFile("gsym", "merged", FD, Path))
+    return errorCodeToError(EC);
+  MergedRun = std::string(Path);
+  raw_fd_ostream MergedOS(FD, /*shouldClose=*/true);
+  auto Emit = [&](const FunctionInfo &FI) -> llvm::Error {
+    if (NumMergedFuncs++ == 0)
+      MergedMinAddr = FI.startAddress();
+    MergedMaxAddr = FI.startAddress();
+    return writeSpilledFunctionInfo(MergedOS, FI);
+  };
+
+  // This removes the same function infos as the loop in finalize() does for
+  // the in memory case, but only ever needs to hold on to the previous one.
+  Optional<FunctionInfo> Prev;
+  while (!Heap.empty()) {
+    HeapEntry Top = Heap.top();
+    Heap.pop();
+    if (llvm::Error Err = PushNext(Top.RunIdx))
+      return Err;
+    if (Prev && !shouldRemovePrevious(OS, *Prev, Top.FI))
+      if (llvm::Error Err = Emit(*Prev))
+        return Err;
+    Prev = std::move(Top.FI);
+  }
+  if (Prev) {
+    // See the comment in finalize() for why the size of the last entry is
+    // fixed up.
+    if (Prev->Range.size() == 0 && ValidTextRanges) {
+      if (auto Range = ValidTextRanges->getRangeThatContains(Prev->Range.Start))
+        Prev->Range.End = Range->End;
+    }
+    if (llvm::Error Err = Emit(*Prev))
+      return Err;
+  }
+  MergedOS.close();
+  if (MergedOS.has_error()) {
+    std::error_code EC = MergedOS.error();
+    MergedOS.clear_error();
+    return errorCodeToError(EC);
+  }
+
+  Readers.clear();
+  for (const std::string &RunPath : SpilledRuns)
+    sys::fs::remove(RunPath);
+  SpilledRuns.clear();
+
+  OS << "Pruned " << NumSpilledFuncs - NumMergedFuncs
+     << " functions, ended with " << NumMergedFuncs << " total\n";
+  return Error::success();
+}
+
 uint32_t GsymCreator::insertString(StringRef S, bool Copy) {
   if (S.empty())
     return 0;
@@ -280,9 +552,19 @@ uint32_t GsymCreator::insertString(StringRef S, bool Copy) {
 }
 
 void GsymCreator::addFunctionInfo(FunctionInfo &&FI) {
-  std::lock_guard<std::recursive_mutex> Guard(Mutex);
-  Ranges.insert(FI.Range);
-  Funcs.emplace_back(FI);
+  std::vector<FunctionInfo> Run;
+  {
+    std::lock_guard<std::recursive_mutex> Guard(Mutex);
+    Ranges.insert(FI.Range);
+    Funcs.emplace_back(FI);
+    if (MaxFunctionInfosInMemory == 0 ||
+        Funcs.size() < MaxFunctionInfosInMemory)
+      return;
+    Run.swap(Funcs);
+  }
+  // Sort and write out the run without holding the lock, so that other
+  // threads can keep adding function infos in the meantime.
+  spillFunctionInfos(Run);
 }
 
 void GsymCreator::forEachFunctionInfo(
@@ -305,7 +587,9 @@ void GsymCreator::forEachFunctionInfo(
 
 size_t GsymCreator::getNumFunctionInfos() const{
   std::lock_guard<std::recursive_mutex> Guard(Mutex);
-  return Funcs.size();
+  if (!MergedRun.empty())
+    return NumMergedFuncs;
+  return Funcs.size() + NumSpilledFuncs;
 }
 
 bool GsymCreator::IsValidTextAddress(uint64_t Addr) const {
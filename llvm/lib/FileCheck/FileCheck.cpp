@@ -1187,7 +1187,10 @@ bool Pattern::parsePattern(StringRef PatternStr, StringRef Prefix,
     // Find the end, which is the start of the next regex.
     size_t FixedMatchEnd = PatternStr.find("{{");
     FixedMatchEnd = std::min(FixedMatchEnd, PatternStr.find("[["));
-    RegExStr += Regex::escape(PatternStr.substr(0, FixedMatchEnd));
+    StringRef FixedMatch = PatternStr.substr(0, FixedMatchEnd);
+    if (FixedMatch.size() > RequiredLiteral.size())
+      RequiredLiteral = FixedMatch;
+    RegExStr += Regex::escape(FixedMatch);
     PatternStr = PatternStr.substr(FixedMatchEnd);
   }
 
@@ -1280,7 +1283,7 @@ Pattern::MatchResult Pattern::match(StringRef Buffer,
   unsigned int Flags = Regex::Newline;
   if (IgnoreCase)
     Flags |= Regex::IgnoreCase;
-  if (!Regex(RegExToMatch, Flags).match(Buffer, &MatchInfo))
+  if (!matchRegex(Regex(RegExToMatch, Flags), RegExToMatch, Buffer, MatchInfo))
     return make_error<NotFoundError>();
 
   // Successful regex match.
@@ -1323,6 +1326,55 @@ Pattern::MatchResult Pattern::match(StringRef Buffer,
   return MatchResult(TheMatch, Error::success());
 }
 
+/// \returns whether \p RegEx, compiled with Regex::Newline, can only match
+/// text within a single line. This is conservative: a control character
+/// (including a newline or a tab starting a range), a character class that
+/// contains the newline character, or any collating element or equivalence
+/// class (which can name the newline, as in "[[.newline.]]" or "[[.LF.]]")
+/// disqualifies the regex.
+static bool isLineConfinedRegex(StringRef RegEx) {
+  if (RegEx.contains("[:space:]") || RegEx.contains("[:cntrl:]") ||
+      RegEx.contains("[.") || RegEx.contains("[="))
+    return false;
+  return llvm::none_of(
+      RegEx, [](char C) { return static_cast<unsigned char>(C) <= '\n'; });
+}
+
+bool Pattern::matchRegex(const Regex &R, StringRef RegEx, StringRef Buffer,
+                         SmallVectorImpl<StringRef> &MatchInfo) const {
+  if (RequiredLiteral.empty())
+    return R.match(Buffer, &MatchInfo);
+
+  auto FindLiteral = [&](size_t From) {
+    return IgnoreCase ? Buffer.find_lower(RequiredLiteral, From)
+                      : Buffer.find(RequiredLiteral, From);
+  };
+
+  // No match is possible without the literal.
+  size_t LiteralPos = FindLiteral(0);
+  if (LiteralPos == StringRef::npos)
+    return false;
+  if (!isLineConfinedRegex(RegEx))
+    return R.match(Buffer, &MatchInfo);
+
+  // A match lies entirely within one line containing the literal. Lines are
+  // tried in order so the first match found is the leftmost one in Buffer.
+  // Anchors behave as for the whole buffer since each slice starts at the
+  // beginning of Buffer or after a newline and ends before one or at the end
+  // of Buffer.
+  while (LiteralPos != StringRef::npos) {
+    size_t LineStart = Buffer.rfind('\n', LiteralPos);
+    LineStart = LineStart == StringRef::npos ? 0 : LineStart + 1;
+    size_t LineEnd = Buffer.find('\n', LiteralPos);
+    if (R.match(Buffer.slice(LineStart, LineEnd), &MatchInfo))
+      return true;
+    if (LineEnd == StringRef::npos)
+      break;
+    LiteralPos = FindLiteral(LineEnd + 1);
+  }
+  return false;
+}
+
 unsigned Pattern::computeMatchDistance(StringRef Buffer) const {
   // Just compute the number of matching characters. For regular expressions, we
   // just compare against the regex itself and hope for the best.
@@ -623,6 +623,12 @@ class Pattern {
   /// a fixed string to match.
   std::string RegExStr;
 
+  /// The longest fixed string appearing outside of any regex or substitution
+  /// block in a regex pattern, or empty if there is none. Every match of
+  /// RegExStr contains it, so match() searches for it before running the
+  /// regex engine.
+  StringRef RequiredLiteral;
+
   /// Entries in this vector represent a substitution of a string variable or
   /// an expression in the RegExStr regex at match time. For example, in the
   /// case of a CHECK directive with the pattern "foo[[bar]]baz[[#N+1]]",
@@ -777,6 +783,11 @@ public:
 private:
   bool AddRegExToRegEx(StringRef RS, unsigned &CurParen, SourceMgr &SM);
   void AddBackrefToRegEx(unsigned BackrefNum);
+  /// Matches \p R, compiled from \p RegEx, against \p Buffer and fills
+  /// \p MatchInfo like Regex::match does. Uses RequiredLiteral to reject
+  /// \p Buffer or to restrict the regex search to candidate lines.
+  bool matchRegex(const Regex &R, StringRef RegEx, StringRef Buffer,
+                  SmallVectorImpl<StringRef> &MatchInfo) const;
   /// Computes an arbitrary estimate for the quality of matching this pattern
   /// at the start of \p Buffer; a distance of zero should correspond to a
   /// perfect match.
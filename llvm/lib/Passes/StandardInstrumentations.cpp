@@ -15,6 +15,7 @@
 #include "llvm/Passes/StandardInstrumentations.h"
 #include "llvm/ADT/Any.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Analysis/CallGraphSCCPass.h"
 #include "llvm/Analysis/LazyCallGraph.h"
@@ -27,9 +28,12 @@
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include <unordered_set>
 #include <vector>
@@ -125,6 +129,15 @@ static cl::opt<std::string>
     DiffBinary("print-changed-diff-path", cl::Hidden, cl::init("diff"),
                cl::desc("system diff used by change reporters"));
 
+static cl::opt<bool> TrackPassMemory(
+    "track-pass-memory", cl::Hidden, cl::init(false),
+    cl::desc("Track the heap growth of each pass, printing a report on exit"));
+
+// Limits the number of functions listed in the -track-pass-memory report.
+static cl::opt<unsigned> TrackPassMemoryMaxFunctions(
+    "track-pass-memory-max-functions", cl::Hidden, cl::init(10),
+    cl::desc("Maximum number of functions to list in the pass memory report"));
+
 namespace {
 
 // Perform a system based diff between \p Before and \p After, using
@@ -914,6 +927,137 @@ void PrintPassInstrumentation::registerCallbacks(
   });
 }
 
+size_t PassMemoryHandler::sample() {
+  size_t Usage = sys::Process::GetMallocUsage();
+  for (ActivePass &P : PassStack)
+    P.MaxUsage = std::max(P.MaxUsage, Usage);
+  if (timeTraceProfilerEnabled())
+    timeTraceProfilerCounter("Heap", Usage);
+  return Usage;
+}
+
+void PassMemoryHandler::runBeforePass(StringRef PassID, Any IR) {
+  if (isSpecialPass(PassID,
+                    {"PassManager", "PassAdaptor", "AnalysisManagerProxy"}))
+    return;
+
+  const Function *F = nullptr;
+  if (any_isa<const Function *>(IR))
+    F = any_cast<const Function *>(IR);
+  else if (any_isa<const Loop *>(IR))
+    F = any_cast<const Loop *>(IR)->getHeader()->getParent();
+
+  size_t Usage = sample();
+  PassStack.push_back(
+      {PassID, F ? F->getName().str() : std::string(), Usage, Usage});
+}
+
+void PassMemoryHandler::runAfterPass(StringRef PassID) {
+  if (isSpecialPass(PassID,
+                    {"PassManager", "PassAdaptor", "AnalysisManagerProxy"}))
+    return;
+
+  // Find the run this callback ends. It is normally the innermost one, but
+  // the callbacks are not always balanced: a pass skipped by another
+  // instrumentation gets no callbacks at all, while one whose after-callback
+  // never comes leaves a stale entry on top. Stale entries are dropped, and a
+  // callback without a matching run (e.g. for a run that started before the
+  // callbacks were registered) is ignored.
+  auto It = llvm::find_if(llvm::reverse(PassStack), [&](const ActivePass &P) {
+    return P.PassID == PassID;
+  });
+  if (It == PassStack.rend())
+    return;
+
+  size_t Usage = sample();
+  ActivePass P = std::move(*It);
+  PassStack.erase(std::prev(It.base()), PassStack.end());
+
+  auto Accumulate = [&](MemoryInfo &Info) {
+    ++Info.Count;
+    Info.NetGrowth += int64_t(Usage) - int64_t(P.StartUsage);
+    Info.MaxGrowth =
+        std::max<uint64_t>(Info.MaxGrowth, P.MaxUsage - P.StartUsage);
+  };
+  Accumulate(PassData[PassID]);
+  if (!P.FunctionName.empty())
+    Accumulate(FunctionData[P.FunctionName]);
+}
+
+void PassMemoryHandler::print() {
+  if (!Enabled || PassData.empty())
+    return;
+
+  std::unique_ptr<raw_ostream> InfoOut;
+  if (!OutStream)
+    InfoOut = CreateInfoOutputFile();
+  raw_ostream &OS = OutStream ? *OutStream : *InfoOut;
+
+  using NamedInfo = std::pair<StringRef, const MemoryInfo *>;
+  auto SortByMaxGrowth = [](const StringMap<MemoryInfo> &Data) {
+    std::vector<NamedInfo> Sorted;
+    Sorted.reserve(Data.size());
+    for (const auto &Entry : Data)
+      Sorted.emplace_back(Entry.getKey(), &Entry.getValue());
+    llvm::sort(Sorted, [](const NamedInfo &A, const NamedInfo &B) {
+      if (A.second->MaxGrowth != B.second->MaxGrowth)
+        return A.second->MaxGrowth > B.second->MaxGrowth;
+      return A.first < B.first;
+    });
+    return Sorted;
+  };
+  auto PrintRow = [&](const NamedInfo &Row) {
+    OS << format("  %12llu  %12lld  %8u  ",
+                 (unsigned long long)Row.second->MaxGrowth,
+                 (long long)Row.second->NetGrowth, Row.second->Count)
+       << Row.first << '\n';
+  };
+
+  OS << "===" << std::string(73, '-') << "===\n"
+     << "                      ... Pass memory usage report ...\n"
+     << "===" << std::string(73, '-') << "===\n"
+     << "  Current heap usage: " << sys::Process::GetMallocUsage()
+     << " bytes\n\n"
+     << "   Max growth     Net growth      Runs  Name\n";
+  for (const NamedInfo &Row : SortByMaxGrowth(PassData))
+    PrintRow(Row);
+
+  if (!FunctionData.empty()) {
+    std::vector<NamedInfo> Functions = SortByMaxGrowth(FunctionData);
+    if (Functions.size() > TrackPassMemoryMaxFunctions)
+      Functions.resize(TrackPassMemoryMaxFunctions);
+    OS << "\n  Functions with the largest maximum growth:\n"
+       << "   Max growth     Net growth      Runs  Name\n";
+    for (const NamedInfo &Row : Functions)
+      PrintRow(Row);
+  }
+  OS << '\n';
+  OS.flush();
+
+  PassData.clear();
+  FunctionData.clear();
+}
+
+void PassMemoryHandler::registerCallbacks(PassInstrumentationCallbacks &PIC) {
+  if (!Enabled)
+    return;
+
+  PIC.registerBeforeNonSkippedPassCallback(
+      [this](StringRef P, Any IR) { this->runBeforePass(P, IR); });
+  PIC.registerAfterPassCallback(
+      [this](StringRef P, Any, const PreservedAnalyses &) {
+        this->runAfterPass(P);
+      });
+  PIC.registerAfterPassInvalidatedCallback(
+      [this](StringRef P, const PreservedAnalyses &) {
+        this->runAfterPass(P);
+      });
+  PIC.registerBeforeAnalysisCallback(
+      [this](StringRef P, Any IR) { this->runBeforePass(P, IR); });
+  PIC.registerAfterAnalysisCallback(
+      [this](StringRef P, Any) { this->runAfterPass(P); });
+}
+
 PreservedCFGCheckerInstrumentation::CFG::CFG(const Function *F,
                                              bool TrackBBLifetime) {
   if (TrackBBLifetime)
@@ -1201,7 +1345,8 @@ void InLineChangePrinter::registerCallbacks(PassInstrumentationCallbacks &PIC) {
 
 StandardInstrumentations::StandardInstrumentations(bool DebugLogging,
                                                    bool VerifyEach)
-    : PrintPass(DebugLogging), OptNone(DebugLogging),
+    : PrintPass(DebugLogging), PassMemory(TrackPassMemory),
+      OptNone(DebugLogging),
       PrintChangedIR(PrintChanged == ChangePrinter::PrintChangedVerbose),
       PrintChangedDiff(
           PrintChanged == ChangePrinter::PrintChangedDiffVerbose ||
@@ -1215,6 +1360,7 @@ void StandardInstrumentations::registerCallbacks(
   PrintIR.registerCallbacks(PIC);
   PrintPass.registerCallbacks(PIC);
   TimePasses.registerCallbacks(PIC);
+  PassMemory.registerCallbacks(PIC);
   OptNone.registerCallbacks(PIC);
   OptBisect.registerCallbacks(PIC);
   if (FAM)
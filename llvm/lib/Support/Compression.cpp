@@ -17,6 +17,9 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Parallel.h"
+#include <vector>
 #if LLVM_ENABLE_ZLIB
 #include <zlib.h>
 #endif
@@ -60,6 +63,81 @@ Error zlib::compress(StringRef InputBuffer,
   return Res ? createError(convertZlibCodeToString(Res)) : Error::success();
 }
 
+// Deflate \p Input into a raw deflate stream, without the zlib header and
+// trailer. Unless \p Flush is Z_FINISH, the stream is terminated with an empty
+// stored block aligning it to a byte boundary, so that another raw stream can
+// be appended to it.
+static int deflateChunk(StringRef Input, int Level, int Flush,
+                        SmallVectorImpl<char> &Output) {
+  z_stream Stream = {};
+  int Res = ::deflateInit2(&Stream, Level, Z_DEFLATED, /*windowBits=*/-15,
+                           /*memLevel=*/8, Z_DEFAULT_STRATEGY);
+  if (Res != Z_OK)
+    return Res;
+  Stream.next_in = (Bytef *)Input.data();
+  Stream.avail_in = Input.size();
+  // deflateBound does not account for the flush marker, which takes at most
+  // 5 bytes, and the block header of the final block.
+  Output.resize(::deflateBound(&Stream, Input.size()) + 16);
+  Stream.next_out = (Bytef *)Output.data();
+  Stream.avail_out = Output.size();
+  Res = ::deflate(&Stream, Flush);
+  // Tell MemorySanitizer that zlib output buffer is fully initialized.
+  // This avoids a false report when running LLVM with uninstrumented ZLib.
+  __msan_unpoison(Output.data(), Output.size() - Stream.avail_out);
+  Output.resize(Output.size() - Stream.avail_out);
+  ::deflateEnd(&Stream);
+  if (Flush == Z_FINISH ? Res != Z_STREAM_END : Res != Z_OK)
+    return Res == Z_OK ? Z_BUF_ERROR : Res;
+  return Stream.avail_in == 0 ? Z_OK : Z_BUF_ERROR;
+}
+
+Error zlib::parallelCompress(StringRef InputBuffer,
+                             SmallVectorImpl<char> &CompressedBuffer,
+                             int Level, size_t ChunkSize) {
+  if (ChunkSize == 0 || InputBuffer.size() <= ChunkSize)
+    return compress(InputBuffer, CompressedBuffer, Level);
+
+  // Deflate each chunk and compute its checksum independently.
+  size_t NumChunks = divideCeil(InputBuffer.size(), ChunkSize);
+  std::vector<SmallVector<char, 0>> Chunks(NumChunks);
+  std::vector<uLong> Checksums(NumChunks);
+  std::vector<int> Results(NumChunks);
+  parallelForEachN(0, NumChunks, [&](size_t I) {
+    StringRef Chunk = InputBuffer.substr(I * ChunkSize, ChunkSize);
+    Results[I] = deflateChunk(Chunk, Level,
+                              I + 1 == NumChunks ? Z_FINISH : Z_SYNC_FLUSH,
+                              Chunks[I]);
+    Checksums[I] = ::adler32(1, (const Bytef *)Chunk.data(), Chunk.size());
+  });
+  for (int Res : Results)
+    if (Res != Z_OK)
+      return createError(convertZlibCodeToString(Res));
+
+  // Join the chunks between a zlib header and the checksum of the whole
+  // input. 0x78 0x01 is a valid header for a 32KiB window; the level it
+  // advertises is informational only.
+  uLong Checksum = Checksums[0];
+  size_t Size = 2 + 4;
+  for (size_t I = 0; I != NumChunks; ++I) {
+    if (I != 0) {
+      size_t Len = std::min(ChunkSize, InputBuffer.size() - I * ChunkSize);
+      Checksum = ::adler32_combine(Checksum, Checksums[I], Len);
+    }
+    Size += Chunks[I].size();
+  }
+
+  CompressedBuffer.clear();
+  CompressedBuffer.reserve(Size);
+  CompressedBuffer.push_back(0x78);
+  CompressedBuffer.push_back(0x01);
+  for (const SmallVector<char, 0> &Chunk : Chunks)
+    CompressedBuffer.append(Chunk.begin(), Chunk.end());
+  for (int Shift = 24; Shift >= 0; Shift -= 8)
+    CompressedBuffer.push_back(char((Checksum >> Shift) & 0xff));
+  return Error::success();
+}
+
 Error zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                        size_t &UncompressedSize) {
   int Res =
@@ -91,6 +169,11 @@ Error zlib::compress(StringRef InputBuffer,
                      SmallVectorImpl<char> &CompressedBuffer, int Level) {
   llvm_unreachable("zlib::compress is unavailable");
 }
+Error zlib::parallelCompress(StringRef InputBuffer,
+                             SmallVectorImpl<char> &CompressedBuffer,
+                             int Level, size_t ChunkSize) {
+  llvm_unreachable("zlib::parallelCompress is unavailable");
+}
 Error zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                        size_t &UncompressedSize) {
   llvm_unreachable("zlib::uncompress is unavailable");
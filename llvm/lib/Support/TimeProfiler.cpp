@@ -71,6 +71,21 @@ struct Entry {
         .count();
   }
 };
+
+struct CounterSample {
+  const TimePointType Time;
+  const std::string Name;
+  const int64_t Value;
+
+  CounterSample(TimePointType &&T, std::string &&N, int64_t V)
+      : Time(std::move(T)), Name(std::move(N)), Value(V) {}
+
+  steady_clock::rep getStartUs(TimePointType StartTime) const {
+    return (time_point_cast<microseconds>(Time) -
+            time_point_cast<microseconds>(StartTime))
+        .count();
+  }
+};
 } // namespace
 
 struct llvm::TimeTraceProfiler {
@@ -121,6 +136,10 @@ struct llvm::TimeTraceProfiler {
     Stack.pop_back();
   }
 
+  void counter(std::string Name, int64_t Value) {
+    Counters.emplace_back(steady_clock::now(), std::move(Name), Value);
+  }
+
   // Write events from this TimeTraceProfilerInstance and
   // ThreadTimeTraceProfilerInstances.
   void write(raw_pwrite_stream &OS) {
@@ -160,6 +179,24 @@ struct llvm::TimeTraceProfiler {
       for (const Entry &E : TTP->Entries)
         writeEvent(E, TTP->Tid);
 
+    // Emit counter samples. Counters are per-process in the trace format, so
+    // they are all reported on the main thread.
+    auto writeCounter = [&](const CounterSample &C) {
+      J.object([&] {
+        J.attribute("pid", Pid);
+        J.attribute("tid", int64_t(this->Tid));
+        J.attribute("ph", "C");
+        J.attribute("ts", C.getStartUs(StartTime));
+        J.attribute("name", C.Name);
+        J.attributeObject("args", [&] { J.attribute(C.Name, C.Value); });
+      });
+    };
+    for (const CounterSample &C : Counters)
+      writeCounter(C);
+    for (const TimeTraceProfiler *TTP : ThreadTimeTraceProfilerInstances)
+      for (const CounterSample &C : TTP->Counters)
+        writeCounter(C);
+
     // Emit totals by section name as additional "thread" events, sorted from
     // longest one.
     // Find highest used thread id.
@@ -248,6 +285,7 @@ struct llvm::TimeTraceProfiler {
 
   SmallVector<Entry, 16> Stack;
   SmallVector<Entry, 128> Entries;
+  SmallVector<CounterSample, 0> Counters;
   StringMap<CountAndDurationType> CountAndTotalPerName;
   const time_point<system_clock> BeginningOfTime;
   const TimePointType StartTime;
@@ -328,3 +366,8 @@ void llvm::timeTraceProfilerEnd() {
   if (TimeTraceProfilerInstance != nullptr)
     TimeTraceProfilerInstance->end();
 }
+
+void llvm::timeTraceProfilerCounter(StringRef Name, int64_t Value) {
+  if (TimeTraceProfilerInstance != nullptr)
+    TimeTraceProfilerInstance->counter(std::string(Name), Value);
+}
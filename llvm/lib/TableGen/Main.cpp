@@ -65,7 +65,8 @@ static int reportError(const char *ProgName, Twine Msg) {
 ///
 /// This functionality is really only for the benefit of the build system.
 /// It is similar to GCC's `-M*` family of options.
-static int createDependencyFile(const TGParser &Parser, const char *argv0) {
+static int createDependencyFile(const TGParser &Parser, const char *argv0,
+                                ArrayRef<TableGenOutput> ExtraOutputs) {
   if (OutputFilename == "-")
     return reportError(argv0, "the option -d must be used together with -o\n");
 
@@ -74,7 +75,10 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   if (EC)
     return reportError(argv0, "error opening " + DependFilename + ":" +
                                   EC.message() + "\n");
-  DepOut.os() << OutputFilename << ":";
+  DepOut.os() << OutputFilename;
+  for (const TableGenOutput &Output : ExtraOutputs)
+    DepOut.os() << ' ' << Output.Filename;
+  DepOut.os() << ":";
   for (const auto &Dep : Parser.getDependencies()) {
     DepOut.os() << ' ' << Dep;
   }
@@ -83,7 +87,37 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   return 0;
 }
 
-int llvm::TableGenMain(const char *argv0, TableGenMainFn *MainFn) {
+/// Write the output of a backend to Filename, leaving the file alone if
+/// -write-if-changed is given and its contents are unchanged.
+static int writeOutputFile(const char *argv0, StringRef Filename,
+                           StringRef Contents) {
+  if (WriteIfChanged) {
+    // Only updates the real output file if there are any differences.
+    // This prevents recompilation of all the files depending on it if there
+    // aren't any.
+    if (auto ExistingOrErr = MemoryBuffer::getFile(Filename, /*IsText=*/true))
+      if (std::move(ExistingOrErr.get())->getBuffer() == Contents)
+        return 0;
+  }
+
+  std::error_code EC;
+  ToolOutputFile OutFile(Filename, EC, sys::fs::OF_Text);
+  if (EC)
+    return reportError(argv0, "error opening " + Filename + ": " +
+                                  EC.message() + "\n");
+  OutFile.os() << Contents;
+  if (ErrorsPrinted == 0)
+    OutFile.keep();
+  return 0;
+}
+
+int llvm::TableGenMain(const char *argv0, TableGenMainFn *MainFn,
+                       ArrayRef<TableGenOutput> ExtraOutputs) {
+  for (const TableGenOutput &Output : ExtraOutputs)
+    if (Output.Filename == "-" || Output.Filename == OutputFilename)
+      return reportError(argv0, "output file '" + Output.Filename +
+                                    "' is written more than once\n");
+
   RecordKeeper Records;
 
   if (TimePhases)
@@ -122,37 +156,36 @@ int llvm::TableGenMain(const char *argv0, TableGenMainFn *MainFn) {
   if (status)
     return 1;
 
+  // Run the backends for the additional outputs on the records that were
+  // parsed for the main one, rather than parsing the input again.
+  std::vector<std::string> ExtraOutStrings(ExtraOutputs.size());
+  for (unsigned I = 0, E = ExtraOutputs.size(); I != E; ++I) {
+    Records.startBackendTimer("Backend for " + ExtraOutputs[I].Filename);
+    raw_string_ostream ExtraOut(ExtraOutStrings[I]);
+    status = ExtraOutputs[I].Emit(ExtraOut, Records);
+    ExtraOut.flush();
+    Records.stopBackendTimer();
+    if (status)
+      return 1;
+  }
+
   // Always write the depfile, even if the main output hasn't changed.
   // If it's missing, Ninja considers the output dirty.  If this was below
   // the early exit below and someone deleted the .inc.d file but not the .inc
   // file, tablegen would never write the depfile.
   if (!DependFilename.empty()) {
-    if (int Ret = createDependencyFile(Parser, argv0))
+    if (int Ret = createDependencyFile(Parser, argv0, ExtraOutputs))
       return Ret;
   }
 
   Records.startTimer("Write output");
-  bool WriteFile = true;
-  if (WriteIfChanged) {
-    // Only updates the real output file if there are any differences.
-    // This prevents recompilation of all the files depending on it if there
-    // aren't any.
-    if (auto ExistingOrErr =
-            MemoryBuffer::getFile(OutputFilename, /*IsText=*/true))
-      if (std::move(ExistingOrErr.get())->getBuffer() == Out.str())
-        WriteFile = false;
-  }
-  if (WriteFile) {
-    std::error_code EC;
-    ToolOutputFile OutFile(OutputFilename, EC, sys::fs::OF_Text);
-    if (EC)
-      return reportError(argv0, "error opening " + OutputFilename + ": " +
-                                    EC.message() + "\n");
-    OutFile.os() << Out.str();
-    if (ErrorsPrinted == 0)
-      OutFile.keep();
-  }
-  
+  if (int Ret = writeOutputFile(argv0, OutputFilename, Out.str()))
+    return Ret;
+  for (unsigned I = 0, E = ExtraOutputs.size(); I != E; ++I)
+    if (int Ret = writeOutputFile(argv0, ExtraOutputs[I].Filename,
+                                  ExtraOutStrings[I]))
+      return Ret;
+
   Records.stopTimer();
   Records.stopPhaseTiming();
 
@@ -314,6 +314,10 @@ PreservedAnalyses FunctionToLoopPassAdaptor::run(Function &F,
     // Then intersect the preserved set so that invalidation of module
     // analyses will eventually occur when the module pass completes.
     PA.intersect(std::move(PassPA));
+
+    // No ScalarEvolution query is in flight between two loops, which makes
+    // this a safe point to keep its memoized results within budget.
+    LAR.SE.trimCaches();
   } while (!Worklist.empty());
 
 #ifndef NDEBUG
@@ -107,6 +107,13 @@ static opt<unsigned>
                     "number of cores on the current machine."),
                cl::value_desc("n"), cat(ConversionOptions));
 
+static opt<unsigned> MaxFunctionsInMemory(
+    "max-functions-in-memory",
+    desc("Spill converted functions to temporary files whenever (n) of them "
+         "are held in memory, which bounds the memory used when converting "
+         "large files.\nDefaults to 0, which keeps all functions in memory."),
+    cl::value_desc("n"), cat(ConversionOptions));
+
 static list<uint64_t> LookupAddresses("address",
                                       desc("Lookup an address in a GSYM file"),
                                       cl::value_desc("addr"),
@@ -279,6 +286,7 @@ static llvm::Error handleObjectFile(ObjectFile &Obj,
   auto &OS = outs();
 
   GsymCreator Gsym;
+  Gsym.setMaxFunctionInfosInMemory(MaxFunctionsInMemory);
 
   // See if we can figure out the base address for a given object file, and if
   // we can, then set the base address to use to this value. This will ease
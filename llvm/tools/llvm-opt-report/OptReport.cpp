@@ -7,13 +7,14 @@
 //===----------------------------------------------------------------------===//
 ///
 /// \file
-/// This file implements a tool that can parse the YAML optimization
-/// records and generate an optimization summary annotated source listing
-/// report.
+/// This file implements a tool that can parse the YAML or bitstream
+/// optimization records and generate an optimization summary annotated source
+/// listing report.
 ///
 //===----------------------------------------------------------------------===//
 
 #include "llvm-c/Remarks.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/Demangle/Demangle.h"
 #include "llvm/Remarks/RemarkFormat.h"
 #include "llvm/Remarks/RemarkParser.h"
@@ -27,11 +28,14 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdlib>
 #include <map>
 #include <set>
+#include <vector>
 
 using namespace llvm;
 
@@ -40,9 +44,9 @@ using namespace llvm;
 static cl::OptionCategory
     OptReportCategory("llvm-opt-report options");
 
-static cl::opt<std::string>
-  InputFileName(cl::Positional, cl::desc("<input>"), cl::init("-"),
-                cl::cat(OptReportCategory));
+static cl::list<std::string>
+  InputFileNames(cl::Positional, cl::desc("<input>..."), cl::ZeroOrMore,
+                 cl::cat(OptReportCategory));
 
 static cl::opt<std::string>
   OutputFileName("o", cl::desc("Output file"), cl::init("-"),
@@ -60,10 +64,20 @@ static cl::opt<bool>
   NoDemangle("no-demangle", cl::desc("Don't demangle function names"),
              cl::init(false), cl::cat(OptReportCategory));
 
-static cl::opt<std::string> ParserFormat("format",
-                                         cl::desc("The format of the remarks."),
-                                         cl::init("yaml"),
-                                         cl::cat(OptReportCategory));
+static cl::opt<std::string> ParserFormat(
+    "format",
+    cl::desc("The format of the remarks (yaml, yaml-strtab or bitstream). "
+             "By default it is detected for each input file."),
+    cl::init("auto"), cl::cat(OptReportCategory));
+
+static cl::opt<unsigned>
+    NumThreads("num-threads", cl::init(0),
+               cl::desc("Number of threads used to read the input files "
+                        "(default: autodetect)"),
+               cl::cat(OptReportCategory));
+static cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
+                             cl::aliasopt(NumThreads),
+                             cl::cat(OptReportCategory));
 
 namespace {
 // For each location in the source file, the common per-transformation state
@@ -145,33 +159,34 @@ typedef std::map<std::string, std::map<int, std::map<std::string, std::map<int,
           OptReportLocationInfo>>>> LocationInfoTy;
 } // anonymous namespace
 
-static bool readLocationInfo(LocationInfoTy &LocationInfo) {
+static Error readLocationInfo(StringRef InputFileName,
+                              Optional<remarks::Format> Format,
+                              LocationInfoTy &LocationInfo) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> Buf =
-      MemoryBuffer::getFile(InputFileName.c_str());
-  if (std::error_code EC = Buf.getError()) {
-    WithColor::error() << "Can't open file " << InputFileName << ": "
-                       << EC.message() << "\n";
-    return false;
-  }
+      MemoryBuffer::getFile(InputFileName);
+  if (std::error_code EC = Buf.getError())
+    return createStringError(EC, "Can't open file " + InputFileName + ": " +
+                                     EC.message());
 
-  Expected<remarks::Format> Format = remarks::parseFormat(ParserFormat);
+  // Unless a format was requested explicitly, look at the magic of each file
+  // so that YAML and bitstream remarks can be mixed on the command line.
   if (!Format) {
-    handleAllErrors(Format.takeError(), [&](const ErrorInfoBase &PE) {
-      PE.log(WithColor::error());
-      errs() << '\n';
-    });
-    return false;
+    Expected<remarks::Format> MaybeFormat =
+        remarks::magicToFormat((*Buf)->getBuffer());
+    if (MaybeFormat) {
+      Format = *MaybeFormat;
+    } else {
+      // YAML remarks don't need to start with a magic, assume that's what we
+      // have.
+      consumeError(MaybeFormat.takeError());
+      Format = remarks::Format::YAML;
+    }
   }
 
   Expected<std::unique_ptr<remarks::RemarkParser>> MaybeParser =
       remarks::createRemarkParserFromMeta(*Format, (*Buf)->getBuffer());
-  if (!MaybeParser) {
-    handleAllErrors(MaybeParser.takeError(), [&](const ErrorInfoBase &PE) {
-      PE.log(WithColor::error());
-      errs() << '\n';
-    });
-    return false;
-  }
+  if (!MaybeParser)
+    return MaybeParser.takeError();
   remarks::RemarkParser &Parser = **MaybeParser;
 
   while (true) {
@@ -183,11 +198,7 @@ static bool readLocationInfo(LocationInfoTy &LocationInfo) {
         consumeError(std::move(E));
         break;
       }
-      handleAllErrors(std::move(E), [&](const ErrorInfoBase &PE) {
-        PE.log(WithColor::error());
-        errs() << '\n';
-      });
-      return false;
+      return E;
     }
 
     const remarks::Remark &Remark = **MaybeRemark;
@@ -242,7 +253,95 @@ static bool readLocationInfo(LocationInfoTy &LocationInfo) {
     }
   }
 
-  return true;
+  return Error::success();
+}
+
+// Merge the information read from one input file into \p LocationInfo. The
+// files are merged in command line order, so that the unroll and
+// vectorization factors reported are those of the last remark, exactly as if
+// all the remarks had been read from a single file.
+static void mergeLocationInfo(LocationInfoTy &LocationInfo,
+                              const LocationInfoTy &FileLocationInfo) {
+  for (const auto &FI : FileLocationInfo)
+    for (const auto &LI : FI.second)
+      for (const auto &FLI : LI.second)
+        for (const auto &CI : FLI.second) {
+          const OptReportLocationInfo &RHS = CI.second;
+          OptReportLocationInfo &LLI =
+              LocationInfo[FI.first][LI.first][FLI.first][CI.first];
+          if (RHS.Unrolled.Analyzed)
+            LLI.UnrollCount = RHS.UnrollCount;
+          if (RHS.Vectorized.Analyzed) {
+            LLI.VectorizationFactor = RHS.VectorizationFactor;
+            LLI.InterleaveCount = RHS.InterleaveCount;
+          }
+          LLI.Inlined |= RHS.Inlined;
+          LLI.Unrolled |= RHS.Unrolled;
+          LLI.Vectorized |= RHS.Vectorized;
+        }
+}
+
+static bool readLocationInfo(LocationInfoTy &LocationInfo) {
+  Optional<remarks::Format> Format;
+  if (ParserFormat != "auto") {
+    Expected<remarks::Format> MaybeFormat = remarks::parseFormat(ParserFormat);
+    if (!MaybeFormat) {
+      handleAllErrors(MaybeFormat.takeError(), [&](const ErrorInfoBase &PE) {
+        PE.log(WithColor::error());
+        errs() << '\n';
+      });
+      return false;
+    }
+    Format = *MaybeFormat;
+  }
+
+  if (InputFileNames.empty())
+    InputFileNames.push_back("-");
+
+  // Each input file is parsed on its own into a separate map, and the maps are
+  // merged once all of them have been read.
+  size_t NumFiles = InputFileNames.size();
+  std::vector<LocationInfoTy> FileLocationInfos(NumFiles);
+  std::vector<std::string> FileErrors(NumFiles);
+  auto ReadFile = [&](size_t I) {
+    if (Error E =
+            readLocationInfo(InputFileNames[I], Format, FileLocationInfos[I]))
+      FileErrors[I] = toString(std::move(E));
+  };
+
+  ThreadPoolStrategy S = hardware_concurrency(NumThreads);
+  if (NumThreads == 0) {
+    // If NumThreads is not specified, create one thread for each input, up to
+    // the number of hardware cores.
+    S = heavyweight_hardware_concurrency(NumFiles);
+    S.Limit = true;
+  }
+
+  if (S.ThreadsRequested == 1) {
+    for (size_t I = 0; I != NumFiles; ++I)
+      ReadFile(I);
+  } else {
+    ThreadPool Pool(S);
+    for (size_t I = 0; I != NumFiles; ++I)
+      Pool.async(ReadFile, I);
+    Pool.wait();
+  }
+
+  bool Success = true;
+  for (size_t I = 0; I != NumFiles; ++I) {
+    if (!FileErrors[I].empty()) {
+      WithColor::error() << FileErrors[I] << '\n';
+      Success = false;
+      continue;
+    }
+    if (LocationInfo.empty())
+      LocationInfo = std::move(FileLocationInfos[I]);
+    else
+      mergeLocationInfo(LocationInfo, FileLocationInfos[I]);
+    FileLocationInfos[I].clear();
+  }
+
+  return Success;
 }
 
 static bool writeReport(LocationInfoTy &LocationInfo) {
@@ -464,8 +563,8 @@ int main(int argc, const char **argv) {
   cl::HideUnrelatedOptions(OptReportCategory);
   cl::ParseCommandLineOptions(
       argc, argv,
-      "A tool to generate an optimization report from YAML optimization"
-      " record files.\n");
+      "A tool to generate an optimization report from YAML or bitstream"
+      " optimization record files.\n");
 
   LocationInfoTy LocationInfo;
   if (!readLocationInfo(LocationInfo))
@@ -0,0 +1,202 @@
+//===- llvm/unittest/ADT/SwissTableMapTest.cpp - SwissTableMap tests ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SwissTableMap.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+TEST(SwissTableMapTest, EmptyMap) {
+  SwissTableMap<int, int> Map;
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(0u, Map.size());
+  EXPECT_TRUE(Map.begin() == Map.end());
+  EXPECT_TRUE(Map.find(1) == Map.end());
+  EXPECT_EQ(0u, Map.count(1));
+  EXPECT_EQ(0, Map.lookup(1));
+  EXPECT_FALSE(Map.erase(1));
+  EXPECT_EQ(0u, Map.getMemorySize());
+}
+
+TEST(SwissTableMapTest, InsertFindErase) {
+  SwissTableMap<int, int> Map;
+  auto Res = Map.insert(std::make_pair(1, 10));
+  EXPECT_TRUE(Res.second);
+  EXPECT_EQ(1, Res.first->first);
+  EXPECT_EQ(10, Res.first->second);
+
+  Res = Map.insert(std::make_pair(1, 20));
+  EXPECT_FALSE(Res.second);
+  EXPECT_EQ(10, Res.first->second);
+
+  EXPECT_EQ(1u, Map.size());
+  EXPECT_EQ(1u, Map.count(1));
+  EXPECT_EQ(10, Map.lookup(1));
+  EXPECT_EQ(10, Map.find(1)->second);
+
+  Map[2] = 30;
+  EXPECT_EQ(2u, Map.size());
+  EXPECT_EQ(30, Map.lookup(2));
+
+  EXPECT_TRUE(Map.erase(1));
+  EXPECT_FALSE(Map.erase(1));
+  EXPECT_EQ(1u, Map.size());
+  EXPECT_TRUE(Map.find(1) == Map.end());
+
+  Map.erase(Map.find(2));
+  EXPECT_TRUE(Map.empty());
+  EXPECT_TRUE(Map.begin() == Map.end());
+}
+
+TEST(SwissTableMapTest, TryEmplace) {
+  SwissTableMap<int, std::unique_ptr<int>> Map;
+  auto Res = Map.try_emplace(1, std::make_unique<int>(5));
+  EXPECT_TRUE(Res.second);
+  EXPECT_EQ(5, *Res.first->second);
+
+  auto P = std::make_unique<int>(6);
+  Res = Map.try_emplace(1, std::move(P));
+  EXPECT_FALSE(Res.second);
+  // The value is not moved from if the key is already in the map.
+  EXPECT_TRUE(P != nullptr);
+  EXPECT_EQ(5, *Map.find(1)->second);
+}
+
+TEST(SwissTableMapTest, GrowAndIterate) {
+  SwissTableMap<unsigned, unsigned> Map;
+  const unsigned N = 10000;
+  for (unsigned I = 0; I != N; ++I)
+    Map[I] = I * 2;
+  EXPECT_EQ(N, Map.size());
+
+  std::vector<bool> Seen(N);
+  unsigned Visited = 0;
+  for (const auto &KV : Map) {
+    ASSERT_LT(KV.first, N);
+    EXPECT_EQ(KV.first * 2, KV.second);
+    EXPECT_FALSE(Seen[KV.first]);
+    Seen[KV.first] = true;
+    ++Visited;
+  }
+  EXPECT_EQ(N, Visited);
+
+  for (unsigned I = 0; I != N; ++I)
+    EXPECT_EQ(I * 2, Map.lookup(I));
+  EXPECT_EQ(0u, Map.count(N));
+}
+
+TEST(SwissTableMapTest, ReserveDoesNotRehash) {
+  SwissTableMap<int, int> Map;
+  Map.reserve(1000);
+  const void *Buckets = Map.getPointerIntoBucketsArray();
+  for (int I = 0; I != 1000; ++I)
+    Map[I] = I;
+  EXPECT_EQ(Buckets, Map.getPointerIntoBucketsArray());
+}
+
+TEST(SwissTableMapTest, EraseChurnDoesNotGrow) {
+  // Repeatedly inserting and erasing keys must reuse buckets rather than grow
+  // the table without bound.
+  SwissTableMap<unsigned, unsigned> Map;
+  for (unsigned I = 0; I != 100; ++I)
+    Map[I] = I;
+  size_t MemorySize = Map.getMemorySize();
+  for (unsigned I = 100; I != 100000; ++I) {
+    Map[I] = I;
+    EXPECT_TRUE(Map.erase(I - 100));
+  }
+  EXPECT_EQ(100u, Map.size());
+  EXPECT_EQ(MemorySize, Map.getMemorySize());
+  for (unsigned I = 100000 - 100; I != 100000; ++I)
+    EXPECT_EQ(I, Map.lookup(I));
+}
+
+TEST(SwissTableMapTest, CopyMoveSwap) {
+  SwissTableMap<int, std::string> Map = {{1, "one"}, {2, "two"}};
+  Map.erase(1);
+  Map[3] = "three";
+
+  SwissTableMap<int, std::string> Copy(Map);
+  EXPECT_TRUE(Copy == Map);
+  EXPECT_EQ("three", Copy.lookup(3));
+
+  SwissTableMap<int, std::string> Moved(std::move(Copy));
+  EXPECT_TRUE(Copy.empty());
+  EXPECT_TRUE(Moved == Map);
+
+  SwissTableMap<int, std::string> Other;
+  Other[4] = "four";
+  Other.swap(Moved);
+  EXPECT_EQ(1u, Moved.size());
+  EXPECT_EQ("four", Moved.lookup(4));
+  EXPECT_TRUE(Other == Map);
+
+  Other = Moved;
+  EXPECT_TRUE(Other == Moved);
+  EXPECT_TRUE(Other != Map);
+
+  Other.clear();
+  EXPECT_TRUE(Other.empty());
+  EXPECT_EQ(0u, Other.count(4));
+}
+
+// A key info that only provides a hash and an equality, with every key
+// colliding, to exercise probing across groups.
+struct CollidingKeyInfo {
+  static unsigned getHashValue(int) { return 0; }
+  static bool isEqual(int LHS, int RHS) { return LHS == RHS; }
+};
+
+TEST(SwissTableMapTest, CollidingKeys) {
+  SwissTableMap<int, int, CollidingKeyInfo> Map;
+  for (int I = 0; I != 100; ++I)
+    Map[I] = -I;
+  for (int I = 0; I != 100; I += 2)
+    EXPECT_TRUE(Map.erase(I));
+  for (int I = 0; I != 100; ++I)
+    EXPECT_EQ(I % 2 ? 1u : 0u, Map.count(I));
+  for (int I = 0; I != 100; I += 2)
+    Map[I] = I;
+  EXPECT_EQ(100u, Map.size());
+  for (int I = 0; I != 100; ++I)
+    EXPECT_EQ(I % 2 ? -I : I, Map.lookup(I));
+}
+
+TEST(SwissTableMapTest, RandomOperations) {
+  SwissTableMap<int, int> Map;
+  std::map<int, int> Reference;
+  std::mt19937 Gen(42);
+  std::uniform_int_distribution<int> KeyDist(0, 2000);
+  for (unsigned Step = 0; Step != 50000; ++Step) {
+    int Key = KeyDist(Gen);
+    switch (Gen() % 3) {
+    case 0:
+      EXPECT_EQ(Reference.insert({Key, Step}).second,
+                Map.insert({Key, int(Step)}).second);
+      break;
+    case 1:
+      EXPECT_EQ(Reference.erase(Key) == 1, Map.erase(Key));
+      break;
+    case 2:
+      EXPECT_EQ(Reference.count(Key), Map.count(Key));
+      break;
+    }
+  }
+  EXPECT_EQ(Reference.size(), Map.size());
+  for (const auto &KV : Reference)
+    EXPECT_EQ(KV.second, Map.lookup(KV.first));
+}
+
+} // end anonymous namespace
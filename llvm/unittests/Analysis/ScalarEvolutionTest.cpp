@@ -22,6 +22,7 @@
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/SourceMgr.h"
 #include "gtest/gtest.h"
 
@@ -1467,4 +1468,143 @@ TEST_F(ScalarEvolutionsTest, MatchURem) {
   });
 }
 
+TEST_F(ScalarEvolutionsTest, ForgetLoopDispositionsInLoopNest) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "define void @foo(i32 %a, i32 %b, i32 %n) { "
+      "entry: "
+      "  br label %loop1 "
+      "loop1: "
+      "  %iv1 = phi i32 [ 0, %entry ], [ %iv1.inc, %loop1 ] "
+      "  %x = xor i32 %a, %b "
+      "  %iv1.inc = add i32 %iv1, 1 "
+      "  %c1 = icmp slt i32 %iv1.inc, %n "
+      "  br i1 %c1, label %loop1, label %mid "
+      "mid: "
+      "  br label %loop2 "
+      "loop2: "
+      "  %iv2 = phi i32 [ 0, %mid ], [ %iv2.inc, %loop2 ] "
+      "  %iv2.inc = add i32 %iv2, 1 "
+      "  %c2 = icmp slt i32 %iv2.inc, %n "
+      "  br i1 %c2, label %loop2, label %exit "
+      "exit: "
+      "  ret void "
+      "} ",
+      Err, C);
+
+  ASSERT_TRUE(M && "Could not parse module?");
+  ASSERT_TRUE(!verifyModule(*M) && "Must have been well formed!");
+
+  runWithSE(*M, "foo", [&](Function &F, LoopInfo &LI, ScalarEvolution &SE) {
+    auto *X = getInstructionByName(F, "x");
+    Loop *L1 = LI.getLoopFor(X->getParent());
+    Loop *L2 = LI.getLoopFor(getInstructionByName(F, "iv2")->getParent());
+    const SCEV *IV1 = SE.getSCEV(getInstructionByName(F, "iv1"));
+
+    // %x is treated as an opaque value, so its disposition depends on where
+    // it is defined.
+    const SCEV *S = SE.getSCEV(X);
+    EXPECT_EQ(SE.getLoopDisposition(S, L1), ScalarEvolution::LoopVariant);
+    EXPECT_EQ(SE.getLoopDisposition(S, L2), ScalarEvolution::LoopInvariant);
+    EXPECT_EQ(SE.getLoopDisposition(IV1, L2), ScalarEvolution::LoopInvariant);
+
+    // Hoist %x out of the loop, like LICM does.
+    X->moveBefore(L1->getLoopPreheader()->getTerminator());
+    SE.forgetLoopDispositions(L1);
+    EXPECT_EQ(SE.getLoopDisposition(S, L1), ScalarEvolution::LoopInvariant);
+    EXPECT_EQ(SE.getLoopDisposition(S, L2), ScalarEvolution::LoopInvariant);
+    EXPECT_EQ(SE.getLoopDisposition(IV1, L1), ScalarEvolution::LoopComputable);
+    EXPECT_EQ(SE.getLoopDisposition(IV1, L2), ScalarEvolution::LoopInvariant);
+  });
+}
+
+TEST_F(ScalarEvolutionsTest, TrimCaches) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "define i32 @foo(i32 %a, i32 %n) { "
+      "entry: "
+      "  br label %loop "
+      "loop: "
+      "  %iv = phi i32 [ 0, %entry ], [ %iv.inc, %loop ] "
+      "  %acc = phi i32 [ %a, %entry ], [ %acc.inc, %loop ] "
+      "  %x = shl i32 %iv, 2 "
+      "  %y = and i32 %x, 1020 "
+      "  %acc.inc = add i32 %acc, %y "
+      "  %iv.inc = add nuw nsw i32 %iv, 1 "
+      "  %c = icmp ult i32 %iv.inc, 100 "
+      "  br i1 %c, label %loop, label %exit "
+      "exit: "
+      "  %r = add i32 %acc.inc, %x "
+      "  ret i32 %r "
+      "} ",
+      Err, C);
+
+  ASSERT_TRUE(M && "Could not parse module?");
+  ASSERT_TRUE(!verifyModule(*M) && "Must have been well formed!");
+
+  auto *Budget = static_cast<cl::opt<unsigned> *>(
+      cl::getRegisteredOptions()["scalar-evolution-cache-budget"]);
+  ASSERT_NE(Budget, nullptr);
+
+  runWithSE(*M, "foo", [&](Function &F, LoopInfo &LI, ScalarEvolution &SE) {
+    Loop *L = LI.getLoopFor(getInstructionByName(F, "iv")->getParent());
+
+    // Query everything that trimCaches may drop, and return the results.
+    struct Results {
+      const SCEV *S, *AtScope;
+      ConstantRange Unsigned, Signed;
+      ScalarEvolution::LoopDisposition LoopDisp;
+      ScalarEvolution::BlockDisposition BlockDisp;
+      uint32_t TrailingZeros;
+      bool HasRec;
+    };
+    auto Query = [&]() {
+      std::vector<Results> All;
+      for (Instruction &I : instructions(F)) {
+        if (!SE.isSCEVable(I.getType()))
+          continue;
+        const SCEV *S = SE.getSCEV(&I);
+        All.push_back({S, SE.getSCEVAtScope(S, nullptr),
+                       SE.getUnsignedRange(S), SE.getSignedRange(S),
+                       SE.getLoopDisposition(S, L),
+                       SE.getBlockDisposition(S, L->getHeader()),
+                       SE.GetMinTrailingZeros(S),
+                       SE.containsAddRecurrence(S)});
+      }
+      return All;
+    };
+
+    std::vector<Results> Before = Query();
+    size_t Size = SE.getTrimmableCacheSize();
+    ASSERT_GT(Size, 1024u);
+
+    // Without a budget nothing is dropped.
+    SE.trimCaches();
+    EXPECT_EQ(SE.getTrimmableCacheSize(), Size);
+
+    // The caches take more than 1 KiB, so they are all dropped.
+    *Budget = 1;
+    SE.trimCaches();
+    *Budget = 0;
+    EXPECT_LT(SE.getTrimmableCacheSize(), Size);
+    EXPECT_EQ(SE.getTrimmableCacheSize(), 0u);
+
+    // The results computed again are the same.
+    std::vector<Results> After = Query();
+    ASSERT_EQ(Before.size(), After.size());
+    for (size_t I = 0; I != Before.size(); ++I) {
+      EXPECT_EQ(Before[I].S, After[I].S);
+      EXPECT_EQ(Before[I].AtScope, After[I].AtScope);
+      EXPECT_EQ(Before[I].Unsigned, After[I].Unsigned);
+      EXPECT_EQ(Before[I].Signed, After[I].Signed);
+      EXPECT_EQ(Before[I].LoopDisp, After[I].LoopDisp);
+      EXPECT_EQ(Before[I].BlockDisp, After[I].BlockDisp);
+      EXPECT_EQ(Before[I].TrailingZeros, After[I].TrailingZeros);
+      EXPECT_EQ(Before[I].HasRec, After[I].HasRec);
+    }
+  });
+}
+
 }  // end namespace llvm
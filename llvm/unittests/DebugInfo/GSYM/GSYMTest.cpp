@@ -1252,6 +1252,68 @@ TEST(GSYMTest, TestGsymCreator8ByteAddrOffsets) {
                    ArrayRef<uint8_t>(UUID));
 }
 
+static void AddSpillTestFunctions(GsymCreator &GC) {
+  const uint32_t FileIdx = GC.insertFile("/tmp/main.c");
+  const uint32_t Names[] = {GC.insertString("foo"), GC.insertString("bar"),
+                            GC.insertString("baz")};
+  AddressRanges TextRanges;
+  TextRanges.insert(AddressRange(0x1000, 0x20000));
+  GC.SetValidTextRanges(TextRanges);
+  // Add functions in an order that doesn't match their addresses, along with
+  // duplicates, symbols that are covered by functions with debug info,
+  // overlapping functions and a symbol without a size at the end, so that
+  // all the cases finalize() handles show up across the spilled runs.
+  for (uint64_t I = 0; I < 64; ++I) {
+    const uint64_t Addr = 0x1000 + ((I * 37) % 64) * 0x200;
+    const uint32_t Name = Names[I % 3];
+    FunctionInfo FI(Addr, 0x200, Name);
+    if (I % 2)
+      AddLines(Addr, FileIdx, FI);
+    if (I % 5 == 0)
+      AddInline(Addr, 0x200, FI);
+    GC.addFunctionInfo(FunctionInfo(FI));
+    if (I % 4 == 0)
+      GC.addFunctionInfo(FunctionInfo(Addr, 0x200, Name));
+    if (I % 6 == 0)
+      GC.addFunctionInfo(FunctionInfo(FI));
+    if (I % 7 == 0)
+      GC.addFunctionInfo(FunctionInfo(Addr + 0x10, 0, Name));
+    if (I % 9 == 0)
+      GC.addFunctionInfo(FunctionInfo(Addr + 0x100, 0x200, Name));
+  }
+  GC.addFunctionInfo(FunctionInfo(0x10000, 0, Names[0]));
+}
+
+TEST(GSYMTest, TestGsymCreatorSpilling) {
+  // Verify that spilling function infos to disk and merging them back
+  // produces the same GSYM data and log as keeping all of them in memory.
+  GsymCreator InMemory;
+  AddSpillTestFunctions(InMemory);
+  std::string InMemoryLog;
+  raw_string_ostream InMemoryOS(InMemoryLog);
+  ASSERT_THAT_ERROR(InMemory.finalize(InMemoryOS), Succeeded());
+  SmallString<512> InMemoryData;
+  raw_svector_ostream InMemoryStrm(InMemoryData);
+  FileWriter InMemoryFW(InMemoryStrm, llvm::support::little);
+  ASSERT_THAT_ERROR(InMemory.encode(InMemoryFW), Succeeded());
+
+  for (size_t MaxFuncs : {1, 3, 16, 1000}) {
+    GsymCreator Spilled;
+    Spilled.setMaxFunctionInfosInMemory(MaxFuncs);
+    AddSpillTestFunctions(Spilled);
+    std::string SpilledLog;
+    raw_string_ostream SpilledOS(SpilledLog);
+    ASSERT_THAT_ERROR(Spilled.finalize(SpilledOS), Succeeded());
+    EXPECT_EQ(InMemoryOS.str(), SpilledOS.str());
+    EXPECT_EQ(InMemory.getNumFunctionInfos(), Spilled.getNumFunctionInfos());
+    SmallString<512> SpilledData;
+    raw_svector_ostream SpilledStrm(SpilledData);
+    FileWriter SpilledFW(SpilledStrm, llvm::support::little);
+    ASSERT_THAT_ERROR(Spilled.encode(SpilledFW), Succeeded());
+    EXPECT_EQ(InMemoryData, SpilledData);
+  }
+}
+
 static void VerifyFunctionInfo(const GsymReader &GR, uint64_t Addr,
                                const FunctionInfo &FI) {
   auto ExpFI = GR.getFunctionInfo(Addr);
@@ -1455,6 +1455,35 @@ TEST_F(FileCheckTest, Match) {
                        Succeeded());
 }
 
+TEST_F(FileCheckTest, MatchRequiredLiteral) {
+  PatternTester Tester;
+
+  // Check a regex pattern is only matched on a line containing its literal.
+  ASSERT_FALSE(Tester.parsePattern("foo{{[0-9]+}}bar"));
+  expectNotFoundError(Tester.match("nothing to see").takeError());
+  expectNotFoundError(Tester.match("foo12baz\nbar").takeError());
+  EXPECT_THAT_EXPECTED(Tester.match("foo1baz\nfoo12bar"), HasValue(8));
+
+  // Check anchors still match at line boundaries.
+  Tester.initNextPattern();
+  ASSERT_FALSE(Tester.parsePattern("{{^}}foo{{$}}"));
+  expectNotFoundError(Tester.match("afoo\nfoob").takeError());
+  EXPECT_THAT_EXPECTED(Tester.match("afoo\nfoo\n"), HasValue(5));
+
+  // Check a regex able to match a newline is matched across lines.
+  Tester.initNextPattern();
+  ASSERT_FALSE(Tester.parsePattern("foo{{[[:space:]]+}}bar"));
+  EXPECT_THAT_EXPECTED(Tester.match("xfoo\nbar"), HasValue(1));
+
+  // Check the same for a collating element naming the newline.
+  Tester.initNextPattern();
+  ASSERT_FALSE(Tester.parsePattern("foo{{[[.newline.]]}}bar"));
+  EXPECT_THAT_EXPECTED(Tester.match("xfoo\nbar"), HasValue(1));
+  Tester.initNextPattern();
+  ASSERT_FALSE(Tester.parsePattern("foo{{[[.LF.]]}}bar"));
+  EXPECT_THAT_EXPECTED(Tester.match("xfoo\nbar"), HasValue(1));
+}
+
 TEST_F(FileCheckTest, MatchParen) {
   PatternTester Tester;
   // Check simple parenthesized expressions
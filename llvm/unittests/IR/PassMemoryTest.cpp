@@ -0,0 +1,145 @@
+//===- unittests/IR/PassMemoryTest.cpp - PassMemoryHandler tests ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassInstrumentation.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/Passes/StandardInstrumentations.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class MemPass1 : public PassInfoMixin<MemPass1> {};
+class MemPass2 : public PassInfoMixin<MemPass2> {};
+
+TEST(PassMemoryTest, CustomOut) {
+  PassInstrumentationCallbacks PIC;
+  PassInstrumentation PI(&PIC);
+
+  LLVMContext Context;
+  Module M("TestModule", Context);
+  Function *F = Function::Create(
+      FunctionType::get(Type::getVoidTy(Context), /*isVarArg=*/false),
+      GlobalValue::ExternalLinkage, "memfunc", M);
+  MemPass1 Pass1;
+  MemPass2 Pass2;
+
+  SmallString<0> ReportStr;
+  raw_svector_ostream ReportStream(ReportStr);
+
+  auto PassMemory = std::make_unique<PassMemoryHandler>(true);
+  PassMemory->setOutStream(ReportStream);
+  PassMemory->registerCallbacks(PIC);
+
+  // Pretend that the passes are running, with Pass2 nested in Pass1 and run
+  // on a function.
+  PI.runBeforePass(Pass1, M);
+  PI.runBeforePass(Pass2, *F);
+  PI.runAfterPass(Pass2, *F, PreservedAnalyses::all());
+  PI.runAfterPass(Pass1, M, PreservedAnalyses::all());
+
+  PassMemory->print();
+
+  // Both passes are reported, and the function Pass2 ran on is listed.
+  EXPECT_TRUE(ReportStr.str().contains("Pass memory usage report"));
+  EXPECT_TRUE(ReportStr.str().contains("Max growth"));
+  EXPECT_TRUE(ReportStr.str().contains("MemPass1"));
+  EXPECT_TRUE(ReportStr.str().contains("MemPass2"));
+  EXPECT_TRUE(ReportStr.str().contains("memfunc"));
+
+  // Printing again without running any passes emits nothing.
+  ReportStr.clear();
+  PassMemory->print();
+  EXPECT_TRUE(ReportStr.empty());
+
+  // A pass that was not run since the last report is not listed, and the
+  // destructor prints what is left.
+  PI.runBeforePass(Pass2, M);
+  PI.runAfterPass(Pass2, M, PreservedAnalyses::all());
+  PassMemory.reset();
+
+  EXPECT_TRUE(ReportStr.str().contains("Pass memory usage report"));
+  EXPECT_FALSE(ReportStr.str().contains("MemPass1"));
+  EXPECT_TRUE(ReportStr.str().contains("MemPass2"));
+  EXPECT_FALSE(ReportStr.str().contains("memfunc"));
+}
+
+TEST(PassMemoryTest, UnbalancedCallbacks) {
+  PassInstrumentationCallbacks PIC;
+  PassInstrumentation PI(&PIC);
+
+  LLVMContext Context;
+  Module M("TestModule", Context);
+  MemPass1 Pass1;
+  MemPass2 Pass2;
+
+  SmallString<0> ReportStr;
+  raw_svector_ostream ReportStream(ReportStr);
+
+  PassMemoryHandler PassMemory(true);
+  PassMemory.setOutStream(ReportStream);
+  PassMemory.registerCallbacks(PIC);
+
+  // An after-callback without a matching before-callback is ignored.
+  PI.runAfterPass(Pass2, M, PreservedAnalyses::all());
+  PassMemory.print();
+  EXPECT_TRUE(ReportStr.empty());
+
+  // A skipped pass gets no callbacks and is not reported.
+  bool SkipPass2 = true;
+  PIC.registerShouldRunOptionalPassCallback([&](StringRef P, Any) {
+    return !SkipPass2 || P != "MemPass2";
+  });
+  PI.runBeforePass(Pass1, M);
+  EXPECT_FALSE(PI.runBeforePass(Pass2, M));
+  PI.runAfterPass(Pass1, M, PreservedAnalyses::all());
+  PassMemory.print();
+  EXPECT_TRUE(ReportStr.str().contains("MemPass1"));
+  EXPECT_FALSE(ReportStr.str().contains("MemPass2"));
+
+  // A nested run whose after-callback never comes is dropped when the run
+  // around it ends, and doesn't stop that run from being reported.
+  SkipPass2 = false;
+  ReportStr.clear();
+  PI.runBeforePass(Pass1, M);
+  PI.runBeforePass(Pass2, M);
+  PI.runAfterPassInvalidated<Module>(Pass1, PreservedAnalyses::none());
+  PI.runAfterPass(Pass2, M, PreservedAnalyses::all());
+  PassMemory.print();
+  EXPECT_TRUE(ReportStr.str().contains("MemPass1"));
+  EXPECT_FALSE(ReportStr.str().contains("MemPass2"));
+}
+
+TEST(PassMemoryTest, Disabled) {
+  PassInstrumentationCallbacks PIC;
+  PassInstrumentation PI(&PIC);
+
+  LLVMContext Context;
+  Module M("TestModule", Context);
+  MemPass1 Pass1;
+
+  SmallString<0> ReportStr;
+  raw_svector_ostream ReportStream(ReportStr);
+  {
+    PassMemoryHandler PassMemory(false);
+    PassMemory.setOutStream(ReportStream);
+    PassMemory.registerCallbacks(PIC);
+    PI.runBeforePass(Pass1, M);
+    PI.runAfterPass(Pass1, M, PreservedAnalyses::all());
+  }
+  EXPECT_TRUE(ReportStr.empty());
+}
+
+} // end anonymous namespace
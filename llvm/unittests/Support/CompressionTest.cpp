@@ -16,6 +16,7 @@
 #include "llvm/Config/config.h"
 #include "llvm/Support/Error.h"
 #include "gtest/gtest.h"
+#include <string>
 
 using namespace llvm;
 
@@ -65,6 +66,35 @@ TEST(CompressionTest, Zlib) {
   TestZlibCompression(BinaryDataStr, zlib::DefaultCompression);
 }
 
+TEST(CompressionTest, ZlibParallel) {
+  // Build an input that spans several chunks, with a last partial chunk.
+  std::string Input;
+  for (unsigned I = 0; Input.size() < 10000; ++I)
+    Input += "line " + std::to_string(I % 97) + " of the input\n";
+  const size_t ChunkSize = 1024;
+
+  for (int Level : {zlib::NoCompression, zlib::BestSpeedCompression,
+                    zlib::DefaultCompression, zlib::BestSizeCompression}) {
+    SmallString<32> Compressed;
+    SmallString<32> Uncompressed;
+    Error E = zlib::parallelCompress(Input, Compressed, Level, ChunkSize);
+    EXPECT_FALSE(E);
+    consumeError(std::move(E));
+
+    E = zlib::uncompress(Compressed, Uncompressed, Input.size());
+    EXPECT_FALSE(E);
+    consumeError(std::move(E));
+    EXPECT_EQ(Input, Uncompressed);
+  }
+
+  // Inputs that fit in a single chunk are compressed like compress does.
+  SmallString<32> Parallel;
+  SmallString<32> Serial;
+  EXPECT_FALSE(zlib::parallelCompress("hello, world!", Parallel));
+  EXPECT_FALSE(zlib::compress("hello, world!", Serial));
+  EXPECT_EQ(Serial, Parallel);
+}
+
 TEST(CompressionTest, ZlibCRC32) {
   EXPECT_EQ(
       0x414FA339U,
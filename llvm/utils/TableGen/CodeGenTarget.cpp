@@ -512,8 +512,11 @@ bool CodeGenTarget::isLittleEndianEncoding() const {
 /// reverseBitsForLittleEndianEncoding - For little-endian instruction bit
 /// encodings, reverse the bit order of all instructions.
 void CodeGenTarget::reverseBitsForLittleEndianEncoding() {
-  if (!isLittleEndianEncoding())
+  // The records are updated in place, so when several backends are run on the
+  // same records (see -extra-output), only the first one may reverse them.
+  if (!isLittleEndianEncoding() || Records.areEncodingsReversed())
     return;
+  Records.setEncodingsReversed();
 
   std::vector<Record *> Insts =
       Records.getAllDerivedDefinitions("InstructionEncoding");
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "TableGenBackends.h" // Declares all backends.
+#include "llvm/ADT/SmallSet.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/TableGen/Main.h"
@@ -140,13 +141,19 @@ cl::opt<ActionType> Action(
         clEnumValN(GenDirectivesEnumImpl, "gen-directive-impl",
                    "Generate directive related implementation code")));
 
+cl::list<std::string> ExtraOutputs(
+    "extra-output",
+    cl::desc("Also run the backend for <action> on the parsed records and "
+             "write its output to <file>"),
+    cl::value_desc("action=file"), cl::CommaSeparated);
+
 cl::OptionCategory PrintEnumsCat("Options for -print-enums");
 cl::opt<std::string> Class("class", cl::desc("Print Enum list for this class"),
                            cl::value_desc("class name"),
                            cl::cat(PrintEnumsCat));
 
-bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
-  switch (Action) {
+bool runAction(ActionType A, raw_ostream &OS, RecordKeeper &Records) {
+  switch (A) {
   case PrintRecords:
     OS << Records;              // No argument, dump all contents
     break;
@@ -276,13 +283,43 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
 
   return false;
 }
+
+bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
+  return runAction(Action, OS, Records);
+}
 }
 
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
   cl::ParseCommandLineOptions(argc, argv);
 
-  return TableGenMain(argv[0], &LLVMTableGenMain);
+  // Parse the -extra-output=<action>=<file> arguments. Each action may only be
+  // run once, as some backends update the records they are run on.
+  std::vector<TableGenOutput> Outputs;
+  SmallSet<ActionType, 4> SeenActions;
+  SeenActions.insert(Action);
+  for (StringRef Arg : ExtraOutputs) {
+    StringRef Name, Filename;
+    std::tie(Name, Filename) = Arg.split('=');
+    if (Filename.empty()) {
+      errs() << argv[0] << ": -extra-output '" << Arg
+             << "' does not name an output file\n";
+      return 1;
+    }
+    ActionType A;
+    if (Action.getParser().parse(ExtraOutputs, Name.ltrim('-'), "", A))
+      return 1;
+    if (!SeenActions.insert(A).second) {
+      errs() << argv[0] << ": action '" << Name
+             << "' is requested more than once\n";
+      return 1;
+    }
+    Outputs.push_back({Filename.str(), [A](raw_ostream &OS, RecordKeeper &RK) {
+                         return runAction(A, OS, RK);
+                       }});
+  }
+
+  return TableGenMain(argv[0], &LLVMTableGenMain, Outputs);
 }
 
 #ifndef __has_feature
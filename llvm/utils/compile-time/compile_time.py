@@ -0,0 +1,418 @@
+#!/usr/bin/env python3
+"""Compile time and memory benchmarks for clang, opt and llc.
+
+This runs the inputs listed in corpus/benchmarks.json through the tools with
+time tracing enabled, collects the wall time, user+system time and maximum
+resident set size of each run along with the per-phase and per-pass times from
+the time trace, and optionally compares the results against a baseline from an
+earlier run. Textual IR inputs of opt and llc are assembled to bitcode with
+the llvm-as from --bin-dir first. Only the Python standard library is used,
+and nothing is fetched over the network.
+
+Typical use:
+
+  # Record a baseline with the tools of a known good build.
+  compile_time.py run --bin-dir good/bin --output baseline.json
+
+  # Measure a new build and compare it against that baseline.
+  compile_time.py run --bin-dir new/bin --output new.json \\
+      --baseline baseline.json
+
+  # Compare two earlier runs.
+  compile_time.py compare baseline.json new.json
+
+Each benchmark is run several times. A metric is reported as a regression or
+an improvement only if the change in its median exceeds all of a relative
+threshold, an absolute threshold and a multiple of the run-to-run noise,
+which is estimated from the median absolute deviation of both runs.
+"""
+
+import argparse
+import glob
+import json
+import os
+import platform
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+try:
+    import resource
+except ImportError:  # Windows
+    resource = None
+
+FORMAT_VERSION = 1
+CORPUS_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'corpus')
+
+# Metrics recorded for every run besides the phases from the time trace.
+WALL = 'wall_ms'
+CPU = 'cpu_ms'
+MAX_RSS = 'max_rss_kib'
+
+
+def log(msg):
+    print(msg, file=sys.stderr)
+    sys.stderr.flush()
+
+
+def load_manifest(corpus):
+    with open(os.path.join(corpus, 'benchmarks.json')) as f:
+        return json.load(f)['benchmarks']
+
+
+def tool_path(bin_dir, tool):
+    exe = tool + ('.exe' if sys.platform == 'win32' else '')
+    # The tools run in a temporary directory, so the path must be absolute.
+    path = os.path.abspath(os.path.join(bin_dir, exe))
+    return path if os.path.exists(path) else None
+
+
+def tool_version(path):
+    try:
+        out = subprocess.check_output([path, '--version'],
+                                      stderr=subprocess.STDOUT)
+    except (OSError, subprocess.CalledProcessError):
+        return 'unknown'
+    lines = out.decode('utf-8', 'replace').strip().splitlines()
+    return lines[0].strip() if lines else 'unknown'
+
+
+def assemble_bitcode(llvm_as, input_file, bitcode_dir):
+    """Assemble the textual IR in input_file to bitcode in bitcode_dir.
+
+    The corpus keeps IR in textual form so that it can be reviewed and
+    updated, but opt and llc are timed on bitcode, which is what they read in
+    a real build. The llvm-as of the build under test is used, so the bitcode
+    always matches the reader.
+    """
+    name = os.path.splitext(os.path.basename(input_file))[0] + '.bc'
+    output = os.path.join(bitcode_dir, name)
+    if not os.path.exists(output):
+        subprocess.check_call([llvm_as, input_file, '-o', output])
+    return output
+
+
+def command_for(bench, path, input_file, work_dir, granularity):
+    tool = bench['tool']
+    args = list(bench.get('args', []))
+    if tool == 'clang':
+        # clang writes the trace next to its output, or to the working
+        # directory for -fsyntax-only.
+        cmd = [path] + args + ['-ftime-trace',
+                               '-ftime-trace-granularity=%d' % granularity]
+        if '-fsyntax-only' not in args:
+            cmd += ['-o', os.path.join(work_dir, 'out.o')]
+        return cmd + [input_file]
+    if tool in ('opt', 'llc'):
+        out = 'out.bc' if tool == 'opt' else 'out.o'
+        return [path] + args + [
+            '-time-trace', '-time-trace-granularity=%d' % granularity,
+            '-time-trace-file=' + os.path.join(work_dir, 'trace.json'),
+            '-o', os.path.join(work_dir, out), input_file]
+    raise ValueError("unknown tool '%s' in benchmark '%s'" %
+                     (tool, bench['name']))
+
+
+def run_once(cmd, work_dir):
+    """Run cmd in work_dir and return (wall ms, cpu ms, max rss KiB)."""
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, cwd=work_dir, stdout=subprocess.DEVNULL,
+                            stderr=subprocess.PIPE)
+    if resource is not None and hasattr(os, 'wait4'):
+        # Read stderr before waiting so that a chatty tool can't block on a
+        # full pipe, then reap the child with wait4 to get its own rusage.
+        err = proc.stderr.read()
+        _, status, usage = os.wait4(proc.pid, 0)
+        proc.returncode = (os.WEXITSTATUS(status) if os.WIFEXITED(status)
+                           else -os.WTERMSIG(status))
+        cpu_ms = (usage.ru_utime + usage.ru_stime) * 1000.0
+        max_rss = usage.ru_maxrss
+        if sys.platform == 'darwin':
+            max_rss //= 1024  # bytes on macOS, KiB elsewhere
+    else:
+        _, err = proc.communicate()
+        cpu_ms = None
+        max_rss = None
+    wall_ms = (time.perf_counter() - start) * 1000.0
+    if proc.returncode != 0:
+        raise RuntimeError('command failed with exit code %d: %s\n%s' %
+                           (proc.returncode, ' '.join(cmd),
+                            err.decode('utf-8', 'replace')))
+    return wall_ms, cpu_ms, max_rss
+
+
+def parse_trace(work_dir):
+    """Return {phase: ms} from the time trace written to work_dir.
+
+    The "Total <name>" events that the time profiler emits give the time
+    spent in each kind of event, such as "Total Frontend" or "Total
+    InstCombinePass". The legacy pass manager reports all of its passes as
+    "RunPass" events, so those are added up per pass name instead.
+    """
+    traces = glob.glob(os.path.join(work_dir, '*.json')) + \
+        glob.glob(os.path.join(work_dir, '.*.json'))
+    if not traces:
+        return {}
+    with open(traces[0]) as f:
+        events = json.load(f).get('traceEvents', [])
+    phases = {}
+    for event in events:
+        if event.get('ph') != 'X':
+            continue
+        name = event.get('name', '')
+        dur_ms = event.get('dur', 0) / 1000.0
+        if name.startswith('Total '):
+            phases[name[len('Total '):]] = dur_ms
+        elif name == 'RunPass':
+            detail = event.get('args', {}).get('detail', '')
+            key = 'RunPass: ' + detail
+            phases[key] = phases.get(key, 0.0) + dur_ms
+    return phases
+
+
+def run_benchmarks(args):
+    manifest = load_manifest(args.corpus)
+    name_filter = re.compile(args.filter) if args.filter else None
+    results = {
+        'format': FORMAT_VERSION,
+        'host': platform.platform(),
+        'repeat': args.repeat,
+        'tools': {},
+        'benchmarks': {},
+    }
+    llvm_as = tool_path(args.bin_dir, 'llvm-as')
+    bitcode_dir = tempfile.mkdtemp(prefix='compile-time-bc-')
+    try:
+        for bench in manifest:
+            name = bench['name']
+            if name_filter and not name_filter.search(name):
+                continue
+            tool = bench['tool']
+            path = tool_path(args.bin_dir, tool)
+            if not path:
+                log("skipping '%s': %s not found in %s" %
+                    (name, tool, args.bin_dir))
+                continue
+            if tool not in results['tools']:
+                results['tools'][tool] = tool_version(path)
+            input_file = os.path.abspath(
+                os.path.join(args.corpus, bench['input']))
+            if tool in ('opt', 'llc') and input_file.endswith('.ll'):
+                if not llvm_as:
+                    log("skipping '%s': llvm-as not found in %s" %
+                        (name, args.bin_dir))
+                    continue
+                input_file = assemble_bitcode(llvm_as, input_file, bitcode_dir)
+            samples = {WALL: [], CPU: [], MAX_RSS: [], 'phases': {}}
+            log("running '%s'" % name)
+            for i in range(args.warmup + args.repeat):
+                work_dir = tempfile.mkdtemp(prefix='compile-time-')
+                try:
+                    cmd = command_for(bench, path, input_file, work_dir,
+                                      args.granularity)
+                    wall_ms, cpu_ms, max_rss = run_once(cmd, work_dir)
+                    phases = parse_trace(work_dir)
+                finally:
+                    shutil.rmtree(work_dir, ignore_errors=True)
+                if i < args.warmup:
+                    continue
+                samples[WALL].append(wall_ms)
+                if cpu_ms is not None:
+                    samples[CPU].append(cpu_ms)
+                if max_rss is not None:
+                    samples[MAX_RSS].append(max_rss)
+                for phase, ms in phases.items():
+                    samples['phases'].setdefault(phase, []).append(ms)
+            results['benchmarks'][name] = samples
+    finally:
+        shutil.rmtree(bitcode_dir, ignore_errors=True)
+    return results
+
+
+def median(values):
+    values = sorted(values)
+    n = len(values)
+    if n == 0:
+        return None
+    mid = n // 2
+    return values[mid] if n % 2 else (values[mid - 1] + values[mid]) / 2.0
+
+
+def noise(values):
+    """Estimate the standard deviation from the median absolute deviation."""
+    m = median(values)
+    return 1.4826 * median([abs(v - m) for v in values]) if values else 0.0
+
+
+class Thresholds(object):
+    def __init__(self, args):
+        self.time_rel = args.time_threshold / 100.0
+        self.time_abs = args.min_time_change
+        self.mem_rel = args.memory_threshold / 100.0
+        self.mem_abs = args.min_memory_change
+        self.sigmas = args.noise_sigmas
+        self.min_phase = args.min_phase_time
+
+    def compare(self, metric, old, new):
+        """Return the relative change if it is significant, else None."""
+        old_m, new_m = median(old), median(new)
+        if old_m is None or new_m is None:
+            return None
+        if metric == MAX_RSS:
+            rel, absolute = self.mem_rel, self.mem_abs
+        else:
+            rel, absolute = self.time_rel, self.time_abs
+        limit = max(rel * old_m, absolute,
+                    self.sigmas * max(noise(old), noise(new)))
+        if abs(new_m - old_m) <= limit:
+            return None
+        return (new_m - old_m) / old_m if old_m else float('inf')
+
+
+def compare_results(old, new, args):
+    """Print the significant changes and return the number of regressions."""
+    thresholds = Thresholds(args)
+    regressions = 0
+    rows = []
+    for name in sorted(new['benchmarks']):
+        if name not in old['benchmarks']:
+            log("'%s' is not in the baseline" % name)
+            continue
+        old_b, new_b = old['benchmarks'][name], new['benchmarks'][name]
+        metrics = [(m, old_b.get(m, []), new_b.get(m, []))
+                   for m in (WALL, CPU, MAX_RSS)]
+        for phase, samples in sorted(new_b.get('phases', {}).items()):
+            old_samples = old_b.get('phases', {}).get(phase)
+            # Skip phases that are too short to measure reliably.
+            if not old_samples or median(old_samples) < thresholds.min_phase:
+                continue
+            metrics.append(('phase: ' + phase, old_samples, samples))
+        for metric, old_samples, new_samples in metrics:
+            change = thresholds.compare(metric, old_samples, new_samples)
+            if change is None:
+                continue
+            if change > 0:
+                regressions += 1
+            rows.append((name, metric, median(old_samples),
+                         median(new_samples), change))
+
+    if not rows:
+        print('No significant changes.')
+        return 0
+    print('%-24s %-40s %12s %12s %8s' %
+          ('Benchmark', 'Metric', 'Baseline', 'Current', 'Change'))
+    for name, metric, old_m, new_m, change in rows:
+        print('%-24s %-40s %12.1f %12.1f %+7.1f%%' %
+              (name, metric[:40], old_m, new_m, change * 100.0))
+    print('%d regression(s), %d improvement(s).' %
+          (regressions, len(rows) - regressions))
+    return regressions
+
+
+def print_summary(results):
+    print('%-24s %12s %12s %14s' %
+          ('Benchmark', 'Wall (ms)', 'CPU (ms)', 'Max RSS (KiB)'))
+    for name, samples in sorted(results['benchmarks'].items()):
+        cells = []
+        for metric in (WALL, CPU, MAX_RSS):
+            m = median(samples.get(metric, []))
+            cells.append('-' if m is None else '%.1f' % m)
+        print('%-24s %12s %12s %14s' % tuple([name] + cells))
+
+
+def load_results(path):
+    with open(path) as f:
+        results = json.load(f)
+    if results.get('format') != FORMAT_VERSION:
+        raise SystemExit('%s: unsupported results format' % path)
+    return results
+
+
+def add_threshold_options(parser):
+    parser.add_argument('--time-threshold', type=float, default=5.0,
+                        help='relative change in time, in percent, below '
+                        'which changes are ignored (default: %(default)s)')
+    parser.add_argument('--min-time-change', type=float, default=5.0,
+                        help='absolute change in time, in milliseconds, '
+                        'below which changes are ignored (default: '
+                        '%(default)s)')
+    parser.add_argument('--memory-threshold', type=float, default=2.0,
+                        help='relative change in maximum RSS, in percent, '
+                        'below which changes are ignored (default: '
+                        '%(default)s)')
+    parser.add_argument('--min-memory-change', type=float, default=1024,
+                        help='absolute change in maximum RSS, in KiB, below '
+                        'which changes are ignored (default: %(default)s)')
+    parser.add_argument('--noise-sigmas', type=float, default=3.0,
+                        help='ignore changes smaller than this many standard '
+                        'deviations of the run-to-run noise (default: '
+                        '%(default)s)')
+    parser.add_argument('--min-phase-time', type=float, default=10.0,
+                        help='only compare phases that take at least this '
+                        'many milliseconds in the baseline (default: '
+                        '%(default)s)')
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    subparsers = parser.add_subparsers(dest='command')
+
+    run = subparsers.add_parser('run', help='run the benchmarks')
+    run.add_argument('--bin-dir', required=True,
+                     help='directory containing clang, opt and llc')
+    run.add_argument('--corpus', default=CORPUS_DIR,
+                     help='directory containing benchmarks.json and the '
+                     'inputs it refers to (default: %(default)s)')
+    run.add_argument('--repeat', type=int, default=5,
+                     help='number of measured runs of each benchmark '
+                     '(default: %(default)s)')
+    run.add_argument('--warmup', type=int, default=1,
+                     help='number of unmeasured runs before the measured '
+                     'ones (default: %(default)s)')
+    run.add_argument('--granularity', type=int, default=50,
+                     help='time trace granularity in microseconds '
+                     '(default: %(default)s)')
+    run.add_argument('--filter', help='only run benchmarks whose name '
+                     'matches this regular expression')
+    run.add_argument('--output', help='write the results to this file')
+    run.add_argument('--baseline', help='compare the results against the '
+                     'results of an earlier run')
+    add_threshold_options(run)
+
+    compare = subparsers.add_parser('compare',
+                                    help='compare the results of two runs')
+    compare.add_argument('baseline', help='results of the earlier run')
+    compare.add_argument('current', help='results of the later run')
+    add_threshold_options(compare)
+
+    args = parser.parse_args()
+    if args.command == 'run':
+        if args.repeat < 1:
+            parser.error('--repeat must be at least 1')
+        try:
+            results = run_benchmarks(args)
+        except (RuntimeError, ValueError) as e:
+            log('error: %s' % e)
+            return 2
+        if args.output:
+            with open(args.output, 'w') as f:
+                json.dump(results, f, indent=2, sort_keys=True)
+        print_summary(results)
+        if args.baseline:
+            print()
+            return 1 if compare_results(load_results(args.baseline),
+                                        results, args) else 0
+        return 0
+    if args.command == 'compare':
+        return 1 if compare_results(load_results(args.baseline),
+                                    load_results(args.current), args) else 0
+    parser.print_help()
+    return 2
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,288 @@
+// Open-addressing hash table, used as a C compile time benchmark.
+//
+// This file is self-contained: it declares the few types and library
+// functions it uses instead of including system headers, so that the time
+// spent compiling it doesn't depend on the headers installed on the host.
+
+typedef __SIZE_TYPE__ size_t;
+typedef __UINT8_TYPE__ uint8_t;
+typedef __UINT32_TYPE__ uint32_t;
+typedef __UINT64_TYPE__ uint64_t;
+typedef __INT64_TYPE__ int64_t;
+
+void *malloc(size_t size);
+void *calloc(size_t count, size_t size);
+void free(void *ptr);
+void *memcpy(void *dst, const void *src, size_t n);
+void *memset(void *dst, int c, size_t n);
+int memcmp(const void *a, const void *b, size_t n);
+size_t strlen(const char *s);
+int printf(const char *fmt, ...);
+int snprintf(char *buf, size_t size, const char *fmt, ...);
+
+static uint64_t hash_bytes(const void *data, size_t len) {
+  const uint8_t *p = (const uint8_t *)data;
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < len; ++i) {
+    h ^= p[i];
+    h *= 0x100000001b3ULL;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
+}
+
+struct entry {
+  char *key;
+  size_t key_len;
+  int64_t value;
+  uint64_t hash;
+};
+
+struct table {
+  struct entry *entries;
+  size_t capacity;
+  size_t size;
+  size_t tombstones;
+};
+
+static char *const TOMBSTONE = (char *)1;
+
+static int table_init(struct table *t, size_t capacity) {
+  size_t cap = 16;
+  while (cap < capacity)
+    cap <<= 1;
+  t->entries = (struct entry *)calloc(cap, sizeof(struct entry));
+  if (!t->entries)
+    return -1;
+  t->capacity = cap;
+  t->size = 0;
+  t->tombstones = 0;
+  return 0;
+}
+
+static void table_destroy(struct table *t) {
+  for (size_t i = 0; i < t->capacity; ++i)
+    if (t->entries[i].key && t->entries[i].key != TOMBSTONE)
+      free(t->entries[i].key);
+  free(t->entries);
+  t->entries = 0;
+  t->capacity = t->size = t->tombstones = 0;
+}
+
+static struct entry *table_probe(struct entry *entries, size_t capacity,
+                                 const char *key, size_t len, uint64_t hash,
+                                 int for_insert) {
+  size_t mask = capacity - 1;
+  size_t idx = (size_t)hash & mask;
+  struct entry *first_tombstone = 0;
+  for (size_t step = 1;; ++step) {
+    struct entry *e = &entries[idx];
+    if (!e->key)
+      return (for_insert && first_tombstone) ? first_tombstone : e;
+    if (e->key == TOMBSTONE) {
+      if (!first_tombstone)
+        first_tombstone = e;
+    } else if (e->hash == hash && e->key_len == len &&
+               memcmp(e->key, key, len) == 0) {
+      return e;
+    }
+    idx = (idx + step) & mask;
+  }
+}
+
+static int table_grow(struct table *t) {
+  size_t new_capacity = t->capacity * 2;
+  struct entry *entries =
+      (struct entry *)calloc(new_capacity, sizeof(struct entry));
+  if (!entries)
+    return -1;
+  for (size_t i = 0; i < t->capacity; ++i) {
+    struct entry *old = &t->entries[i];
+    if (!old->key || old->key == TOMBSTONE)
+      continue;
+    struct entry *e = table_probe(entries, new_capacity, old->key,
+                                  old->key_len, old->hash, 1);
+    *e = *old;
+  }
+  free(t->entries);
+  t->entries = entries;
+  t->capacity = new_capacity;
+  t->tombstones = 0;
+  return 0;
+}
+
+static int table_put(struct table *t, const char *key, int64_t value) {
+  if ((t->size + t->tombstones + 1) * 4 > t->capacity * 3)
+    if (table_grow(t))
+      return -1;
+  size_t len = strlen(key);
+  uint64_t hash = hash_bytes(key, len);
+  struct entry *e = table_probe(t->entries, t->capacity, key, len, hash, 1);
+  if (e->key && e->key != TOMBSTONE) {
+    e->value = value;
+    return 0;
+  }
+  char *copy = (char *)malloc(len + 1);
+  if (!copy)
+    return -1;
+  memcpy(copy, key, len + 1);
+  if (e->key == TOMBSTONE)
+    --t->tombstones;
+  e->key = copy;
+  e->key_len = len;
+  e->value = value;
+  e->hash = hash;
+  ++t->size;
+  return 0;
+}
+
+static int table_get(const struct table *t, const char *key, int64_t *value) {
+  size_t len = strlen(key);
+  uint64_t hash = hash_bytes(key, len);
+  struct entry *e = table_probe(t->entries, t->capacity, key, len, hash, 0);
+  if (!e->key)
+    return 0;
+  *value = e->value;
+  return 1;
+}
+
+static int table_remove(struct table *t, const char *key) {
+  size_t len = strlen(key);
+  uint64_t hash = hash_bytes(key, len);
+  struct entry *e = table_probe(t->entries, t->capacity, key, len, hash, 0);
+  if (!e->key)
+    return 0;
+  free(e->key);
+  e->key = TOMBSTONE;
+  --t->size;
+  ++t->tombstones;
+  return 1;
+}
+
+static int compare_entries(const struct entry *a, const struct entry *b) {
+  size_t n = a->key_len < b->key_len ? a->key_len : b->key_len;
+  int c = memcmp(a->key, b->key, n);
+  if (c)
+    return c;
+  return a->key_len < b->key_len ? -1 : a->key_len > b->key_len;
+}
+
+static void sort_entries(struct entry *v, size_t n) {
+  /* Bottom-up merge sort with a scratch buffer, falling back to insertion
+     sort for short runs. */
+  const size_t run = 8;
+  for (size_t lo = 0; lo < n; lo += run) {
+    size_t hi = lo + run < n ? lo + run : n;
+    for (size_t i = lo + 1; i < hi; ++i) {
+      struct entry tmp = v[i];
+      size_t j = i;
+      while (j > lo && compare_entries(&v[j - 1], &tmp) > 0) {
+        v[j] = v[j - 1];
+        --j;
+      }
+      v[j] = tmp;
+    }
+  }
+  struct entry *scratch = (struct entry *)malloc(n * sizeof(struct entry));
+  if (!scratch)
+    return;
+  for (size_t width = run; width < n; width *= 2) {
+    for (size_t lo = 0; lo < n; lo += 2 * width) {
+      size_t mid = lo + width < n ? lo + width : n;
+      size_t hi = lo + 2 * width < n ? lo + 2 * width : n;
+      size_t i = lo, j = mid, k = lo;
+      while (i < mid && j < hi)
+        scratch[k++] = compare_entries(&v[i], &v[j]) <= 0 ? v[i++] : v[j++];
+      while (i < mid)
+        scratch[k++] = v[i++];
+      while (j < hi)
+        scratch[k++] = v[j++];
+    }
+    memcpy(v, scratch, n * sizeof(struct entry));
+  }
+  free(scratch);
+}
+
+static size_t table_sorted(const struct table *t, struct entry **out) {
+  struct entry *v = (struct entry *)malloc(t->size * sizeof(struct entry));
+  size_t n = 0;
+  if (!v)
+    return 0;
+  for (size_t i = 0; i < t->capacity; ++i)
+    if (t->entries[i].key && t->entries[i].key != TOMBSTONE)
+      v[n++] = t->entries[i];
+  sort_entries(v, n);
+  *out = v;
+  return n;
+}
+
+static uint32_t crc32_table[256];
+
+static void crc32_init(void) {
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t c = i;
+    for (int k = 0; k < 8; ++k)
+      c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+    crc32_table[i] = c;
+  }
+}
+
+static uint32_t crc32(const void *data, size_t len) {
+  const uint8_t *p = (const uint8_t *)data;
+  uint32_t c = 0xffffffffu;
+  for (size_t i = 0; i < len; ++i)
+    c = crc32_table[(c ^ p[i]) & 0xff] ^ (c >> 8);
+  return c ^ 0xffffffffu;
+}
+
+static void histogram(const struct table *t, size_t *buckets, size_t n) {
+  memset(buckets, 0, n * sizeof(size_t));
+  for (size_t i = 0; i < t->capacity; ++i) {
+    const struct entry *e = &t->entries[i];
+    if (!e->key || e->key == TOMBSTONE)
+      continue;
+    size_t distance = (i - ((size_t)e->hash & (t->capacity - 1))) &
+                      (t->capacity - 1);
+    buckets[distance < n ? distance : n - 1]++;
+  }
+}
+
+int main(int argc, char **argv) {
+  struct table t;
+  char key[32];
+  int64_t sum = 0;
+  (void)argv;
+  if (table_init(&t, 64))
+    return 1;
+  crc32_init();
+  for (int i = 0; i < 100000 + argc; ++i) {
+    snprintf(key, sizeof(key), "key-%d", i * 7919 % 100003);
+    if (table_put(&t, key, i))
+      return 1;
+  }
+  for (int i = 0; i < 100000; i += 3) {
+    snprintf(key, sizeof(key), "key-%d", i * 7919 % 100003);
+    table_remove(&t, key);
+  }
+  for (int i = 0; i < 100000; ++i) {
+    int64_t v;
+    snprintf(key, sizeof(key), "key-%d", i);
+    if (table_get(&t, key, &v))
+      sum += v;
+  }
+  struct entry *sorted;
+  size_t n = table_sorted(&t, &sorted);
+  uint32_t crc = 0;
+  for (size_t i = 0; i < n; ++i)
+    crc ^= crc32(sorted[i].key, sorted[i].key_len);
+  size_t buckets[16];
+  histogram(&t, buckets, 16);
+  for (int i = 0; i < 16; ++i)
+    printf("%2d: %zu\n", i, buckets[i]);
+  printf("%lld %zu %08x\n", (long long)sum, n, crc);
+  free(sorted);
+  table_destroy(&t);
+  return 0;
+}
@@ -0,0 +1,312 @@
+; Unoptimized IR for a few loop kernels, in the shape clang emits at -O0
+; without optnone, so that the optimization pipeline has real work to do.
+
+%struct.matrix = type { float*, i64, i64 }
+
+define void @saxpy(i64 %n, float %a, float* %x, float* %y) {
+entry:
+  %n.addr = alloca i64, align 8
+  %a.addr = alloca float, align 4
+  %x.addr = alloca float*, align 8
+  %y.addr = alloca float*, align 8
+  %i = alloca i64, align 8
+  store i64 %n, i64* %n.addr, align 8
+  store float %a, float* %a.addr, align 4
+  store float* %x, float** %x.addr, align 8
+  store float* %y, float** %y.addr, align 8
+  store i64 0, i64* %i, align 8
+  br label %for.cond
+
+for.cond:
+  %0 = load i64, i64* %i, align 8
+  %1 = load i64, i64* %n.addr, align 8
+  %cmp = icmp ult i64 %0, %1
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:
+  %2 = load float, float* %a.addr, align 4
+  %3 = load float*, float** %x.addr, align 8
+  %4 = load i64, i64* %i, align 8
+  %arrayidx = getelementptr inbounds float, float* %3, i64 %4
+  %5 = load float, float* %arrayidx, align 4
+  %mul = fmul float %2, %5
+  %6 = load float*, float** %y.addr, align 8
+  %7 = load i64, i64* %i, align 8
+  %arrayidx1 = getelementptr inbounds float, float* %6, i64 %7
+  %8 = load float, float* %arrayidx1, align 4
+  %add = fadd float %8, %mul
+  store float %add, float* %arrayidx1, align 4
+  %9 = load i64, i64* %i, align 8
+  %inc = add i64 %9, 1
+  store i64 %inc, i64* %i, align 8
+  br label %for.cond
+
+for.end:
+  ret void
+}
+
+define internal float @matrix_get(%struct.matrix* %m, i64 %r, i64 %c) {
+entry:
+  %m.addr = alloca %struct.matrix*, align 8
+  %r.addr = alloca i64, align 8
+  %c.addr = alloca i64, align 8
+  store %struct.matrix* %m, %struct.matrix** %m.addr, align 8
+  store i64 %r, i64* %r.addr, align 8
+  store i64 %c, i64* %c.addr, align 8
+  %0 = load %struct.matrix*, %struct.matrix** %m.addr, align 8
+  %data = getelementptr inbounds %struct.matrix, %struct.matrix* %0, i32 0, i32 0
+  %1 = load float*, float** %data, align 8
+  %2 = load i64, i64* %r.addr, align 8
+  %cols = getelementptr inbounds %struct.matrix, %struct.matrix* %0, i32 0, i32 2
+  %3 = load i64, i64* %cols, align 8
+  %mul = mul i64 %2, %3
+  %4 = load i64, i64* %c.addr, align 8
+  %add = add i64 %mul, %4
+  %arrayidx = getelementptr inbounds float, float* %1, i64 %add
+  %5 = load float, float* %arrayidx, align 4
+  ret float %5
+}
+
+define void @matmul(%struct.matrix* %a, %struct.matrix* %b, %struct.matrix* %c) {
+entry:
+  %a.addr = alloca %struct.matrix*, align 8
+  %b.addr = alloca %struct.matrix*, align 8
+  %c.addr = alloca %struct.matrix*, align 8
+  %i = alloca i64, align 8
+  %j = alloca i64, align 8
+  %k = alloca i64, align 8
+  %sum = alloca float, align 4
+  store %struct.matrix* %a, %struct.matrix** %a.addr, align 8
+  store %struct.matrix* %b, %struct.matrix** %b.addr, align 8
+  store %struct.matrix* %c, %struct.matrix** %c.addr, align 8
+  store i64 0, i64* %i, align 8
+  br label %for.i
+
+for.i:
+  %0 = load i64, i64* %i, align 8
+  %1 = load %struct.matrix*, %struct.matrix** %a.addr, align 8
+  %rows = getelementptr inbounds %struct.matrix, %struct.matrix* %1, i32 0, i32 1
+  %2 = load i64, i64* %rows, align 8
+  %cmp.i = icmp ult i64 %0, %2
+  br i1 %cmp.i, label %body.i, label %end.i
+
+body.i:
+  store i64 0, i64* %j, align 8
+  br label %for.j
+
+for.j:
+  %3 = load i64, i64* %j, align 8
+  %4 = load %struct.matrix*, %struct.matrix** %b.addr, align 8
+  %cols.b = getelementptr inbounds %struct.matrix, %struct.matrix* %4, i32 0, i32 2
+  %5 = load i64, i64* %cols.b, align 8
+  %cmp.j = icmp ult i64 %3, %5
+  br i1 %cmp.j, label %body.j, label %end.j
+
+body.j:
+  store float 0.000000e+00, float* %sum, align 4
+  store i64 0, i64* %k, align 8
+  br label %for.k
+
+for.k:
+  %6 = load i64, i64* %k, align 8
+  %7 = load %struct.matrix*, %struct.matrix** %a.addr, align 8
+  %cols.a = getelementptr inbounds %struct.matrix, %struct.matrix* %7, i32 0, i32 2
+  %8 = load i64, i64* %cols.a, align 8
+  %cmp.k = icmp ult i64 %6, %8
+  br i1 %cmp.k, label %body.k, label %end.k
+
+body.k:
+  %9 = load %struct.matrix*, %struct.matrix** %a.addr, align 8
+  %10 = load i64, i64* %i, align 8
+  %11 = load i64, i64* %k, align 8
+  %call = call float @matrix_get(%struct.matrix* %9, i64 %10, i64 %11)
+  %12 = load %struct.matrix*, %struct.matrix** %b.addr, align 8
+  %13 = load i64, i64* %k, align 8
+  %14 = load i64, i64* %j, align 8
+  %call1 = call float @matrix_get(%struct.matrix* %12, i64 %13, i64 %14)
+  %mul = fmul float %call, %call1
+  %15 = load float, float* %sum, align 4
+  %add = fadd float %15, %mul
+  store float %add, float* %sum, align 4
+  %16 = load i64, i64* %k, align 8
+  %inc.k = add i64 %16, 1
+  store i64 %inc.k, i64* %k, align 8
+  br label %for.k
+
+end.k:
+  %17 = load float, float* %sum, align 4
+  %18 = load %struct.matrix*, %struct.matrix** %c.addr, align 8
+  %data.c = getelementptr inbounds %struct.matrix, %struct.matrix* %18, i32 0, i32 0
+  %19 = load float*, float** %data.c, align 8
+  %20 = load i64, i64* %i, align 8
+  %cols.c = getelementptr inbounds %struct.matrix, %struct.matrix* %18, i32 0, i32 2
+  %21 = load i64, i64* %cols.c, align 8
+  %mul2 = mul i64 %20, %21
+  %22 = load i64, i64* %j, align 8
+  %add3 = add i64 %mul2, %22
+  %arrayidx = getelementptr inbounds float, float* %19, i64 %add3
+  store float %17, float* %arrayidx, align 4
+  %23 = load i64, i64* %j, align 8
+  %inc.j = add i64 %23, 1
+  store i64 %inc.j, i64* %j, align 8
+  br label %for.j
+
+end.j:
+  %24 = load i64, i64* %i, align 8
+  %inc.i = add i64 %24, 1
+  store i64 %inc.i, i64* %i, align 8
+  br label %for.i
+
+end.i:
+  ret void
+}
+
+define i32 @histogram(i8* %s, i64 %len, i32* %counts) {
+entry:
+  %s.addr = alloca i8*, align 8
+  %len.addr = alloca i64, align 8
+  %counts.addr = alloca i32*, align 8
+  %i = alloca i64, align 8
+  %max = alloca i32, align 4
+  store i8* %s, i8** %s.addr, align 8
+  store i64 %len, i64* %len.addr, align 8
+  store i32* %counts, i32** %counts.addr, align 8
+  store i32 0, i32* %max, align 4
+  store i64 0, i64* %i, align 8
+  br label %for.cond
+
+for.cond:
+  %0 = load i64, i64* %i, align 8
+  %1 = load i64, i64* %len.addr, align 8
+  %cmp = icmp ult i64 %0, %1
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:
+  %2 = load i8*, i8** %s.addr, align 8
+  %3 = load i64, i64* %i, align 8
+  %arrayidx = getelementptr inbounds i8, i8* %2, i64 %3
+  %4 = load i8, i8* %arrayidx, align 1
+  %conv = zext i8 %4 to i64
+  %5 = load i32*, i32** %counts.addr, align 8
+  %arrayidx1 = getelementptr inbounds i32, i32* %5, i64 %conv
+  %6 = load i32, i32* %arrayidx1, align 4
+  %inc = add nsw i32 %6, 1
+  store i32 %inc, i32* %arrayidx1, align 4
+  %7 = load i32, i32* %max, align 4
+  %cmp2 = icmp sgt i32 %inc, %7
+  br i1 %cmp2, label %if.then, label %for.inc
+
+if.then:
+  store i32 %inc, i32* %max, align 4
+  br label %for.inc
+
+for.inc:
+  %8 = load i64, i64* %i, align 8
+  %inc3 = add i64 %8, 1
+  store i64 %inc3, i64* %i, align 8
+  br label %for.cond
+
+for.end:
+  %9 = load i32, i32* %max, align 4
+  ret i32 %9
+}
+
+define i32 @tokenize(i8* %s, i64 %len) {
+entry:
+  %s.addr = alloca i8*, align 8
+  %len.addr = alloca i64, align 8
+  %i = alloca i64, align 8
+  %state = alloca i32, align 4
+  %tokens = alloca i32, align 4
+  store i8* %s, i8** %s.addr, align 8
+  store i64 %len, i64* %len.addr, align 8
+  store i64 0, i64* %i, align 8
+  store i32 0, i32* %state, align 4
+  store i32 0, i32* %tokens, align 4
+  br label %loop
+
+loop:
+  %0 = load i64, i64* %i, align 8
+  %1 = load i64, i64* %len.addr, align 8
+  %cmp = icmp ult i64 %0, %1
+  br i1 %cmp, label %body, label %done
+
+body:
+  %2 = load i8*, i8** %s.addr, align 8
+  %3 = load i64, i64* %i, align 8
+  %arrayidx = getelementptr inbounds i8, i8* %2, i64 %3
+  %4 = load i8, i8* %arrayidx, align 1
+  %5 = load i32, i32* %state, align 4
+  switch i32 %5, label %next [
+    i32 0, label %in.space
+    i32 1, label %in.word
+    i32 2, label %in.number
+    i32 3, label %in.string
+  ]
+
+in.space:
+  switch i8 %4, label %start.word [
+    i8 32, label %next
+    i8 9, label %next
+    i8 10, label %next
+    i8 34, label %start.string
+    i8 48, label %start.number
+    i8 49, label %start.number
+    i8 50, label %start.number
+    i8 51, label %start.number
+    i8 52, label %start.number
+    i8 53, label %start.number
+    i8 54, label %start.number
+    i8 55, label %start.number
+    i8 56, label %start.number
+    i8 57, label %start.number
+  ]
+
+start.word:
+  store i32 1, i32* %state, align 4
+  br label %count
+
+start.number:
+  store i32 2, i32* %state, align 4
+  br label %count
+
+start.string:
+  store i32 3, i32* %state, align 4
+  br label %count
+
+count:
+  %6 = load i32, i32* %tokens, align 4
+  %inc = add nsw i32 %6, 1
+  store i32 %inc, i32* %tokens, align 4
+  br label %next
+
+in.word:
+  switch i8 %4, label %next [
+    i8 32, label %to.space
+    i8 9, label %to.space
+    i8 10, label %to.space
+  ]
+
+in.number:
+  %digit = add i8 %4, -48
+  %isdigit = icmp ult i8 %digit, 10
+  br i1 %isdigit, label %next, label %to.space
+
+in.string:
+  %isquote = icmp eq i8 %4, 34
+  br i1 %isquote, label %to.space, label %next
+
+to.space:
+  store i32 0, i32* %state, align 4
+  br label %next
+
+next:
+  %7 = load i64, i64* %i, align 8
+  %inc1 = add i64 %7, 1
+  store i64 %inc1, i64* %i, align 8
+  br label %loop
+
+done:
+  %8 = load i32, i32* %tokens, align 4
+  ret i32 %8
+}
@@ -0,0 +1,313 @@
+// Template-heavy C++ code, used as a C++ compile time benchmark.
+//
+// This file is self-contained: it declares the few library functions it uses
+// instead of including system headers, so that the time spent compiling it
+// doesn't depend on the headers installed on the host.
+
+typedef decltype(sizeof(0)) size_t;
+extern "C" {
+void *malloc(size_t size);
+void free(void *ptr);
+int printf(const char *fmt, ...);
+}
+inline void *operator new(size_t, void *p) noexcept { return p; }
+
+namespace bench {
+
+template <typename T> struct remove_reference { using type = T; };
+template <typename T> struct remove_reference<T &> { using type = T; };
+template <typename T> struct remove_reference<T &&> { using type = T; };
+
+template <typename T>
+constexpr typename remove_reference<T>::type &&move(T &&t) noexcept {
+  return static_cast<typename remove_reference<T>::type &&>(t);
+}
+
+template <typename T>
+constexpr T &&forward(typename remove_reference<T>::type &t) noexcept {
+  return static_cast<T &&>(t);
+}
+
+template <bool B, typename T = void> struct enable_if {};
+template <typename T> struct enable_if<true, T> { using type = T; };
+
+template <typename A, typename B> struct is_same {
+  static constexpr bool value = false;
+};
+template <typename A> struct is_same<A, A> {
+  static constexpr bool value = true;
+};
+
+template <size_t... Is> struct index_sequence {};
+template <size_t N, size_t... Is>
+struct make_index_sequence_impl
+    : make_index_sequence_impl<N - 1, N - 1, Is...> {};
+template <size_t... Is> struct make_index_sequence_impl<0, Is...> {
+  using type = index_sequence<Is...>;
+};
+template <size_t N>
+using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
+template <typename T> class vector {
+  T *Data = nullptr;
+  size_t Size = 0;
+  size_t Capacity = 0;
+
+  void grow(size_t MinCapacity) {
+    size_t NewCapacity = Capacity ? Capacity * 2 : 4;
+    if (NewCapacity < MinCapacity)
+      NewCapacity = MinCapacity;
+    T *NewData = static_cast<T *>(malloc(NewCapacity * sizeof(T)));
+    for (size_t I = 0; I != Size; ++I) {
+      new (&NewData[I]) T(move(Data[I]));
+      Data[I].~T();
+    }
+    free(Data);
+    Data = NewData;
+    Capacity = NewCapacity;
+  }
+
+public:
+  vector() = default;
+  vector(const vector &Other) {
+    reserve(Other.Size);
+    for (const T &V : Other)
+      push_back(V);
+  }
+  vector(vector &&Other) noexcept
+      : Data(Other.Data), Size(Other.Size), Capacity(Other.Capacity) {
+    Other.Data = nullptr;
+    Other.Size = Other.Capacity = 0;
+  }
+  vector &operator=(vector Other) noexcept {
+    T *D = Data;
+    size_t S = Size, C = Capacity;
+    Data = Other.Data;
+    Size = Other.Size;
+    Capacity = Other.Capacity;
+    Other.Data = D;
+    Other.Size = S;
+    Other.Capacity = C;
+    return *this;
+  }
+  ~vector() {
+    clear();
+    free(Data);
+  }
+
+  void reserve(size_t N) {
+    if (N > Capacity)
+      grow(N);
+  }
+  template <typename... Args> T &emplace_back(Args &&...A) {
+    if (Size == Capacity)
+      grow(Size + 1);
+    new (&Data[Size]) T(forward<Args>(A)...);
+    return Data[Size++];
+  }
+  void push_back(const T &V) { emplace_back(V); }
+  void push_back(T &&V) { emplace_back(move(V)); }
+  void clear() {
+    for (size_t I = 0; I != Size; ++I)
+      Data[I].~T();
+    Size = 0;
+  }
+
+  T *begin() { return Data; }
+  T *end() { return Data + Size; }
+  const T *begin() const { return Data; }
+  const T *end() const { return Data + Size; }
+  size_t size() const { return Size; }
+  T &operator[](size_t I) { return Data[I]; }
+  const T &operator[](size_t I) const { return Data[I]; }
+};
+
+template <size_t I, typename T> struct tuple_leaf {
+  T Value;
+  template <typename U>
+  constexpr tuple_leaf(U &&V) : Value(forward<U>(V)) {}
+};
+
+template <typename Seq, typename... Ts> struct tuple_impl;
+template <size_t... Is, typename... Ts>
+struct tuple_impl<index_sequence<Is...>, Ts...> : tuple_leaf<Is, Ts>... {
+  template <typename... Us>
+  constexpr tuple_impl(Us &&...Vs) : tuple_leaf<Is, Ts>(forward<Us>(Vs))... {}
+};
+
+template <typename... Ts>
+struct tuple : tuple_impl<make_index_sequence<sizeof...(Ts)>, Ts...> {
+  using Base = tuple_impl<make_index_sequence<sizeof...(Ts)>, Ts...>;
+  template <typename... Us>
+  constexpr tuple(Us &&...Vs) : Base(forward<Us>(Vs)...) {}
+};
+
+template <size_t I, typename T> constexpr T &get_leaf(tuple_leaf<I, T> &L) {
+  return L.Value;
+}
+template <size_t I, typename... Ts> constexpr auto &get(tuple<Ts...> &T) {
+  return get_leaf<I>(T);
+}
+
+template <typename F, typename Tuple, size_t... Is>
+constexpr auto apply_impl(F &&Fn, Tuple &T, index_sequence<Is...>) {
+  return Fn(get<Is>(T)...);
+}
+template <typename F, typename... Ts>
+constexpr auto apply(F &&Fn, tuple<Ts...> &T) {
+  return apply_impl(forward<F>(Fn), T, make_index_sequence<sizeof...(Ts)>());
+}
+
+template <typename T, typename Compare>
+void sort(T *First, T *Last, Compare Less) {
+  while (Last - First > 16) {
+    T *Mid = First + (Last - First) / 2;
+    T Pivot = *Mid;
+    T *L = First, *R = Last - 1;
+    while (L <= R) {
+      while (Less(*L, Pivot))
+        ++L;
+      while (Less(Pivot, *R))
+        --R;
+      if (L <= R) {
+        T Tmp = move(*L);
+        *L = move(*R);
+        *R = move(Tmp);
+        ++L;
+        --R;
+      }
+    }
+    if (R - First < Last - L) {
+      sort(First, R + 1, Less);
+      First = L;
+    } else {
+      sort(L, Last, Less);
+      Last = R + 1;
+    }
+  }
+  for (T *I = First + 1; I < Last; ++I) {
+    T V = move(*I);
+    T *J = I;
+    for (; J > First && Less(V, *(J - 1)); --J)
+      *J = move(*(J - 1));
+    *J = move(V);
+  }
+}
+
+template <typename T, typename F> auto map(const vector<T> &In, F Fn) {
+  vector<decltype(Fn(In[0]))> Out;
+  Out.reserve(In.size());
+  for (const T &V : In)
+    Out.push_back(Fn(V));
+  return Out;
+}
+
+template <typename T, typename Acc, typename F>
+Acc fold(const vector<T> &In, Acc Init, F Fn) {
+  for (const T &V : In)
+    Init = Fn(Init, V);
+  return Init;
+}
+
+template <typename... Ts> struct overloaded : Ts... { using Ts::operator()...; };
+template <typename... Ts> overloaded(Ts...) -> overloaded<Ts...>;
+
+template <size_t N> struct fixed_string {
+  char Chars[N] = {};
+  constexpr fixed_string(const char (&S)[N]) {
+    for (size_t I = 0; I != N; ++I)
+      Chars[I] = S[I];
+  }
+  constexpr size_t hash() const {
+    size_t H = 14695981039346656037ull;
+    for (size_t I = 0; I + 1 < N; ++I)
+      H = (H ^ static_cast<unsigned char>(Chars[I])) * 1099511628211ull;
+    return H;
+  }
+};
+
+template <unsigned N> struct fib {
+  static constexpr unsigned long long value = fib<N - 1>::value +
+                                              fib<N - 2>::value;
+};
+template <> struct fib<0> { static constexpr unsigned long long value = 0; };
+template <> struct fib<1> { static constexpr unsigned long long value = 1; };
+
+template <typename T, size_t... Is>
+constexpr T sum_fibs(index_sequence<Is...>) {
+  return (T(0) + ... + T(fib<Is>::value));
+}
+
+struct point {
+  double X, Y;
+};
+
+template <typename T> struct matrix {
+  vector<T> Elements;
+  size_t Rows, Cols;
+  matrix(size_t R, size_t C) : Rows(R), Cols(C) {
+    Elements.reserve(R * C);
+    for (size_t I = 0; I != R * C; ++I)
+      Elements.emplace_back(T(I % 7));
+  }
+  T &at(size_t R, size_t C) { return Elements[R * Cols + C]; }
+  const T &at(size_t R, size_t C) const { return Elements[R * Cols + C]; }
+  matrix operator*(const matrix &O) const {
+    matrix Res(Rows, O.Cols);
+    for (size_t I = 0; I != Rows; ++I)
+      for (size_t J = 0; J != O.Cols; ++J) {
+        T S = T(0);
+        for (size_t K = 0; K != Cols; ++K)
+          S += at(I, K) * O.at(K, J);
+        Res.at(I, J) = S;
+      }
+    return Res;
+  }
+};
+
+template <typename T> T trace(const matrix<T> &M) {
+  T S = T(0);
+  for (size_t I = 0; I != M.Rows && I != M.Cols; ++I)
+    S += M.at(I, I);
+  return S;
+}
+
+template <typename T> void run_matrix(const char *Name, size_t N) {
+  matrix<T> A(N, N), B(N, N);
+  matrix<T> C = A * B;
+  printf("%s %f\n", Name, static_cast<double>(trace(C)));
+}
+
+} // namespace bench
+
+int main() {
+  using namespace bench;
+  vector<point> Points;
+  for (int I = 0; I != 1000; ++I)
+    Points.push_back(point{double(I * 37 % 101), double(I * 53 % 97)});
+  sort(Points.begin(), Points.end(), [](const point &A, const point &B) {
+    return A.X < B.X || (A.X == B.X && A.Y < B.Y);
+  });
+  auto Norms = map(Points, [](const point &P) { return P.X * P.X + P.Y * P.Y; });
+  double Total = fold(Norms, 0.0, [](double A, double B) { return A + B; });
+
+  tuple<int, double, long, unsigned char> T(1, 2.5, 3L, 'x');
+  auto Sum = apply([](auto... Vs) { return (double(Vs) + ...); }, T);
+
+  auto Visit = overloaded{[](int V) { return V * 2.0; },
+                          [](double V) { return V / 2.0; },
+                          [](long V) { return double(V) + 1; }};
+  double Visited = Visit(3) + Visit(4.0) + Visit(5L);
+
+  constexpr fixed_string Key("compile-time-benchmark");
+  static_assert(Key.hash() != 0, "hash must not be zero");
+  constexpr auto Fibs = sum_fibs<unsigned long long>(make_index_sequence<64>());
+
+  run_matrix<int>("int", 48);
+  run_matrix<long>("long", 48);
+  run_matrix<float>("float", 48);
+  run_matrix<double>("double", 48);
+
+  printf("%f %f %f %zu %llu\n", Total, Sum, Visited, Key.hash(), Fibs);
+  return 0;
+}